@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Timing
+ */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Allocation counting, plug these into the mem_* hooks of a container configuration
+ */
+typedef struct bench_alloc_stats_s
+{
+    size_t allocs;
+    size_t frees;
+    size_t bytes;
+} bench_alloc_stats;
+
+static bench_alloc_stats bench_allocs;
+
+static inline void* bench_malloc(size_t size)
+{
+    bench_allocs.allocs++;
+    bench_allocs.bytes += size;
+    return malloc(size);
+}
+
+static inline void* bench_calloc(size_t blocks, size_t size)
+{
+    bench_allocs.allocs++;
+    bench_allocs.bytes += blocks * size;
+    return calloc(blocks, size);
+}
+
+static inline void* bench_realloc(void* block, size_t size)
+{
+    bench_allocs.allocs++;
+    bench_allocs.bytes += size;
+    return realloc(block, size);
+}
+
+static inline void bench_free(void* block)
+{
+    if(block != NULL)
+    {
+        bench_allocs.frees++;
+    }
+
+    free(block);
+}
+
+static inline void bench_allocs_reset(void)
+{
+    memset(&bench_allocs, 0, sizeof(bench_allocs));
+}
+
+/*
+ * Pseudo random numbers (xorshift64*), deterministic so runs are comparable
+ */
+static uint64_t bench_rand_state = 0x9E3779B97F4A7C15ull;
+
+static inline uint64_t bench_rand(void)
+{
+    bench_rand_state ^= bench_rand_state >> 12;
+    bench_rand_state ^= bench_rand_state << 25;
+    bench_rand_state ^= bench_rand_state >> 27;
+    return bench_rand_state * 0x2545F4914F6CDD1Dull;
+}
+
+static inline void bench_rand_seed(uint64_t seed)
+{
+    bench_rand_state = seed == 0 ? 0x9E3779B97F4A7C15ull : seed;
+}
+
+/*
+ * Reporting
+ */
+typedef struct bench_measurement_s
+{
+    uint64_t start_ns;
+    size_t   start_allocs;
+} bench_measurement;
+
+static inline bench_measurement bench_start(void)
+{
+    bench_measurement m = {
+        .start_ns = bench_now_ns(),
+        .start_allocs = bench_allocs.allocs
+    };
+    return m;
+}
+
+static inline void bench_print_header(void)
+{
+    printf("%-14s %-22s %10s %12s %12s %12s\n", "container", "operation", "size", "ops", "ns/op", "allocs/op");
+}
+
+static inline void bench_report(const char* container, const char* operation, size_t size, size_t ops, bench_measurement m)
+{
+    uint64_t elapsed = bench_now_ns() - m.start_ns;
+    size_t allocs = bench_allocs.allocs - m.start_allocs;
+
+    printf("%-14s %-22s %10zu %12zu %12.1f %12.3f\n",
+        container,
+        operation,
+        size,
+        ops,
+        ops > 0 ? (double)elapsed / (double)ops : 0.0,
+        ops > 0 ? (double)allocs / (double)ops : 0.0);
+}
+
+// Value that cannot be optimized away, used to keep the results of benchmarked loops alive
+static volatile uintptr_t bench_sink;
+
+/*
+ * Arguments
+ */
+// Number given as argument index, value if there are fewer arguments
+static inline size_t bench_arg(int argc, char** argv, int index, size_t value)
+{
+    return argc > index ? strtoul(argv[index], NULL, 10) : value;
+}
+
+/*
+ * Logging, for the benchmarks of the logger service that define USE_LOGGER_SERVICE
+ */
+#ifdef USE_LOGGER_SERVICE
+#include <stdatomic.h>
+
+#include <logger.h>
+
+static atomic_size_t bench_logged_bytes;
+
+// Sink that only counts the bytes it receives, tasks that log synchronously call it at the same time
+static inline void bench_null_sink(const char* message, const size_t len, void* user_data)
+{
+    atomic_fetch_add_explicit(&bench_logged_bytes, len, memory_order_relaxed);
+}
+
+// Logs count messages with two arguments from a single call site, including the delivery of queued messages
+static inline void bench_log_messages(const char* container, const char* operation, const char* tag, size_t count)
+{
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        LOG_I(tag, "message %u with value %d", (unsigned int)i, (int)(i * 7));
+    }
+    logger_service_flush();
+    bench_report(container, operation, count, count, m);
+}
+#endif
+
+#endif // BENCH_H
\ No newline at end of file
@@ -0,0 +1,432 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmarks for the utilities containers.
+ *
+ * Usage: bench_containers [max_size]
+ *
+ * Measures add/remove/lookup/iterate latency and heap allocations per
+ * operation for container sizes from 10 up to max_size (default 1000000).
+ * Operations that are O(n) per call are run fewer times on large sizes.
+ */
+#include "bench.h"
+
+#include <idlist.h>
+#include <map.h>
+#include <omap.h>
+#include <pool.h>
+#include <slist.h>
+#include <vec.h>
+
+// Total number of element visits spent on a single O(n) benchmark
+#define LINEAR_BUDGET 20000000u
+
+typedef struct item_s
+{
+    uintptr_t   key;
+    idlist_link link;
+} item;
+
+static item*  items;
+static item** shuffled;
+
+/*
+ * Helpers
+ */
+static size_t linear_ops(size_t size)
+{
+    size_t ops = LINEAR_BUDGET / size;
+    if(ops > size)
+    {
+        ops = size;
+    }
+
+    return ops == 0 ? 1 : ops;
+}
+
+static void setup_items(size_t size)
+{
+    items = (item*)calloc(size, sizeof(*items));
+    shuffled = (item**)calloc(size, sizeof(*shuffled));
+
+    for(size_t i = 0; i < size; i++)
+    {
+        items[i].key = i * 2;
+        shuffled[i] = &items[i];
+    }
+
+    // Fisher-Yates shuffle for random access order
+    for(size_t i = size - 1; i > 0; i--)
+    {
+        size_t j = bench_rand() % (i + 1);
+        item* tmp = shuffled[i];
+        shuffled[i] = shuffled[j];
+        shuffled[j] = tmp;
+    }
+}
+
+static void teardown_items(void)
+{
+    free(items);
+    free(shuffled);
+}
+
+static int compare_key(const void* key, const void* element)
+{
+    uintptr_t a = *(const uintptr_t*)key;
+    uintptr_t b = *(const uintptr_t*)element;
+    return (a > b) - (a < b);
+}
+
+static bool is_odd_item(void* element, void* context)
+{
+    (void)context;
+    return (((item*)element)->key / 2) & 1;
+}
+
+/*
+ * Benchmarks
+ */
+static void bench_slist(size_t size, bool usePool)
+{
+    const char* name = usePool ? "slist(pool)" : "slist";
+
+    slist_conf conf;
+    slist_conf_init(&conf);
+    conf.mem_alloc = bench_malloc;
+    conf.mem_calloc = bench_calloc;
+    conf.mem_free = bench_free;
+
+    pool nodePool = NULL;
+    if(usePool)
+    {
+        pool_conf poolConf;
+        pool_conf_init(&poolConf, slist_node_size(), size);
+        poolConf.mem_alloc = bench_malloc;
+        poolConf.mem_free = bench_free;
+        pool_new_conf(&poolConf, &nodePool);
+        conf.node_pool = nodePool;
+    }
+
+    slist list;
+    slist_new_conf(&conf, &list);
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        slist_add(list, &items[i]);
+    }
+    bench_report(name, "add", size, size, m);
+
+    m = bench_start();
+    uintptr_t sum = 0;
+    item* it;
+    SLIST_FOREACH(it, list)
+    {
+        sum += it->key;
+    }
+    bench_sink = sum;
+    bench_report(name, "iterate", size, size, m);
+
+    size_t ops = linear_ops(size);
+    m = bench_start();
+    for(size_t i = 0; i < ops; i++)
+    {
+        void* found;
+        slist_get_at(list, bench_rand() % size, &found);
+        bench_sink = (uintptr_t)found;
+    }
+    bench_report(name, "get_at(random)", size, ops, m);
+
+    m = bench_start();
+    for(size_t i = 0; i < ops; i++)
+    {
+        slist_remove(list, shuffled[i]);
+        slist_add(list, shuffled[i]);
+    }
+    bench_report(name, "remove+add(random)", size, ops, m);
+
+    m = bench_start();
+    slist copy;
+    slist_copy_shallow(list, &copy);
+    bench_report(name, "copy_shallow", size, size, m);
+    slist_delete(copy);
+
+    slist other;
+    slist_new_conf(&conf, &other);
+
+    m = bench_start();
+    slist_add_range(other, (void* const*)shuffled, size);
+    bench_report(name, "add_range", size, size, m);
+
+    m = bench_start();
+    slist_splice(list, other);
+    bench_report(name, "splice", size, 1, m);
+
+    m = bench_start();
+    size_t removed = slist_remove_if(list, is_odd_item, NULL);
+    bench_report(name, "remove_if(half)", size * 2, size * 2, m);
+    bench_sink = removed;
+
+    m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        slist_remove_at(list, 0);
+    }
+    bench_report(name, "remove_at(0)", size, size, m);
+
+    slist_delete(list);
+    slist_delete(other);
+
+    if(nodePool != NULL)
+    {
+        pool_delete(nodePool);
+    }
+}
+
+static void bench_map(size_t size, bool reserve)
+{
+    const char* name = reserve ? "map(reserved)" : "map";
+
+    map_conf conf;
+    map_conf_init(&conf);
+    conf.mem_alloc = bench_malloc;
+    conf.mem_calloc = bench_calloc;
+    conf.mem_free = bench_free;
+
+    map m;
+    map_new_conf(&conf, &m);
+
+    if(reserve)
+    {
+        map_reserve(m, size);
+    }
+
+    bench_measurement b = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        map_add(m, &items[i], &items[i].key);
+    }
+    bench_report(name, "add", size, size, b);
+
+    b = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        const void* value;
+        map_get(m, shuffled[i], &value);
+        bench_sink = (uintptr_t)value;
+    }
+    bench_report(name, "get(hit)", size, size, b);
+
+    b = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        const void* value;
+        map_get(m, &shuffled[i]->key, &value);
+        bench_sink = (uintptr_t)value;
+    }
+    bench_report(name, "get(miss)", size, size, b);
+
+    b = bench_start();
+    uintptr_t sum = 0;
+    item* key;
+    uintptr_t* value;
+    MAP_FOREACH(key, value, m)
+    {
+        sum += *value;
+    }
+    bench_sink = sum;
+    bench_report(name, "iterate", size, size, b);
+
+    b = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        map_remove(m, shuffled[i]);
+    }
+    bench_report(name, "remove(random)", size, size, b);
+
+    map_delete(m);
+}
+
+static void bench_omap(size_t size)
+{
+    omap_conf conf;
+    omap_conf_init(&conf, compare_key, sizeof(uintptr_t));
+    conf.mem_alloc = bench_malloc;
+    conf.mem_free = bench_free;
+
+    omap m;
+    omap_new(&conf, &m);
+
+    bench_measurement b = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        omap_put(m, &shuffled[i]->key, shuffled[i]);
+    }
+    bench_report("omap", "put(random)", size, size, b);
+
+    b = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        const void* value;
+        omap_get(m, &items[i].key, &value);
+        bench_sink = (uintptr_t)value;
+    }
+    bench_report("omap", "get(hit)", size, size, b);
+
+    b = bench_start();
+    uintptr_t sum = 0;
+    uintptr_t* key;
+    item* value;
+    OMAP_FOREACH(key, value, m)
+    {
+        sum += *key;
+    }
+    bench_sink = sum;
+    bench_report("omap", "iterate", size, size, b);
+
+    // Short range scans starting at random keys, as used for time windows
+    size_t ops = linear_ops(size);
+    b = bench_start();
+    for(size_t i = 0; i < ops; i++)
+    {
+        uintptr_t from = shuffled[i]->key;
+        uintptr_t to = from + 2 * 16;
+        omap_iter_state iter;
+        omap_iter_range(m, &from, &to, &iter);
+        while(omap_iter_next(&iter, (void**)&key, (void**)&value) != UTIL_ITER_END)
+        {
+            sum += *key;
+        }
+    }
+    bench_sink = sum;
+    bench_report("omap", "range(16)", size, ops, b);
+
+    b = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        omap_remove(m, &shuffled[i]->key);
+    }
+    bench_report("omap", "remove(random)", size, size, b);
+
+    omap_delete(m);
+}
+
+static void bench_vec(size_t size)
+{
+    vec_conf conf;
+    vec_conf_init(&conf);
+    conf.mem_alloc = bench_malloc;
+    conf.mem_realloc = bench_realloc;
+    conf.mem_free = bench_free;
+
+    vec v;
+    vec_new_conf(&conf, sizeof(uintptr_t), &v);
+
+    // Keys are pushed in order so the vector is sorted for the binary search
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        vec_push(v, &items[i].key);
+    }
+    bench_report("vec", "push", size, size, m);
+
+    m = bench_start();
+    uintptr_t sum = 0;
+    VEC_FOREACH(uintptr_t, key, v)
+    {
+        sum += *key;
+    }
+    bench_sink = sum;
+    bench_report("vec", "iterate", size, size, m);
+
+    m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        size_t index;
+        vec_bsearch(v, &shuffled[i]->key, compare_key, &index);
+        bench_sink = index;
+    }
+    bench_report("vec", "bsearch", size, size, m);
+
+    m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        vec_swap_remove(v, bench_rand() % vec_count(v));
+    }
+    bench_report("vec", "swap_remove(random)", size, size, m);
+
+    vec_delete(v);
+}
+
+static void bench_idlist(size_t size)
+{
+    idlist list;
+    idlist_init(&list);
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        idlist_push_back(&list, &items[i].link);
+    }
+    bench_report("idlist", "push_back", size, size, m);
+
+    m = bench_start();
+    uintptr_t sum = 0;
+    IDLIST_FOREACH(link, &list)
+    {
+        sum += IDLIST_ENTRY(link, item, link)->key;
+    }
+    bench_sink = sum;
+    bench_report("idlist", "iterate", size, size, m);
+
+    m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        idlist_unlink(&list, &shuffled[i]->link);
+    }
+    bench_report("idlist", "unlink(random)", size, size, m);
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxSize = bench_arg(argc, argv, 1, 1000000);
+
+    bench_print_header();
+
+    for(size_t size = 10; size <= maxSize; size *= 10)
+    {
+        setup_items(size);
+        bench_allocs_reset();
+
+        bench_slist(size, false);
+        bench_slist(size, true);
+        bench_map(size, false);
+        bench_map(size, true);
+        bench_omap(size);
+        bench_vec(size);
+        bench_idlist(size);
+
+        teardown_items();
+    }
+
+    return 0;
+}
\ No newline at end of file
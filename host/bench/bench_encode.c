@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmark and check of the encodings of the logger service.
+ *
+ * Usage: bench_encode [messages]
+ *        bench_encode_async [messages]
+ *        bench_encode_binary [messages]
+ *
+ * Measures the cost of LOG_I and LOG_KV_I calls with a text, JSON or CBOR
+ * sink. Checks the text and JSON of a few messages, and that the CBOR of
+ * every message decodes to the same members as its JSON.
+ */
+#define USE_LOGGER_SERVICE
+
+#include "bench.h"
+
+#include <inttypes.h>
+
+#include <logger.h>
+
+static const char* TAG = "bench";
+
+#if defined(CONFIG_LOGGER_SERVICE_BINARY)
+static const char* name = "encode(binary)";
+#elif defined(CONFIG_LOGGER_SERVICE_ASYNC)
+static const char* name = "encode(async)";
+#else
+static const char* name = "encode";
+#endif
+
+// Last message received per encoding
+static char lastMessages[LOGGER_SERVICE_ENCODINGS][CONFIG_LOGGER_SERVICE_MESSAGE_SIZE];
+static size_t lastLens[LOGGER_SERVICE_ENCODINGS];
+
+static void keep_sink(const char* message, const size_t len, void* user_data)
+{
+    size_t encoding = (size_t)(uintptr_t)user_data;
+
+    memcpy(lastMessages[encoding], message, len);
+    lastLens[encoding] = len;
+}
+
+/*
+ * CBOR to JSON, in the form the JSON encoder writes it
+ */
+static bool cbor_head(const uint8_t** p, const uint8_t* end, uint8_t* initial, uint64_t* value)
+{
+    if(*p >= end)
+    {
+        return false;
+    }
+
+    *initial = *(*p)++;
+    uint8_t info = *initial & 0x1F;
+    size_t n = info < 24 ? 0 : (size_t)1 << (info - 24);
+
+    if(info > 27 || (size_t)(end - *p) < n)
+    {
+        return false;
+    }
+
+    *value = n == 0 ? info : 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        *value = (*value << 8) | *(*p)++;
+    }
+
+    return true;
+}
+
+static void json_string(char** out, const char* s, size_t len)
+{
+    *(*out)++ = '"';
+    for(size_t i = 0; i < len; i++)
+    {
+        unsigned char c = (unsigned char)s[i];
+        switch(c)
+        {
+            case '"':   *out += sprintf(*out, "\\\""); break;
+            case '\\':  *out += sprintf(*out, "\\\\"); break;
+            case '\n':  *out += sprintf(*out, "\\n"); break;
+            case '\t':  *out += sprintf(*out, "\\t"); break;
+            default:
+                *out += c < 0x20 ? sprintf(*out, "\\u%04x", c) : sprintf(*out, "%c", c);
+                break;
+        }
+    }
+    *(*out)++ = '"';
+}
+
+static bool cbor_item(const uint8_t** p, const uint8_t* end, char** out)
+{
+    uint8_t initial;
+    uint64_t value;
+
+    if(!cbor_head(p, end, &initial, &value))
+    {
+        return false;
+    }
+
+    switch(initial >> 5)
+    {
+        case 0: *out += sprintf(*out, "%" PRIu64, value); return true;
+        case 1: *out += sprintf(*out, "%" PRId64, -1 - (int64_t)value); return true;
+        case 3:
+            if(value > (uint64_t)(end - *p))
+            {
+                return false;
+            }
+            json_string(out, (const char*)*p, (size_t)value);
+            *p += value;
+            return true;
+        case 7:
+            if(initial == 0xF4 || initial == 0xF5)
+            {
+                *out += sprintf(*out, "%s", initial == 0xF5 ? "true" : "false");
+                return true;
+            }
+            if(initial == 0xFB)
+            {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                *out += sprintf(*out, "%.15g", d);
+                return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+static bool cbor_to_json(const char* cbor, size_t len, char* json)
+{
+    const uint8_t* p = (const uint8_t*)cbor;
+    const uint8_t* end = p + len;
+    uint8_t initial;
+    uint64_t pairs;
+
+    if(!cbor_head(&p, end, &initial, &pairs) || (initial >> 5) != 5)
+    {
+        return false;
+    }
+
+    *json++ = '{';
+    for(uint64_t i = 0; i < pairs; i++)
+    {
+        if(i > 0)
+        {
+            *json++ = ',';
+        }
+        if(!cbor_item(&p, end, &json))
+        {
+            return false;
+        }
+        *json++ = ':';
+        if(!cbor_item(&p, end, &json))
+        {
+            return false;
+        }
+    }
+    strcpy(json, "}\n");
+
+    return p == end;
+}
+
+/*
+ * Checks
+ */
+static bool check_message(const char* what, const char* text, const char* json)
+{
+    char decoded[2 * CONFIG_LOGGER_SERVICE_MESSAGE_SIZE];
+    bool ok = true;
+
+    logger_service_flush();
+
+    const char* textMessage = lastMessages[LOGGER_SERVICE_ENCODING_TEXT];
+    const char* jsonMessage = lastMessages[LOGGER_SERVICE_ENCODING_JSON];
+    size_t textLen = lastLens[LOGGER_SERVICE_ENCODING_TEXT];
+    size_t jsonLen = lastLens[LOGGER_SERVICE_ENCODING_JSON];
+
+    // The time differs from run to run, so only what follows it is compared
+    const char* afterTime = strstr(jsonMessage, ",\"lvl\"");
+
+    if(text != NULL && (textLen < strlen(text) || memcmp(textMessage + textLen - strlen(text), text, strlen(text)) != 0))
+    {
+        printf("%s: text %.*s", what, (int)textLen, textMessage);
+        ok = false;
+    }
+
+    if(json != NULL && (strncmp(jsonMessage, "{\"ts\":", 6) != 0 || afterTime == NULL || strlen(afterTime) != jsonLen - (size_t)(afterTime - jsonMessage) || strcmp(afterTime, json) != 0))
+    {
+        printf("%s: json %.*s", what, (int)jsonLen, jsonMessage);
+        ok = false;
+    }
+
+    if(!cbor_to_json(lastMessages[LOGGER_SERVICE_ENCODING_CBOR], lastLens[LOGGER_SERVICE_ENCODING_CBOR], decoded) || strlen(decoded) != jsonLen || memcmp(decoded, jsonMessage, jsonLen) != 0)
+    {
+        printf("%s: cbor %s", what, decoded);
+        ok = false;
+    }
+
+    memset(lastLens, 0, sizeof(lastLens));
+    memset(lastMessages, 0, sizeof(lastMessages));
+
+    return ok;
+}
+
+static bool check_encodings(void)
+{
+    sink_handle_t sinks[LOGGER_SERVICE_ENCODINGS];
+    bool ok = true;
+
+    for(size_t i = 0; i < LOGGER_SERVICE_ENCODINGS; i++)
+    {
+        sinks[i] = logger_service_register_encoded_sink((logger_service_encoding_t)i, keep_sink, (void*)(uintptr_t)i);
+    }
+
+    LOG_KV_I(TAG, "connected \"ap\"",
+        LOGGER_SERVICE_INT("rssi", -67),
+        LOGGER_SERVICE_UINT("bytes", 1234567890123ull),
+        LOGGER_SERVICE_DOUBLE("ratio", 0.25),
+        LOGGER_SERVICE_BOOL("ok", true),
+        LOGGER_SERVICE_STRING("ssid", "my\tnet"));
+    ok = check_message("fields",
+        ": connected \"ap\" rssi=-67 bytes=1234567890123 ratio=0.25 ok=true ssid=my\tnet" LOGGER_SERVICE_RESET_COLOR "\n",
+        ",\"lvl\":\"I\",\"tag\":\"bench\",\"msg\":\"connected \\\"ap\\\"\",\"rssi\":-67,\"bytes\":1234567890123,\"ratio\":0.25,\"ok\":true,\"ssid\":\"my\\tnet\"}\n") && ok;
+
+    LOG_W(TAG, "line %d\nnext \\ %s", 1, "line");
+    ok = check_message("printf",
+        ": line 1\nnext \\ line" LOGGER_SERVICE_RESET_COLOR "\n",
+        ",\"lvl\":\"W\",\"tag\":\"bench\",\"msg\":\"line 1\\nnext \\\\ line\"}\n") && ok;
+
+    // Without a tag the format brings its own prefix and colors, which JSON and CBOR leave out
+    logger_service_log(LOGGER_SERVICE_LOGLEVEL_ERROR, LOGGER_SERVICE_FORMAT(E, "untagged %d"), "now", "bench", 7);
+    ok = check_message("untagged",
+        LOGGER_SERVICE_COLOR_E "E (now) bench: untagged 7" LOGGER_SERVICE_RESET_COLOR "\n",
+        ",\"lvl\":\"E\",\"msg\":\"E (now) bench: untagged 7\"}\n") && ok;
+
+#ifndef CONFIG_LOGGER_SERVICE_BINARY
+    // Messages that do not fit are truncated as text and dropped as JSON and CBOR, deferred
+    // formatting already cuts off long string arguments
+    char longText[CONFIG_LOGGER_SERVICE_MESSAGE_SIZE + 16];
+    memset(longText, 'x', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+    logger_service_stats_t before;
+    logger_service_stats_t after;
+    logger_service_get_stats(&before);
+    LOG_I(TAG, "%s", longText);
+    logger_service_flush();
+    logger_service_get_stats(&after);
+    ok = ok && lastLens[LOGGER_SERVICE_ENCODING_TEXT] == CONFIG_LOGGER_SERVICE_MESSAGE_SIZE - 1 && lastLens[LOGGER_SERVICE_ENCODING_JSON] == 0 && lastLens[LOGGER_SERVICE_ENCODING_CBOR] == 0;
+    ok = ok && after.dropped - before.dropped == 2;
+#endif
+
+    for(size_t i = 0; i < LOGGER_SERVICE_ENCODINGS; i++)
+    {
+        logger_service_unregister_sink(sinks[i]);
+    }
+
+    return ok;
+}
+
+/*
+ * Benchmarks
+ */
+static void log_fields(const char* operation, size_t count)
+{
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        LOG_KV_I(TAG, "message", LOGGER_SERVICE_UINT("number", i), LOGGER_SERVICE_INT("value", (int)(i * 7)));
+    }
+    logger_service_flush();
+    bench_report(name, operation, count, count, m);
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 200000);
+
+    logger_service_init();
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+    // Measure the full cost of every message instead of how fast messages can be dropped
+    logger_service_set_overflow_policy(LOGGER_SERVICE_OVERFLOW_BLOCK);
+#endif
+
+    bool ok = check_encodings();
+
+    bench_print_header();
+
+    static const char* const operations[][2] =
+    {
+        { "log(text)", "log_kv(text)" },
+        { "log(json)", "log_kv(json)" },
+        { "log(cbor)", "log_kv(cbor)" },
+    };
+
+    for(size_t i = 0; i < LOGGER_SERVICE_ENCODINGS; i++)
+    {
+        sink_handle_t sink = logger_service_register_encoded_sink((logger_service_encoding_t)i, bench_null_sink, NULL);
+        bench_log_messages(name, operations[i][0], TAG, count);
+        log_fields(operations[i][1], count);
+        logger_service_unregister_sink(sink);
+    }
+
+    if(!ok)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
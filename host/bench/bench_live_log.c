@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmark and stress test for the live log sink.
+ *
+ * Usage: bench_live_log [messages]
+ *
+ * Measures the cost of a LOG_I call with the live sink registered and no
+ * clients, with a client that is read by another thread, a client that is
+ * never read and a client with a higher level. Checks that every client
+ * receives its messages in order, that the dropped messages are reported
+ * and that the client with the higher level receives nothing.
+ */
+#define USE_LOGGER_SERVICE
+
+#include "bench.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include <logger.h>
+#include <logger_live_sink.h>
+
+static const char* TAG = "bench";
+
+typedef struct reader_ctx_s
+{
+    logger_live_sink_t sink;
+    logger_live_client_t client;
+    atomic_bool stop;
+    size_t received;
+    size_t dropped;
+    bool failed;
+} reader_ctx;
+
+static size_t parse_number(const char* message, size_t len)
+{
+    const char* number = memchr(message, '#', len);
+    return number != NULL ? strtoul(number + 1, NULL, 10) : (size_t)-1;
+}
+
+static void* reader(void* arg)
+{
+    reader_ctx* ctx = (reader_ctx*)arg;
+    char message[256];
+    size_t len;
+
+    for(;;)
+    {
+        bool stopping = atomic_load(&ctx->stop);
+
+        if(!logger_live_sink_read(ctx->sink, ctx->client, message, sizeof(message), &len))
+        {
+            if(stopping)
+            {
+                break;
+            }
+
+            sched_yield();
+            continue;
+        }
+
+        if(memcmp(message, "...", 3) == 0)
+        {
+            ctx->dropped += strtoul(message + 4, NULL, 10);
+            continue;
+        }
+
+        // Messages may be dropped, but the others arrive in order
+        if(parse_number(message, len) != ctx->received + ctx->dropped)
+        {
+            ctx->failed = true;
+        }
+        ctx->received++;
+    }
+
+    return NULL;
+}
+
+static void log_messages(const char* operation, size_t count)
+{
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        LOG_I(TAG, "message #%u", (unsigned int)i);
+    }
+    bench_report("live sink", operation, count, count, m);
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 200000);
+
+    logger_service_init();
+
+    logger_live_sink_conf_t conf;
+    logger_live_sink_conf_init(&conf);
+    conf.max_clients = 3;
+
+    logger_live_sink_t live = logger_live_sink_new(&conf);
+    sink_handle_t sink = logger_service_register_sink(logger_live_sink_write, live);
+
+    bench_print_header();
+
+    log_messages("log(no clients)", count);
+
+    reader_ctx ctx = { .sink = live };
+    ctx.client = logger_live_sink_add_client(live, &ctx);
+    logger_live_sink_set_client_level(live, ctx.client, LOGGER_SERVICE_LOGLEVEL_VERBOSE);
+
+    int slowContext;
+    logger_live_client_t slow = logger_live_sink_add_client(live, &slowContext);
+
+    int quietContext;
+    logger_live_client_t quiet = logger_live_sink_add_client(live, &quietContext);
+    logger_live_sink_set_client_level(live, quiet, LOGGER_SERVICE_LOGLEVEL_WARN);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, reader, &ctx);
+
+    log_messages("log(3 clients)", count);
+
+    atomic_store(&ctx.stop, true);
+    pthread_join(thread, NULL);
+
+    char message[256];
+    size_t len;
+    size_t slowReceived = 0;
+    size_t slowDropped = 0;
+
+    while(logger_live_sink_read(live, slow, message, sizeof(message), &len))
+    {
+        if(memcmp(message, "...", 3) == 0)
+        {
+            slowDropped += strtoul(message + 4, NULL, 10);
+        }
+        else
+        {
+            slowReceived++;
+        }
+    }
+
+    bool quietEmpty = !logger_live_sink_read(live, quiet, message, sizeof(message), &len);
+
+    printf("read client received %zu and dropped %zu, slow client received %zu and dropped %zu\n", ctx.received, ctx.dropped, slowReceived, slowDropped);
+
+    logger_service_unregister_sink(sink);
+    logger_live_sink_delete(live);
+
+    if(ctx.failed || ctx.received + ctx.dropped != count || slowReceived + slowDropped != count || !quietEmpty)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
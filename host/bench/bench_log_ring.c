@@ -0,0 +1,317 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmark and crash test for the persistent log ring.
+ *
+ * Usage: bench_log_ring [messages]
+ *
+ * Measures the cost of a LOG_I call with the ring registered directly and
+ * behind a buffered sink, and how many sector headers are read to open rings of
+ * different sizes. Then interrupts writes at every byte of a record, like a
+ * reset would, and checks that reopening the ring finds every complete
+ * record in order and appends after them.
+ */
+#define USE_LOGGER_SERVICE
+
+#include "bench.h"
+
+#include <logger.h>
+#include <logger_buffered_sink.h>
+#include <logger_ring.h>
+
+#define SECTOR_SIZE 4096
+
+static const char* TAG = "bench";
+
+// Storage in memory that counts reads and writes, and fails writes after a number of bytes
+typedef struct test_storage_s
+{
+    uint8_t* memory;
+    size_t header_reads;            // Reads at the start of a sector
+    size_t writes;
+    size_t write_budget;
+} test_storage;
+
+static bool test_read(void* context, size_t offset, void* data, size_t len)
+{
+    test_storage* storage = (test_storage*)context;
+    storage->header_reads += offset % SECTOR_SIZE == 0;
+    memcpy(data, storage->memory + offset, len);
+    return true;
+}
+
+static bool test_write(void* context, size_t offset, const void* data, size_t len)
+{
+    test_storage* storage = (test_storage*)context;
+    size_t n = len < storage->write_budget ? len : storage->write_budget;
+
+    // Like flash, writing can only clear bits
+    for(size_t i = 0; i < n; i++)
+    {
+        storage->memory[offset + i] &= ((const uint8_t*)data)[i];
+    }
+
+    storage->writes++;
+    storage->write_budget -= n;
+    return n == len;
+}
+
+static bool test_erase(void* context, size_t offset, size_t len)
+{
+    test_storage* storage = (test_storage*)context;
+    if(storage->write_budget == 0)
+    {
+        return false;
+    }
+    memset(storage->memory + offset, 0xFF, len);
+    return true;
+}
+
+static void test_storage_init(logger_ring_storage_t* storage, test_storage* test, size_t sector_count)
+{
+    test->memory = malloc(SECTOR_SIZE * sector_count);
+    test->header_reads = 0;
+    test->writes = 0;
+    test->write_budget = SIZE_MAX;
+    memset(test->memory, 0xFF, SECTOR_SIZE * sector_count);
+
+    storage->sector_size = SECTOR_SIZE;
+    storage->sector_count = sector_count;
+    storage->context = test;
+    storage->read = test_read;
+    storage->write = test_write;
+    storage->erase = test_erase;
+    storage->close = NULL;
+}
+
+static void log_messages(const char* operation, size_t count)
+{
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        LOG_I(TAG, "message #%u", (unsigned int)i);
+    }
+    bench_report("log ring", operation, count, count, m);
+}
+
+static void bench_logging(size_t count)
+{
+    logger_ring_storage_t storage;
+    test_storage test;
+    test_storage_init(&storage, &test, 64);
+
+    logger_ring_t ring = logger_ring_open(&storage);
+
+    sink_handle_t sink = logger_service_register_batch_sink(logger_ring_write, ring);
+    log_messages("log(write)", count);
+    logger_service_unregister_sink(sink);
+
+    size_t writes = test.writes;
+    test.writes = 0;
+
+    logger_buffered_sink_conf_t conf;
+    logger_buffered_sink_conf_init(&conf, logger_ring_write, ring);
+    conf.size = SECTOR_SIZE / 2;
+
+    logger_buffered_sink_t buffered = logger_buffered_sink_new(&conf);
+    sink = logger_service_register_sink(logger_buffered_sink_write, buffered);
+    log_messages("log(buffered write)", count);
+    logger_service_unregister_sink(sink);
+    logger_buffered_sink_delete(buffered);
+
+    printf("storage writes: %zu direct, %zu buffered\n", writes, test.writes);
+
+    logger_ring_close(ring);
+    free(test.memory);
+}
+
+static void bench_open(void)
+{
+    char message[64];
+
+    for(size_t count = 16; count <= 4096; count *= 16)
+    {
+        logger_ring_storage_t storage;
+        test_storage test;
+        test_storage_init(&storage, &test, count);
+
+        // Fill a bit more than half of the ring, so its head is somewhere in the middle
+        logger_ring_t ring = logger_ring_open(&storage);
+        int len = snprintf(message, sizeof(message), "%-*s\n", (int)sizeof(message) - 2, "message");
+        for(size_t i = 0; i < count * SECTOR_SIZE / 2 / (size_t)len + 1; i++)
+        {
+            logger_ring_append(ring, message, (size_t)len);
+        }
+        logger_ring_close(ring);
+
+        test.header_reads = 0;
+        bench_measurement m = bench_start();
+        ring = logger_ring_open(&storage);
+        bench_report("log ring", "open", count, 1, m);
+        printf("sectors: %zu, sector headers read to open: %zu\n", count, test.header_reads);
+
+        logger_ring_close(ring);
+        free(test.memory);
+    }
+}
+
+// Appends numbered records until the storage stops accepting writes, then checks the records
+// after reopening. Returns the number of records that survived.
+static bool check_interrupted(size_t sector_count, size_t budget, size_t* survived)
+{
+    logger_ring_storage_t storage;
+    test_storage test;
+    test_storage_init(&storage, &test, sector_count);
+
+    logger_ring_t ring = logger_ring_open(&storage);
+    char record[200];
+    uint32_t appended = 0;
+
+    // The first records wrap around the ring once
+    size_t before = sector_count * SECTOR_SIZE / sizeof(record) + sector_count;
+    for(size_t i = 0; i < before; i++, appended++)
+    {
+        int len = snprintf(record, sizeof(record), "record %u", (unsigned int)appended);
+        memset(record + len, '.', sizeof(record) - (size_t)len);
+        logger_ring_append(ring, record, sizeof(record));
+    }
+
+    test.write_budget = budget;
+    for(;;)
+    {
+        int len = snprintf(record, sizeof(record), "record %u", (unsigned int)appended);
+        memset(record + len, '.', sizeof(record) - (size_t)len);
+        if(!logger_ring_append(ring, record, sizeof(record)))
+        {
+            break;
+        }
+        appended++;
+    }
+    logger_ring_close(ring);
+
+    // Reset
+    test.write_budget = SIZE_MAX;
+    ring = logger_ring_open(&storage);
+
+    logger_ring_cursor_t cursor;
+    logger_ring_cursor_init(ring, &cursor);
+
+    char buffer[256];
+    size_t len;
+    unsigned int expected = (unsigned int)-1;
+    bool ok = true;
+
+    *survived = 0;
+    while(logger_ring_read(ring, &cursor, buffer, sizeof(buffer), &len))
+    {
+        unsigned int number = (unsigned int)strtoul(buffer + 7, NULL, 10);
+        ok = ok && len == sizeof(record) && (expected == (unsigned int)-1 || number == expected);
+        expected = number + 1;
+        (*survived)++;
+    }
+
+    // Every complete record survives, and new records follow them
+    ok = ok && expected == appended && logger_ring_next_seq(ring) == appended;
+    ok = ok && logger_ring_append(ring, "after reset", 11);
+    ok = ok && logger_ring_read(ring, &cursor, buffer, sizeof(buffer), &len) && len == 11 && memcmp(buffer, "after reset", 11) == 0;
+
+    logger_ring_close(ring);
+    free(test.memory);
+    return ok;
+}
+
+static bool check_file(void)
+{
+    const char* path = "bench_log_ring.bin";
+    logger_ring_storage_t storage;
+    bool ok = true;
+
+    remove(path);
+
+    for(unsigned int round = 0; round < 3 && ok; round++)
+    {
+        ok = logger_ring_storage_file(&storage, path, 512, 4);
+        logger_ring_t ring = ok ? logger_ring_open(&storage) : NULL;
+        ok = ring != NULL;
+
+        char record[32];
+        for(unsigned int i = 0; ok && i < 20; i++)
+        {
+            int len = snprintf(record, sizeof(record), "round %u record %u\n", round, i);
+            ok = logger_ring_append(ring, record, (size_t)len);
+        }
+
+        // The ring holds about 60 records, the newest is always the last of this round
+        logger_ring_cursor_t cursor;
+        char buffer[64];
+        size_t len = 0;
+        logger_ring_cursor_init(ring, &cursor);
+        while(ok && logger_ring_read(ring, &cursor, buffer, sizeof(buffer), &len))
+        {
+            snprintf(record, sizeof(record), "round %u record 19\n", round);
+        }
+        ok = ok && len == strlen(record) && memcmp(buffer, record, len) == 0 && cursor.seq == (round + 1) * 20;
+
+        logger_ring_close(ring);
+    }
+
+    remove(path);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 200000);
+
+    logger_service_init();
+
+    bench_print_header();
+
+    bench_logging(count);
+    bench_open();
+
+    bool ok = true;
+    size_t minSurvived = SIZE_MAX;
+
+    // Interrupting at every byte of a record, in the middle of a sector and around its end
+    for(size_t budget = 0; budget < 2 * (200 + 12) + 4096 && ok; budget++)
+    {
+        size_t survived;
+        ok = check_interrupted(4, budget, &survived);
+        if(!ok)
+        {
+            printf("interrupted after %zu bytes: FAILED\n", budget);
+        }
+        minSurvived = survived < minSurvived ? survived : minSurvived;
+    }
+
+    ok = ok && check_file();
+
+    printf("interrupted writes: at least %zu records survived\n", minSurvived);
+
+    if(!ok)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
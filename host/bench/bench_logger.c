@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmarks for the logger service.
+ *
+ * Usage: bench_logger [messages]
+ *        bench_logger_async [messages]
+ *        bench_logger_binary [messages]
+ *
+ * Measures the cost of a LOG_I call for the caller, with no sinks and with
+ * sinks that discard the message, the cost of calls below the log level of
+ * their tag, the number of write calls of a sink that writes every message
+ * to a file compared to buffered and batched writes, and counts every heap call made in the
+ * process while logging. The allocator is wrapped at link time, so calls
+ * made by the logger service and the C library are counted too.
+ */
+#define USE_LOGGER_SERVICE
+
+#include "bench.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <logger.h>
+#include <logger_buffered_sink.h>
+
+/*
+ * Allocator wrappers, see BENCH_WRAP_ALLOCATOR
+ */
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t blocks, size_t size);
+void* __real_realloc(void* block, size_t size);
+void  __real_free(void* block);
+
+void* __wrap_malloc(size_t size)
+{
+    bench_allocs.allocs++;
+    bench_allocs.bytes += size;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t blocks, size_t size)
+{
+    bench_allocs.allocs++;
+    bench_allocs.bytes += blocks * size;
+    return __real_calloc(blocks, size);
+}
+
+void* __wrap_realloc(void* block, size_t size)
+{
+    bench_allocs.allocs++;
+    bench_allocs.bytes += size;
+    return __real_realloc(block, size);
+}
+
+void __wrap_free(void* block)
+{
+    if(block != NULL)
+    {
+        bench_allocs.frees++;
+    }
+
+    __real_free(block);
+}
+
+/*
+ * Helpers
+ */
+static const char* TAG = "bench";
+static const char* QUIET_TAG = "bench_quiet";
+
+// Number of messages logged at once by log_bursts, less than the queue length
+#define LOG_BURST 8
+
+#if defined(CONFIG_LOGGER_SERVICE_BINARY)
+static const char* name = "logger(binary)";
+#elif defined(CONFIG_LOGGER_SERVICE_ASYNC)
+static const char* name = "logger(async)";
+#else
+static const char* name = "logger";
+#endif
+
+static size_t writes;
+
+// Writes to the file descriptor in user_data
+static void write_sink(const char* messages, const size_t len, void* user_data)
+{
+    writes++;
+    bench_sink += (uintptr_t)write((int)(intptr_t)user_data, messages, len);
+}
+
+// Messages below the level of their tag, the first below every level and the second only below its own
+static void log_writes(const char* operation, size_t count)
+{
+    writes = 0;
+    bench_log_messages(name, operation, TAG, count);
+    printf("%-14s %-22s %10s %12zu writes\n", "", "", "", writes);
+}
+
+static void log_disabled(const char* operation, size_t count)
+{
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        LOG_V(TAG, "message %u with value %d", (unsigned int)i, (int)(i * 7));
+        LOG_I(QUIET_TAG, "message %u with value %d", (unsigned int)i, (int)(i * 7));
+    }
+    bench_report(name, operation, count, 2 * count, m);
+}
+
+// Only times the log calls, in bursts that fit in the queue, so the delivery to the sinks is not included
+static void log_bursts(const char* operation, size_t count)
+{
+    uint64_t callerNs = 0;
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i += LOG_BURST)
+    {
+        uint64_t start = bench_now_ns();
+        for(size_t j = 0; j < LOG_BURST; j++)
+        {
+            LOG_I(TAG, "message %u with value %d", (unsigned int)(i + j), (int)(j * 7));
+        }
+        callerNs += bench_now_ns() - start;
+
+        logger_service_flush();
+    }
+    m.start_ns = bench_now_ns() - callerNs;
+    bench_report(name, operation, count, count, m);
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 1000000);
+
+    logger_service_init();
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+    // Measure the full cost of every message instead of how fast messages can be dropped
+    logger_service_set_overflow_policy(LOGGER_SERVICE_OVERFLOW_BLOCK);
+#endif
+
+    bench_print_header();
+
+    bench_log_messages(name, "log(no sinks)", TAG, count);
+
+    sink_handle_t sinks[4];
+    for(size_t i = 0; i < 4; i++)
+    {
+        sinks[i] = logger_service_register_sink(bench_null_sink, NULL);
+
+        // Warm up, the C library allocates on the first time and printf calls
+        LOG_I(TAG, "warm up");
+        logger_service_flush();
+
+        if(i == 0)
+        {
+            bench_log_messages(name, "log(1 sink)", TAG, count);
+            log_bursts("log(1 sink,caller)", count);
+        }
+    }
+
+    bench_log_messages(name, "log(4 sinks)", TAG, count);
+
+    int fd = open("/dev/null", O_WRONLY);
+
+    sink_handle_t sink = logger_service_register_sink(write_sink, (void*)(intptr_t)fd);
+    log_writes("log(write)", count);
+    logger_service_unregister_sink(sink);
+
+    logger_buffered_sink_conf_t conf;
+    logger_buffered_sink_conf_init(&conf, write_sink, (void*)(intptr_t)fd);
+    logger_buffered_sink_t buffered = logger_buffered_sink_new(&conf);
+    sink = logger_service_register_sink(logger_buffered_sink_write, buffered);
+    log_writes("log(buffered write)", count);
+    logger_service_unregister_sink(sink);
+    logger_buffered_sink_delete(buffered);
+
+    sink = logger_service_register_batch_sink(write_sink, (void*)(intptr_t)fd);
+    log_writes("log(batch write)", count);
+    logger_service_unregister_sink(sink);
+
+    close(fd);
+
+    logger_service_set_level(QUIET_TAG, LOGGER_SERVICE_LOGLEVEL_WARN);
+    log_disabled("log(disabled)", count);
+
+    for(size_t i = 0; i < 4; i++)
+    {
+        logger_service_unregister_sink(sinks[i]);
+    }
+
+    logger_service_stats_t stats;
+    logger_service_get_stats(&stats);
+    printf("queued %u, dropped %u, overwritten %u\n", stats.queued, stats.dropped, stats.overwritten);
+
+    return 0;
+}
\ No newline at end of file
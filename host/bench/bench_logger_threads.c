@@ -0,0 +1,213 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Throughput of the logger service with several logging threads.
+ *
+ * Usage: bench_logger_threads [messages] [threads] [sinks]
+ *        bench_logger_threads_async [messages] [threads] [sinks]
+ *        bench_logger_threads_binary [messages] [threads] [sinks]
+ *
+ * Logs the messages from 1, 2, 4, ... up to threads threads at the same time,
+ * with 0, 1, 2, 4, ... up to sinks sinks that discard the messages. Every run
+ * is made with messages that are logged and with messages that are filtered
+ * out by the level of their tag. Reports the calls per second of all threads
+ * together and the time per call of each thread, including delivery to the
+ * sinks for asynchronous logging. With more threads than cores, the time per
+ * call includes the time a thread waited for a core. The clock of the logger
+ * service is fixed, so every run formats the same timestamps.
+ */
+#define USE_LOGGER_SERVICE
+
+#include "bench.h"
+
+#include <pthread.h>
+
+#include <logger.h>
+
+static const char* TAG = "bench";
+static const char* QUIET_TAG = "bench_quiet";
+
+#if defined(CONFIG_LOGGER_SERVICE_BINARY)
+static const char* name = "binary";
+#elif defined(CONFIG_LOGGER_SERVICE_ASYNC)
+static const char* name = "async";
+#else
+static const char* name = "sync";
+#endif
+
+typedef struct run_s
+{
+    size_t count;       // Per thread
+    bool filtered;
+} run;
+
+// Timed by the thread itself, so the time the thread waited to be started is not included
+typedef struct log_thread_s
+{
+    pthread_t thread;
+    const run* r;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} log_thread_t;
+
+static pthread_barrier_t startBarrier;
+
+// 2021-01-01 00:00:00 UTC
+static time_t fixed_time(void* user_data)
+{
+    return 1609459200;
+}
+
+static const logger_service_clock_t fixedClock = { fixed_time, NULL, NULL, NULL };
+
+static void* log_thread(void* arg)
+{
+    log_thread_t* t = (log_thread_t*)arg;
+    const run* r = t->r;
+
+    pthread_barrier_wait(&startBarrier);
+    t->start_ns = bench_now_ns();
+
+    if(r->filtered)
+    {
+        for(size_t i = 0; i < r->count; i++)
+        {
+            LOG_I(QUIET_TAG, "message %u with value %d", (unsigned int)i, (int)(i * 7));
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < r->count; i++)
+        {
+            LOG_I(TAG, "message %u with value %d", (unsigned int)i, (int)(i * 7));
+        }
+    }
+
+    t->end_ns = bench_now_ns();
+
+    return NULL;
+}
+
+static void print_header(void)
+{
+    printf("%-16s %8s %6s %12s %14s %10s\n", "path", "threads", "sinks", "calls", "calls/s", "ns/call");
+}
+
+static void measure(size_t threads, size_t sinks, size_t count, bool filtered)
+{
+    sink_handle_t handles[sinks > 0 ? sinks : 1];
+    log_thread_t logThreads[threads];
+    run r = { count / threads, filtered };
+
+    for(size_t i = 0; i < sinks; i++)
+    {
+        handles[i] = logger_service_register_sink(bench_null_sink, NULL);
+    }
+
+    pthread_barrier_init(&startBarrier, NULL, (unsigned int)threads + 1);
+
+    for(size_t i = 0; i < threads; i++)
+    {
+        logThreads[i].r = &r;
+        pthread_create(&logThreads[i].thread, NULL, log_thread, &logThreads[i]);
+    }
+
+    pthread_barrier_wait(&startBarrier);
+
+    for(size_t i = 0; i < threads; i++)
+    {
+        pthread_join(logThreads[i].thread, NULL);
+    }
+
+    // From the first thread that started to the last thread that returned, and the average time of the threads
+    uint64_t start = logThreads[0].start_ns;
+    uint64_t end = logThreads[0].end_ns;
+    uint64_t threadNs = 0;
+
+    for(size_t i = 0; i < threads; i++)
+    {
+        start = logThreads[i].start_ns < start ? logThreads[i].start_ns : start;
+        end = logThreads[i].end_ns > end ? logThreads[i].end_ns : end;
+        threadNs += logThreads[i].end_ns - logThreads[i].start_ns;
+    }
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+    // Asynchronous logging is only done when the queue is empty
+    logger_service_flush();
+    end = bench_now_ns();
+#endif
+
+    uint64_t elapsed = end - start;
+
+    pthread_barrier_destroy(&startBarrier);
+
+    for(size_t i = 0; i < sinks; i++)
+    {
+        logger_service_unregister_sink(handles[i]);
+    }
+
+    size_t calls = r.count * threads;
+    char path[32];
+    snprintf(path, sizeof(path), "%s%s", name, filtered ? "(filtered)" : "");
+
+    printf("%-16s %8zu %6zu %12zu %14.0f %10.1f\n",
+        path,
+        threads,
+        sinks,
+        calls,
+        calls > 0 ? (double)calls * 1e9 / (double)elapsed : 0.0,
+        r.count > 0 ? (double)threadNs / (double)threads / (double)r.count : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 400000);
+    size_t maxThreads = bench_arg(argc, argv, 2, 4);
+    size_t maxSinks = bench_arg(argc, argv, 3, 4);
+
+    logger_service_set_clock(&fixedClock);
+    logger_service_init();
+    logger_service_set_level(QUIET_TAG, LOGGER_SERVICE_LOGLEVEL_WARN);
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+    // Measure the full cost of every message instead of how fast messages can be dropped
+    logger_service_set_overflow_policy(LOGGER_SERVICE_OVERFLOW_BLOCK);
+#endif
+
+    print_header();
+
+    for(int filtered = 0; filtered < 2; filtered++)
+    {
+        for(size_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            for(size_t sinks = 0; sinks <= maxSinks; sinks = sinks > 0 ? sinks * 2 : 1)
+            {
+                measure(threads, sinks, count, filtered != 0);
+            }
+        }
+    }
+
+    logger_service_stats_t stats;
+    logger_service_get_stats(&stats);
+    printf("queued %u, dropped %u, overwritten %u\n", stats.queued, stats.dropped, stats.overwritten);
+
+    return 0;
+}
\ No newline at end of file
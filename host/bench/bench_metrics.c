@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmark and check of the metrics of the logger service.
+ *
+ * Usage: bench_metrics [messages]
+ *        bench_metrics_async [messages]
+ *
+ * Checks the message counts per level and tag, the counts and latency
+ * histogram of a fast and a slow sink and the JSON of the metrics. Measures
+ * the cost of a LOG_I call with metrics and of reading the metrics.
+ */
+#define USE_LOGGER_SERVICE
+
+#include "bench.h"
+
+#include <logger.h>
+
+static const char* TAG = "bench";
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+static const char* name = "metrics(async)";
+#else
+static const char* name = "metrics";
+#endif
+
+static void slow_sink(const char* message, const size_t len, void* user_data)
+{
+    struct timespec duration = { 0, 3000000 };
+    nanosleep(&duration, NULL);
+}
+
+/*
+ * Checks
+ */
+static bool check(const char* what, bool ok)
+{
+    if(!ok)
+    {
+        printf("%s: wrong\n", what);
+    }
+
+    return ok;
+}
+
+static bool find_sink(const char* sinkName, logger_service_sink_metrics_t* metrics)
+{
+    for(size_t i = 0; logger_service_get_sink_metrics(i, metrics); i++)
+    {
+        if(metrics->name != NULL && strcmp(metrics->name, sinkName) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool find_tag(const char* tag, logger_service_tag_metrics_t* metrics)
+{
+    for(size_t i = 0; logger_service_get_tag_metrics(i, metrics); i++)
+    {
+        if(strcmp(metrics->tag, tag) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool check_metrics(void)
+{
+    bool ok = true;
+
+    logger_service_set_level("*", LOGGER_SERVICE_LOGLEVEL_INFO);
+
+    sink_handle_t fast = logger_service_register_sink(bench_null_sink, NULL);
+    sink_handle_t slow = logger_service_register_batch_sink((logger_batch_sink_t)slow_sink, NULL);
+    logger_service_set_sink_name(fast, "fast");
+    logger_service_set_sink_name(slow, "slow \"sink\"");
+
+    logger_service_metrics_t before;
+    logger_service_get_metrics(&before);
+
+    for(unsigned int i = 0; i < 10; i++)
+    {
+        LOG_E("metrics", "error %u", i);
+        LOG_W("metrics", "warning %u", i);
+        LOG_I("other", "info %u", i);
+        LOG_D("metrics", "debug %u, not logged", i);
+    }
+
+    logger_service_flush();
+
+    logger_service_metrics_t after;
+    logger_service_get_metrics(&after);
+
+    ok &= check("errors", after.messages[LOGGER_SERVICE_LOGLEVEL_ERROR] - before.messages[LOGGER_SERVICE_LOGLEVEL_ERROR] == 10);
+    ok &= check("warnings", after.messages[LOGGER_SERVICE_LOGLEVEL_WARN] - before.messages[LOGGER_SERVICE_LOGLEVEL_WARN] == 10);
+    ok &= check("infos", after.messages[LOGGER_SERVICE_LOGLEVEL_INFO] - before.messages[LOGGER_SERVICE_LOGLEVEL_INFO] == 10);
+    ok &= check("debugs", after.messages[LOGGER_SERVICE_LOGLEVEL_DEBUG] == before.messages[LOGGER_SERVICE_LOGLEVEL_DEBUG]);
+
+    logger_service_tag_metrics_t tag;
+    ok &= check("tag metrics", find_tag("metrics", &tag) && tag.messages == 20);
+    ok &= check("tag other", find_tag("other", &tag) && tag.messages == 10);
+
+    logger_service_sink_metrics_t fastMetrics;
+    logger_service_sink_metrics_t slowMetrics;
+    ok &= check("fast sink", find_sink("fast", &fastMetrics) && fastMetrics.calls == 30);
+    ok &= check("slow sink", find_sink("slow \"sink\"", &slowMetrics) && slowMetrics.calls >= 1 && slowMetrics.calls <= 30);
+    ok &= check("bytes", fastMetrics.bytes == slowMetrics.bytes && after.bytes - before.bytes == fastMetrics.bytes * 2);
+
+    // 3 ms falls in the bucket from 2048 to 4096 microseconds, unless the machine is very busy
+    ok &= check("slow latency", slowMetrics.latency[12] + slowMetrics.latency[13] + slowMetrics.latency[14] + slowMetrics.latency[15] == slowMetrics.calls && slowMetrics.max_us >= 3000);
+    ok &= check("slow time", slowMetrics.time_us >= 3000 * (uint64_t)slowMetrics.calls);
+
+    uint32_t fastCalls = 0;
+    for(size_t i = 0; i < LOGGER_SERVICE_LATENCY_BUCKETS; i++)
+    {
+        fastCalls += fastMetrics.latency[i];
+    }
+    ok &= check("fast latency", fastCalls == fastMetrics.calls && fastMetrics.latency[LOGGER_SERVICE_LATENCY_BUCKETS - 1] == 0);
+
+    // JSON, measured and written
+    int len = logger_service_metrics_json(NULL, 0);
+    char* json = (char*)malloc((size_t)len + 1);
+    ok &= check("json length", logger_service_metrics_json(json, (size_t)len + 1) == len && strlen(json) == (size_t)len);
+    ok &= check("json sink", strstr(json, "{\"name\":\"slow \\\"sink\\\"\",\"encoding\":\"text\",\"calls\":") != NULL);
+    ok &= check("json tag", strstr(json, "{\"tag\":\"other\",\"messages\":10}") != NULL);
+    ok &= check("json end", len > 2 && json[0] == '{' && strcmp(json + len - 2, "]}") == 0);
+
+    char truncated[16];
+    ok &= check("json truncated", logger_service_metrics_json(truncated, sizeof(truncated)) == len && strlen(truncated) == sizeof(truncated) - 1);
+
+    if(!ok)
+    {
+        printf("%s\n", json);
+    }
+
+    free(json);
+
+    logger_service_unregister_sink(slow);
+    logger_service_unregister_sink(fast);
+
+    return ok;
+}
+
+/*
+ * Benchmarks
+ */
+static void read_metrics(size_t count)
+{
+    logger_service_metrics_t metrics;
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        logger_service_get_metrics(&metrics);
+        bench_sink += metrics.bytes;
+    }
+    bench_report(name, "get_metrics", count, count, m);
+}
+
+static void write_json(size_t count)
+{
+    static char json[4096];
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        bench_sink += (uintptr_t)logger_service_metrics_json(json, sizeof(json));
+    }
+    bench_report(name, "metrics_json", count, count, m);
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 200000);
+
+    logger_service_init();
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+    // Measure the full cost of every message instead of how fast messages can be dropped
+    logger_service_set_overflow_policy(LOGGER_SERVICE_OVERFLOW_BLOCK);
+#endif
+
+    bool ok = check_metrics();
+
+    bench_print_header();
+
+    sink_handle_t sink = logger_service_register_sink(bench_null_sink, NULL);
+    logger_service_set_sink_name(sink, "null");
+
+    bench_log_messages(name, "log", TAG, count);
+    read_metrics(count);
+    write_json(count / 100);
+
+    logger_service_unregister_sink(sink);
+
+    if(!ok)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
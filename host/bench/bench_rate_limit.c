@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmark and check of the rate limit of the logger service.
+ *
+ * Usage: bench_rate_limit [messages]
+ *        bench_rate_limit_binary [messages]
+ *
+ * Measures the cost of LOG_I calls without a rate limit, with a rate limit
+ * they stay under and with a rate limit that suppresses them. Checks that a
+ * burst of messages from one call site is limited, that other call sites are
+ * not affected and that the suppressed messages are reported.
+ */
+#define USE_LOGGER_SERVICE
+
+#include "bench.h"
+
+#include <pthread.h>
+
+#include <logger.h>
+
+static const char* TAG = "bench";
+
+#ifdef CONFIG_LOGGER_SERVICE_BINARY
+static const char* name = "limit(binary)";
+#else
+static const char* name = "limit";
+#endif
+
+// Written by the drain task, the timer work task or the tasks that log, read by the checks
+typedef struct kept_s
+{
+    size_t received;
+    char last[CONFIG_LOGGER_SERVICE_MESSAGE_SIZE];
+    char report[CONFIG_LOGGER_SERVICE_MESSAGE_SIZE];
+} kept;
+
+static kept keptMessages;
+static pthread_mutex_t keptLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void keep_sink(const char* message, const size_t len, void* user_data)
+{
+    pthread_mutex_lock(&keptLock);
+
+    keptMessages.received++;
+    memcpy(keptMessages.last, message, len);
+    keptMessages.last[len] = '\0';
+
+    if(strstr(keptMessages.last, "last message repeated") != NULL)
+    {
+        memcpy(keptMessages.report, keptMessages.last, len + 1);
+    }
+
+    pthread_mutex_unlock(&keptLock);
+}
+
+// Copies the kept messages and starts counting the received messages from 0
+static void take_kept(kept* k)
+{
+    pthread_mutex_lock(&keptLock);
+    *k = keptMessages;
+    keptMessages.received = 0;
+    pthread_mutex_unlock(&keptLock);
+}
+
+static void wait_ms(long ms)
+{
+    struct timespec duration = { ms / 1000, (ms % 1000) * 1000000 };
+    nanosleep(&duration, NULL);
+}
+
+/*
+ * Checks
+ */
+static bool check(const char* what, bool ok, const kept* k)
+{
+    if(!ok)
+    {
+        printf("%s: wrong, last message \"%s\"\n", what, k->last);
+    }
+
+    return ok;
+}
+
+static size_t log_storm(size_t count)
+{
+    logger_service_stats_t stats;
+    logger_service_get_stats(&stats);
+    uint32_t suppressed = stats.suppressed;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        LOG_W(TAG, "storm %u", (unsigned int)i);
+    }
+
+    logger_service_flush();
+    logger_service_get_stats(&stats);
+
+    return stats.suppressed - suppressed;
+}
+
+static bool check_limit(void)
+{
+    bool ok = true;
+    kept k;
+    sink_handle_t sink = logger_service_register_sink(keep_sink, NULL);
+
+    // 10 messages at once, 5 per second after that
+    logger_service_set_rate_limit(5, 10);
+
+    take_kept(&k);
+    size_t suppressed = log_storm(100);
+    take_kept(&k);
+    ok &= check("burst suppressed", suppressed == 90, &k);
+    ok &= check("burst logged", k.received == 10 && strstr(k.last, "storm 9") != NULL, &k);
+
+    // Another call site has a bucket of its own
+    LOG_W(TAG, "other call site");
+    logger_service_flush();
+    take_kept(&k);
+    ok &= check("other call site", k.received == 1, &k);
+
+    // The suppressed messages are reported after the refill without another log call, after which the
+    // rate applies
+    wait_ms(1200);
+    logger_service_flush();
+    take_kept(&k);
+    ok &= check("report", k.received == 1 && strstr(k.report, "W (") != NULL && strstr(k.report, "bench: last message repeated 90 times: \"storm %u\"") != NULL, &k);
+
+    suppressed = log_storm(100);
+    take_kept(&k);
+    ok &= check("refill suppressed", suppressed == 95, &k);
+    ok &= check("refill logged", k.received == 5, &k);
+
+    // No limit
+    logger_service_set_rate_limit(0, 10);
+    suppressed = log_storm(100);
+    take_kept(&k);
+    ok &= check("disabled suppressed", suppressed == 0, &k);
+    ok &= check("disabled logged", k.received == 100, &k);
+
+    logger_service_unregister_sink(sink);
+
+    return ok;
+}
+
+/*
+ * Benchmarks
+ */
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 200000);
+
+    logger_service_init();
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+    // Measure the full cost of every message instead of how fast messages can be dropped
+    logger_service_set_overflow_policy(LOGGER_SERVICE_OVERFLOW_BLOCK);
+#endif
+
+    bool ok = check_limit();
+
+    bench_print_header();
+
+    sink_handle_t sink = logger_service_register_sink(bench_null_sink, NULL);
+
+    logger_service_set_rate_limit(0, 0);
+    bench_log_messages(name, "log(unlimited)", TAG, count);
+
+    logger_service_set_rate_limit(UINT32_MAX, UINT32_MAX);
+    bench_log_messages(name, "log(under limit)", TAG, count);
+
+    logger_service_set_rate_limit(1, 1);
+    bench_log_messages(name, "log(suppressed)", TAG, count);
+
+    logger_service_unregister_sink(sink);
+
+    if(!ok)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Stress test and throughput benchmark for the SPSC ring buffer.
+ *
+ * Usage: bench_ringbuf [records] [buffer_size]
+ *
+ * A producer thread writes numbered records of varying length in place, a
+ * consumer thread reads them in place and verifies their order and contents.
+ * Exits with a non-zero status on the first out of order or corrupt record.
+ */
+#include "bench.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <ringbuf.h>
+
+#define MAX_PAYLOAD 64
+
+typedef struct bench_ctx_s
+{
+    ringbuf  rb;
+    uint32_t records;
+    size_t   full;
+    size_t   empty;
+    size_t   bytes;
+    bool     failed;
+} bench_ctx;
+
+static size_t payload_length(uint32_t seq)
+{
+    return sizeof(seq) + seq % (MAX_PAYLOAD - sizeof(seq));
+}
+
+static void* producer(void* arg)
+{
+    bench_ctx* ctx = (bench_ctx*)arg;
+
+    for(uint32_t seq = 0; seq < ctx->records;)
+    {
+        size_t len = payload_length(seq);
+        void* record;
+
+        if(ringbuf_reserve(ctx->rb, len, &record) != UTIL_OK)
+        {
+            ctx->full++;
+            sched_yield();
+            continue;
+        }
+
+        memcpy(record, &seq, sizeof(seq));
+        memset((uint8_t*)record + sizeof(seq), (uint8_t)seq, len - sizeof(seq));
+        ringbuf_commit(ctx->rb, len);
+
+        seq++;
+    }
+
+    return NULL;
+}
+
+static void* consumer(void* arg)
+{
+    bench_ctx* ctx = (bench_ctx*)arg;
+
+    for(uint32_t expected = 0; expected < ctx->records;)
+    {
+        const void* record;
+        size_t len;
+
+        if(ringbuf_peek(ctx->rb, &record, &len) != UTIL_OK)
+        {
+            ctx->empty++;
+            sched_yield();
+            continue;
+        }
+
+        uint32_t seq;
+        memcpy(&seq, record, sizeof(seq));
+
+        if(seq != expected || len != payload_length(expected))
+        {
+            fprintf(stderr, "Out of order record: expected %u (%zu bytes), got %u (%zu bytes)\n", expected, payload_length(expected), seq, len);
+            ctx->failed = true;
+            return NULL;
+        }
+
+        for(size_t i = sizeof(seq); i < len; i++)
+        {
+            if(((const uint8_t*)record)[i] != (uint8_t)seq)
+            {
+                fprintf(stderr, "Corrupt record %u at byte %zu\n", seq, i);
+                ctx->failed = true;
+                return NULL;
+            }
+        }
+
+        ctx->bytes += len;
+        ringbuf_release(ctx->rb);
+
+        expected++;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    bench_ctx ctx = {
+        .records = (uint32_t)bench_arg(argc, argv, 1, 10000000)
+    };
+
+    size_t size = bench_arg(argc, argv, 2, 4096);
+
+    if(ringbuf_new(size, &ctx.rb) != UTIL_OK)
+    {
+        fprintf(stderr, "Could not allocate ring buffer\n");
+        return 1;
+    }
+
+    pthread_t producerThread;
+    pthread_t consumerThread;
+
+    uint64_t start = bench_now_ns();
+    pthread_create(&consumerThread, NULL, consumer, &ctx);
+    pthread_create(&producerThread, NULL, producer, &ctx);
+
+    pthread_join(consumerThread, NULL);
+
+    if(ctx.failed)
+    {
+        // The producer may be blocked on a full buffer, don't wait for it
+        return 1;
+    }
+
+    pthread_join(producerThread, NULL);
+    uint64_t elapsed = bench_now_ns() - start;
+
+    double seconds = (double)elapsed / 1e9;
+    printf("records:       %u\n", ctx.records);
+    printf("buffer size:   %zu\n", size);
+    printf("elapsed:       %.3f s\n", seconds);
+    printf("records/s:     %.0f\n", ctx.records / seconds);
+    printf("MB/s:          %.1f\n", (double)ctx.bytes / seconds / 1e6);
+    printf("ns/record:     %.1f\n", (double)elapsed / ctx.records);
+    printf("full retries:  %zu\n", ctx.full);
+    printf("empty retries: %zu\n", ctx.empty);
+
+    bool drained = ringbuf_is_empty(ctx.rb);
+    ringbuf_delete(ctx.rb);
+
+    if(!drained)
+    {
+        fprintf(stderr, "Ring buffer not empty after all records were consumed\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Microbenchmark for the timestamps of the logger service.
+ *
+ * Usage: bench_timestamp [timestamps]
+ *
+ * Compares formatting every timestamp with strftime, the way the logger
+ * service used to, with the cached timestamps, for timestamps that fall in
+ * the same second, advance a second or jump a minute every time.
+ */
+#include "bench.h"
+
+#include <logger_timestamp.h>
+
+// 2021-06-01 12:00:00 UTC
+#define BENCH_TIME ((time_t)1622548800)
+
+// The timestamp as formatted before the cache, which always read the processor clock
+static void format_strftime(time_t now, char* timestamp)
+{
+    clock_t ticks = clock();
+
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
+
+    if(now != (time_t)(-1) && timeinfo.tm_year >= (2020 - 1900))
+    {
+        strftime(timestamp, 20, "%F %T", gmtime(&now));
+    }
+    else
+    {
+        snprintf(timestamp, 20, "%li", (long)ticks);
+    }
+}
+
+static void format_cached(time_t now, char* timestamp)
+{
+    logger_timestamp_format(now, logger_timestamp_time_is_set(now) ? 0 : clock(), timestamp);
+}
+
+static void bench_format(const char* name, const char* operation, void (*format)(time_t now, char* timestamp), time_t step, size_t count)
+{
+    char timestamp[LOGGER_TIMESTAMP_SIZE];
+
+    // Every timestamp is advanced by step seconds, once in every 16 calls
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < count; i++)
+    {
+        format(BENCH_TIME + (time_t)(i / 16) * step, timestamp);
+        bench_sink += (uintptr_t)timestamp[18];
+    }
+    bench_report(name, operation, count, count, m);
+}
+
+static bool check_format(size_t count)
+{
+    char expected[LOGGER_TIMESTAMP_SIZE];
+    char actual[LOGGER_TIMESTAMP_SIZE];
+
+    for(size_t i = 0; i < count; i++)
+    {
+        time_t now = BENCH_TIME + (time_t)(bench_rand() % 600);
+
+        format_strftime(now, expected);
+        format_cached(now, actual);
+
+        if(strcmp(expected, actual) != 0)
+        {
+            printf("timestamp mismatch: expected %s, got %s\n", expected, actual);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = bench_arg(argc, argv, 1, 1000000);
+
+    if(!check_format(count / 10 + 1))
+    {
+        return 1;
+    }
+
+    bench_print_header();
+
+    bench_format("strftime", "same second", format_strftime, 0, count);
+    bench_format("cached", "same second", format_cached, 0, count);
+    bench_format("strftime", "next second", format_strftime, 1, count);
+    bench_format("cached", "next second", format_cached, 1, count);
+    bench_format("strftime", "next minute", format_strftime, 60, count);
+    bench_format("cached", "next minute", format_cached, 60, count);
+
+    return 0;
+}
\ No newline at end of file
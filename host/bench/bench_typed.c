@@ -0,0 +1,296 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Benchmarks of the typed container wrappers.
+ *
+ * Usage: bench_typed [size]
+ *
+ * Instantiates TYPED_SLIST, TYPED_SLIST_VALUE, TYPED_MAP, TYPED_MAP_VALUE and
+ * TYPED_VEC and runs add/get/iterate/remove through their wrappers on size
+ * items (default 10000), so a change to a wrapper that no longer compiles or
+ * no longer round trips its values breaks this benchmark. Exits with 1 when
+ * a wrapper returns a wrong value.
+ */
+#include "bench.h"
+
+#include <map.h>
+#include <slist.h>
+#include <vec.h>
+
+// The typed names are token pasted, so the types must be single identifiers
+typedef struct item_s
+{
+    uintptr_t id;
+} item;
+
+typedef uintptr_t id;
+
+TYPED_SLIST(item)
+TYPED_SLIST_VALUE(id)
+TYPED_MAP(item, item)
+TYPED_MAP_VALUE(item, id)
+TYPED_VEC(id)
+
+static item* items;
+static bool failed;
+
+static void check(const char* container, const char* operation, bool ok)
+{
+    if(!ok)
+    {
+        printf("%s %s: FAILED\n", container, operation);
+        failed = true;
+    }
+}
+
+static void bench_typed_slist(size_t size)
+{
+    slist_item list;
+    bool ok = slist_item_new(&list) == UTIL_OK;
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= slist_item_add(list, &items[i]) == UTIL_OK;
+    }
+    bench_report("slist_item", "add", size, size, m);
+    check("slist_item", "add", ok && slist_item_count(list) == size);
+
+    item* found = NULL;
+    ok = slist_item_get_at(list, size - 1, &found) == UTIL_OK;
+    check("slist_item", "get_at", ok && found == &items[size - 1]);
+
+    size_t index = 0;
+    item* current;
+    m = bench_start();
+    for(slist_iter_state iter = slist_item_iter_begin(list); slist_item_iter_next(&iter, &current) == UTIL_OK; index++)
+    {
+        ok &= current == &items[index];
+    }
+    bench_report("slist_item", "iterate", size, size, m);
+    check("slist_item", "iterate", ok && index == size);
+
+    m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= slist_item_remove(list, &items[i]) == UTIL_OK;
+    }
+    bench_report("slist_item", "remove_front", size, size, m);
+    check("slist_item", "remove", ok && slist_item_count(list) == 0);
+
+    slist_item_delete(list);
+}
+
+static void bench_typed_slist_value(size_t size)
+{
+    slist_id list;
+    bool ok = slist_id_new(&list) == UTIL_OK;
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= slist_id_add(list, items[i].id) == UTIL_OK;
+    }
+    bench_report("slist_id", "add", size, size, m);
+    check("slist_id", "add", ok && slist_id_count(list) == size);
+
+    id found = 0;
+    ok = slist_id_get_at(list, size - 1, &found) == UTIL_OK;
+    check("slist_id", "get_at", ok && found == items[size - 1].id);
+
+    size_t index = 0;
+    id current;
+    m = bench_start();
+    for(slist_iter_state iter = slist_id_iter_begin(list); slist_id_iter_next(&iter, &current) == UTIL_OK; index++)
+    {
+        ok &= current == items[index].id;
+    }
+    bench_report("slist_id", "iterate", size, size, m);
+    check("slist_id", "iterate", ok && index == size);
+
+    m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= slist_id_remove(list, items[i].id) == UTIL_OK;
+    }
+    bench_report("slist_id", "remove_front", size, size, m);
+    check("slist_id", "remove", ok && slist_id_count(list) == 0);
+
+    slist_id_delete(list);
+}
+
+static void bench_typed_map(size_t size)
+{
+    map_item_item m;
+    bool ok = map_item_item_new(&m) == UTIL_OK;
+
+    // Maps every item to the next one
+    bench_measurement t = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= map_item_item_add(m, &items[i], &items[(i + 1) % size]) == UTIL_OK;
+    }
+    bench_report("map_item_item", "add", size, size, t);
+    check("map_item_item", "add", ok && map_item_item_count(m) == size);
+
+    item* value;
+    t = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= map_item_item_get(m, &items[i], &value) == UTIL_OK && value == &items[(i + 1) % size];
+    }
+    bench_report("map_item_item", "get", size, size, t);
+    check("map_item_item", "get", ok);
+
+    size_t visited = 0;
+    const item* key;
+    t = bench_start();
+    for(map_iter_state iter = map_item_item_iter_begin(m); map_item_item_iter_next(&iter, &key, &value) == UTIL_OK; visited++)
+    {
+        ok &= value == &items[(size_t)(key - items + 1) % size];
+    }
+    bench_report("map_item_item", "iterate", size, size, t);
+    check("map_item_item", "iterate", ok && visited == size);
+
+    t = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= map_item_item_remove(m, &items[i]) == UTIL_OK;
+    }
+    bench_report("map_item_item", "remove", size, size, t);
+    check("map_item_item", "remove", ok && map_item_item_count(m) == 0);
+
+    map_item_item_delete(m);
+}
+
+static void bench_typed_map_value(size_t size)
+{
+    map_item_id m;
+    bool ok = map_item_id_new(&m) == UTIL_OK;
+
+    bench_measurement t = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= map_item_id_add(m, &items[i], items[i].id) == UTIL_OK;
+    }
+    bench_report("map_item_id", "add", size, size, t);
+    check("map_item_id", "add", ok && map_item_id_count(m) == size);
+
+    id value;
+    t = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= map_item_id_get(m, &items[i], &value) == UTIL_OK && value == items[i].id;
+    }
+    bench_report("map_item_id", "get", size, size, t);
+    check("map_item_id", "get", ok);
+
+    size_t visited = 0;
+    const item* key;
+    t = bench_start();
+    for(map_iter_state iter = map_item_id_iter_begin(m); map_item_id_iter_next(&iter, &key, &value) == UTIL_OK; visited++)
+    {
+        ok &= value == key->id;
+    }
+    bench_report("map_item_id", "iterate", size, size, t);
+    check("map_item_id", "iterate", ok && visited == size);
+
+    t = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= map_item_id_remove(m, &items[i]) == UTIL_OK;
+    }
+    bench_report("map_item_id", "remove", size, size, t);
+    check("map_item_id", "remove", ok && map_item_id_count(m) == 0);
+
+    map_item_id_delete(m);
+}
+
+static void bench_typed_vec(size_t size)
+{
+    vec_id v;
+    bool ok = vec_id_new(&v) == UTIL_OK;
+
+    bench_measurement m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= vec_id_push(v, items[i].id) == UTIL_OK;
+    }
+    bench_report("vec_id", "push", size, size, m);
+    check("vec_id", "push", ok && vec_id_count(v) == size);
+
+    m = bench_start();
+    for(size_t i = 0; i < size; i++)
+    {
+        ok &= *vec_id_at(v, i) == items[i].id;
+    }
+    bench_report("vec_id", "at", size, size, m);
+    check("vec_id", "at", ok);
+
+    size_t index = 0;
+    m = bench_start();
+    VEC_FOREACH(id, current, v)
+    {
+        ok &= *current == items[index++].id;
+    }
+    bench_report("vec_id", "iterate", size, size, m);
+    check("vec_id", "iterate", ok && index == size);
+
+    id value;
+    m = bench_start();
+    for(size_t i = size; i > 0; i--)
+    {
+        ok &= vec_id_pop(v, &value) == UTIL_OK && value == items[i - 1].id;
+    }
+    bench_report("vec_id", "pop", size, size, m);
+    check("vec_id", "pop", ok && vec_id_count(v) == 0);
+
+    vec_id_delete(v);
+}
+
+int main(int argc, char** argv)
+{
+    size_t size = bench_arg(argc, argv, 1, 10000);
+    if(size == 0)
+    {
+        return 0;
+    }
+
+    items = malloc(size * sizeof(item));
+    if(items == NULL)
+    {
+        return 1;
+    }
+    for(size_t i = 0; i < size; i++)
+    {
+        items[i].id = i + 1;
+    }
+
+    bench_print_header();
+    bench_typed_slist(size);
+    bench_typed_slist_value(size);
+    bench_typed_map(size);
+    bench_typed_map_value(size);
+    bench_typed_vec(size);
+
+    free(items);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Serves the live log on Linux, to try the websocket sink with a local
+ * websocket client, and the persistent log ring kept in live_log_server.bin:
+ *
+ *   ./live_log_server [url]
+ *   websocat ws://localhost:8000/log
+ *   curl http://localhost:8000/log/saved
+ *   curl http://localhost:8000/log/metrics
+ *
+ * Logs a message every 250 ms and a debug message every second, send "D"
+ * over the websocket to receive the debug messages too. The saved log also
+ * holds the messages of earlier runs.
+ */
+#define USE_LOGGER_SERVICE
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <logger.h>
+#include <logger_buffered_sink.h>
+#include <logger_ring.h>
+#include <mongoose7_live_log.h>
+#include <mongoose7_log_metrics.h>
+#include <mongoose7_log_ring.h>
+
+static const char* TAG = "live_log_server";
+
+static void* log_thread(void* arg)
+{
+    for(unsigned int i = 0;; i++)
+    {
+        LOG_I(TAG, "Message %u", i);
+
+        if(i % 4 == 0)
+        {
+            LOG_D(TAG, "Debug message %u", i / 4);
+        }
+
+        usleep(250000);
+    }
+
+    return NULL;
+}
+
+static void event_handler(struct mg_connection* c, int ev, void* evData, void* fnData)
+{
+    if(mongoose7_log_ring_event_handler(c, ev, evData, fnData) || mongoose7_log_metrics_event_handler(c, ev, evData, fnData))
+    {
+        return;
+    }
+
+    if(!mongoose7_live_log_event_handler(c, ev, evData, fnData) && ev == MG_EV_HTTP_MSG)
+    {
+        mg_http_reply(c, 404, "", "Connect to %s with a websocket client or get %s or %s\n", "/log", "/log/saved", "/log/metrics");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* url = argc > 1 ? argv[1] : "http://localhost:8000";
+
+    logger_service_init();
+
+    if(!mongoose7_live_log_start())
+    {
+        return 1;
+    }
+
+    // 64 KiB of persistent log, written at most every 100 ms
+    logger_ring_storage_t storage;
+    if(!logger_ring_storage_file(&storage, "live_log_server.bin", 4096, 16))
+    {
+        return 1;
+    }
+
+    logger_ring_t ring = logger_ring_open(&storage);
+
+    logger_buffered_sink_conf_t conf;
+    logger_buffered_sink_conf_init(&conf, logger_ring_write, ring);
+    logger_buffered_sink_t buffered = logger_buffered_sink_new(&conf);
+    sink_handle_t sink = logger_service_register_sink(logger_buffered_sink_write, buffered);
+    logger_service_set_sink_name(sink, "ring");
+
+    mongoose7_log_ring_set(ring);
+
+    struct mg_mgr manager;
+    mg_mgr_init(&manager);
+
+    if(mg_http_listen(&manager, url, event_handler, NULL) == NULL)
+    {
+        return 1;
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, log_thread, NULL);
+
+    for(;;)
+    {
+        mg_mgr_poll(&manager, 100);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Stand-in for the sdkconfig.h that ESP-IDF generates from Kconfig, with the
+ * default values of the options used by the components in the host build.
+ * Options can be overridden with compile definitions.
+ */
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+#ifndef CONFIG_LOG_DEFAULT_LEVEL
+#define CONFIG_LOG_DEFAULT_LEVEL 3
+#endif
+
+// Logger Service
+#ifndef CONFIG_LOGGER_SERVICE_MESSAGE_SIZE
+#define CONFIG_LOGGER_SERVICE_MESSAGE_SIZE 512
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_FORMAT_BUFFERS
+#define CONFIG_LOGGER_SERVICE_FORMAT_BUFFERS 4
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_MIN_LEVEL
+#define CONFIG_LOGGER_SERVICE_MIN_LEVEL 5
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_TAGS
+#define CONFIG_LOGGER_SERVICE_TAGS 32
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_TAG_CACHE_SIZE
+#define CONFIG_LOGGER_SERVICE_TAG_CACHE_SIZE 64
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_RATE_LIMIT
+#define CONFIG_LOGGER_SERVICE_RATE_LIMIT 0
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_RATE_LIMIT_BURST
+#define CONFIG_LOGGER_SERVICE_RATE_LIMIT_BURST 20
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES
+#define CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES 64
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_METRICS
+#define CONFIG_LOGGER_SERVICE_METRICS 1
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_WORK_TASK_STACK_SIZE
+#define CONFIG_LOGGER_SERVICE_WORK_TASK_STACK_SIZE 3072
+#endif
+
+#ifndef CONFIG_LOGGER_SERVICE_WORK_TASK_PRIORITY
+#define CONFIG_LOGGER_SERVICE_WORK_TASK_PRIORITY 1
+#endif
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+#ifndef CONFIG_LOGGER_SERVICE_ASYNC_QUEUE_LENGTH
+#define CONFIG_LOGGER_SERVICE_ASYNC_QUEUE_LENGTH 16
+#endif
+#if !defined(CONFIG_LOGGER_SERVICE_ASYNC_OVERFLOW_DROP_OLDEST) && !defined(CONFIG_LOGGER_SERVICE_ASYNC_OVERFLOW_BLOCK)
+#define CONFIG_LOGGER_SERVICE_ASYNC_OVERFLOW_DROP_NEWEST 1
+#endif
+#ifndef CONFIG_LOGGER_SERVICE_ASYNC_BATCH_SIZE
+#define CONFIG_LOGGER_SERVICE_ASYNC_BATCH_SIZE 1024
+#endif
+#define CONFIG_LOGGER_SERVICE_ASYNC_TASK_STACK_SIZE 3072
+#define CONFIG_LOGGER_SERVICE_ASYNC_TASK_PRIORITY 1
+#endif
+
+#if defined(CONFIG_LOGGER_SERVICE_BINARY) && !defined(CONFIG_LOGGER_SERVICE_BINARY_ARGS_SIZE)
+#define CONFIG_LOGGER_SERVICE_BINARY_ARGS_SIZE 64
+#endif
+
+#endif // SDKCONFIG_H
\ No newline at end of file
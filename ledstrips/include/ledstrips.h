@@ -1,9 +1,11 @@
 #ifndef LEDSTRIPS_H
 #define LEDSTRIPS_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <hal/gpio_types.h>
+#include <freertos/FreeRTOS.h>
 
 // WS2812 https://cdn-shop.adafruit.com/datasheets/WS2812.pdf
 #define WS2812_T0L 0.00000035
@@ -75,9 +77,25 @@ typedef struct ledstrips_color_s
 
 } __attribute__((packed)) ledstrips_color_t;
 
+/**
+ * @brief Callback called when a frame has been sent to the ledstrip
+ * 
+ * Called from the transmit task of the device, so it should not block for long. The frame buffer of
+ * the frame is only freed after the callback returns, so the callback must not wait for a free buffer.
+ * 
+ * @param handle Handle to ledstrip device
+ * @param frame Number of the frame, frames submitted to a device are numbered from 0
+ * @param user_data User data given to ledstrips_set_frame_callback
+ */
+typedef void (*ledstrips_frame_callback_t)(ledstrips_device_handle_t handle, uint32_t frame, void* user_data);
+
 /**
  * @brief Add a ledstrip device and allocate all resources required for the device.
  * 
+ * Every device has LEDSTRIPS_FRAME_BUFFERS frame buffers and a task that sends the frames submitted to
+ * the device, so a frame can be prepared while the previous frame is being sent. A device must only be
+ * used by one task at a time.
+ * 
  * @param gpioNum The GPIO number the led strip's data line is attached to
  * @param chip_type The chip type the led strip uses
  * @param length The length of the ledstrip in number of leds
@@ -88,13 +106,52 @@ void ledstrips_add_device(gpio_num_t gpioNum, ledstrips_chip_type_t chip_type, s
 /**
  * @brief Removes a ledstrip device and releases all allocated recources associated with the device.
  * 
+ * Frames that were submitted are sent before the device is removed.
+ * 
  * @param handle Handle to free
  */
 void ledstrips_remove_device(ledstrips_device_handle_t handle);
 
+/**
+ * @brief Submit a frame with the colors of the individual leds in the ledstrip.
+ * 
+ * Encodes the colors into a free frame buffer and queues the frame to be sent, then returns without
+ * waiting for the frame to be sent. Only waits for a free frame buffer when all frame buffers are
+ * queued or being sent. Leds beyond the length of the array keep the color of the previous frame.
+ * 
+ * @param handle Handle to ledstrip device
+ * @param colors Array of color structs, one per led, in the order they are connected in
+ * @param length Length of the array
+ * @param timeout Ticks to wait for a free frame buffer
+ * @return true if the frame was queued, false if no frame buffer became free in time
+ */
+bool ledstrips_submit_frame(const ledstrips_device_handle_t handle, const ledstrips_color_t* const colors, size_t length, TickType_t timeout);
+
+/**
+ * @brief Wait until all submitted frames have been sent and their frame callbacks have returned.
+ * 
+ * @param handle Handle to ledstrip device
+ * @param timeout Ticks to wait
+ * @return true if all frames were sent, false on timeout
+ */
+bool ledstrips_wait_frames(const ledstrips_device_handle_t handle, TickType_t timeout);
+
+/**
+ * @brief Set a callback to be called every time a frame has been sent.
+ * 
+ * Set the callback while no frames are being sent, e.g. before the first frame is submitted.
+ * 
+ * @param handle Handle to ledstrip device
+ * @param callback Callback, NULL to remove the callback
+ * @param user_data User data passed to the callback
+ */
+void ledstrips_set_frame_callback(const ledstrips_device_handle_t handle, ledstrips_frame_callback_t callback, void* user_data);
+
 /**
  * @brief Set the colors of the individual leds in the ledstrip.
  * 
+ * Same as ledstrips_submit_frame, waiting as long as it takes for a free frame buffer.
+ * 
  * @param handle Handle to ledstrip device
  * @param colors Array of color structs, one per led, in the order they are connected in
  * @param length Length of the array
@@ -106,6 +163,7 @@ void ledstrips_set_colors(const ledstrips_device_handle_t handle, const ledstrip
  * 
  * This will set the colors of the leds in the ledstrip according the specified sequence.
  * The sequence will repeat if it is shorter then the amount of leds in the ledstrip.
+ * The frame is submitted like ledstrips_set_colors does.
  * 
  * @param handle Handle to ledstrip device
  * @param sequence_colors Array of color structs, one per led in the sequence
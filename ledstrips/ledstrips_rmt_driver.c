@@ -1,6 +1,11 @@
 #include "ledstrips.h"
 
+#include <sdkconfig.h>
+
 #include <esp_system.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 
 #include <soc/soc.h>
 #include <driver/rmt.h>
@@ -8,12 +13,19 @@
 #include <logger.h>
 
 #include <math.h>
+#include <string.h>
 
 #define RMT_TICKS(x) x*APB_CLK_FREQ
 
 static const char* TAG = "ledstrips_rmt_driver";
 static const size_t cgNrOfRmtItemsPerColor = 8;
 
+typedef struct frame_buffer_s
+{
+    rmt_item32_t* items;
+    uint32_t frame;
+} frame_buffer_t;
+
 struct ledstrips_device_s
 {
     size_t length;
@@ -26,15 +38,41 @@ struct ledstrips_device_s
     rmt_item32_t rmt_item_1;
     rmt_item32_t rmt_item_res;
 
+    // Items of a frame, including the reset item at the end
     size_t items_length;
-    rmt_item32_t* items;
+    frame_buffer_t buffers[CONFIG_LEDSTRIPS_FRAME_BUFFERS];
+    frame_buffer_t* lastFrame;
+    uint32_t nextFrame;
+
+    // Buffers that can be encoded into, and frames waiting to be sent. A NULL frame stops the transmit task
+    QueueHandle_t freeBuffers;
+    QueueHandle_t queuedFrames;
+    TaskHandle_t txTask;
+    SemaphoreHandle_t txTaskStopped;
+
+    ledstrips_frame_callback_t frameCallback;
+    void* frameCallbackUserData;
 };
 
 static void rmt_transmission(rmt_channel_t rmt_channel, const rmt_item32_t* items, size_t length)
 {
     esp_err_t err;
 
-    // Wait for ongoing transmissions to complete
+    err = rmt_write_items(rmt_channel, items, length, false);
+    if(err != ESP_OK)
+    {
+        switch(err)
+        {
+            case ESP_ERR_INVALID_ARG:
+                LOG_E(TAG, "rmt_write_items parameter error");
+                break;
+            default:
+                LOG_E(TAG, "rmt_write_items unknown error: %d", err);
+        }
+        return;
+    }
+
+    // Wait for the transmission to complete, the items must stay valid until then
     err = rmt_wait_tx_done(rmt_channel, portMAX_DELAY);
     if(err != ESP_OK)
     {
@@ -53,40 +91,105 @@ static void rmt_transmission(rmt_channel_t rmt_channel, const rmt_item32_t* item
                 LOG_E(TAG, "rmt_wait_tx_done unknown error: %d", err);
         }
     }
+}
 
-    err = rmt_write_items(rmt_channel, items, length, false);
-    if(err != ESP_OK)
+static void ledstrips_tx_task(void* arg)
+{
+    const ledstrips_device_handle_t handle = (ledstrips_device_handle_t)arg;
+    frame_buffer_t* buffer;
+
+    while(xQueueReceive(handle->queuedFrames, &buffer, portMAX_DELAY) == pdTRUE && buffer != NULL)
     {
-        switch(err)
+        rmt_transmission(handle->rmt_channel, buffer->items, handle->items_length);
+
+        if(handle->frameCallback != NULL)
         {
-            case ESP_ERR_INVALID_ARG:
-                LOG_E(TAG, "rmt_write_items parameter error");
-                break;
-            default:
-                LOG_E(TAG, "rmt_write_items unknown error: %d", err);
+            handle->frameCallback(handle, buffer->frame, handle->frameCallbackUserData);
         }
+
+        // Only free the buffer once the callback returned, so waiting for all buffers includes the callbacks
+        xQueueSend(handle->freeBuffers, &buffer, portMAX_DELAY);
     }
+
+    xSemaphoreGive(handle->txTaskStopped);
+    vTaskDelete(NULL);
 }
 
-static void ledstrips_set_items_for_color(const ledstrips_device_handle_t handle, const ledstrips_color_t* const color, size_t led_idx)
+static void ledstrips_set_items_for_color(const ledstrips_device_handle_t handle, rmt_item32_t* items, const ledstrips_color_t* const color, size_t led_idx)
 {
     size_t baseIdx = led_idx * handle->nrOfColors * cgNrOfRmtItemsPerColor;
 
     for (int colorIdx = 0; colorIdx < handle->nrOfColors; ++colorIdx)
     {
         uint8_t colorChannelIdx = handle->colorSequence[colorIdx];
-        uint8_t* const colorChannel = &(color->channels[colorChannelIdx]);
+        const uint8_t* const colorChannel = &(color->channels[colorChannelIdx]);
 
         for (int bitIdx = 0; bitIdx < 8; bitIdx++)
         {
-            handle->items[baseIdx + colorIdx * 8 + bitIdx] = ((*colorChannel) & (0x80 >> bitIdx)) ? handle->rmt_item_1 : handle->rmt_item_0;
+            items[baseIdx + colorIdx * 8 + bitIdx] = ((*colorChannel) & (0x80 >> bitIdx)) ? handle->rmt_item_1 : handle->rmt_item_0;
         }
     }
 }
 
-static void ledstrips_reset(const ledstrips_device_handle_t handle)
+static void ledstrips_free_device(ledstrips_device_handle_t handle)
 {
-    rmt_transmission(handle->rmt_channel, &handle->rmt_item_res, 1);
+    for(size_t i = 0; i < CONFIG_LEDSTRIPS_FRAME_BUFFERS; ++i)
+    {
+        free(handle->buffers[i].items);
+    }
+
+    if(handle->freeBuffers != NULL)
+    {
+        vQueueDelete(handle->freeBuffers);
+    }
+    if(handle->queuedFrames != NULL)
+    {
+        vQueueDelete(handle->queuedFrames);
+    }
+    if(handle->txTaskStopped != NULL)
+    {
+        vSemaphoreDelete(handle->txTaskStopped);
+    }
+
+    free(handle);
+}
+
+static bool ledstrips_allocate_frames(ledstrips_device_handle_t handle)
+{
+    handle->items_length = handle->length * handle->nrOfColors * cgNrOfRmtItemsPerColor + 1;
+
+    handle->freeBuffers = xQueueCreate(CONFIG_LEDSTRIPS_FRAME_BUFFERS, sizeof(frame_buffer_t*));
+    handle->queuedFrames = xQueueCreate(CONFIG_LEDSTRIPS_FRAME_BUFFERS + 1, sizeof(frame_buffer_t*));
+    handle->txTaskStopped = xSemaphoreCreateBinary();
+    if(handle->freeBuffers == NULL || handle->queuedFrames == NULL || handle->txTaskStopped == NULL)
+    {
+        LOG_E(TAG, "Can not create ledstrips frame queues");
+        return false;
+    }
+
+    for(size_t i = 0; i < CONFIG_LEDSTRIPS_FRAME_BUFFERS; ++i)
+    {
+        frame_buffer_t* buffer = &handle->buffers[i];
+
+        buffer->items = (rmt_item32_t*)malloc(handle->items_length * sizeof(rmt_item32_t));
+        if(buffer->items == NULL)
+        {
+            LOG_E(TAG, "Can not allocate memory for ledstrips items buffer");
+            return false;
+        }
+
+        // Start with all leds off, every frame ends with the reset
+        for(size_t j = 0; j < handle->items_length - 1; ++j)
+        {
+            buffer->items[j] = handle->rmt_item_0;
+        }
+        buffer->items[handle->items_length - 1] = handle->rmt_item_res;
+
+        xQueueSend(handle->freeBuffers, &buffer, 0);
+    }
+    handle->lastFrame = &handle->buffers[0];
+
+    return true;
 }
 
 void ledstrips_add_device(gpio_num_t gpioNum, ledstrips_chip_type_t chip_type, size_t length, ledstrips_device_handle_t* handle)
@@ -109,16 +212,16 @@ void ledstrips_add_device(gpio_num_t gpioNum, ledstrips_chip_type_t chip_type, s
     ESP_ERROR_CHECK(rmt_config(&config));
     ESP_ERROR_CHECK(rmt_driver_install(config.channel, 0, 0));
 
+    *handle = NULL;
+
     ledstrips_device_handle_t newHandle = (ledstrips_device_handle_t)calloc(1, sizeof(*newHandle));
     if(newHandle == NULL)
     {
         LOG_E(TAG, "Can not allocate memory for ledstrips device handle");
+        ESP_ERROR_CHECK(rmt_driver_uninstall(config.channel));
         return;
     }
 
-    // Assign the new handle
-    *handle = newHandle;
-
     newHandle->length = length;
     newHandle->rmt_channel = config.channel;
 
@@ -156,63 +259,142 @@ void ledstrips_add_device(gpio_num_t gpioNum, ledstrips_chip_type_t chip_type, s
             newHandle->rmt_item_0 = (rmt_item32_t){{{ RMT_TICKS(SK6812RGBW_T0H), 1 , RMT_TICKS(SK6812RGBW_T0L), 0}}};
             newHandle->rmt_item_1 = (rmt_item32_t){{{ RMT_TICKS(SK6812RGBW_T1H), 1, RMT_TICKS(SK6812RGBW_T1L), 0 }}};
             newHandle->rmt_item_res = (rmt_item32_t){{{ RMT_TICKS(SK6812RGBW_RES), 0, 0, 0 }}};
-
-            newHandle->items_length = newHandle->length * newHandle->nrOfColors * cgNrOfRmtItemsPerColor;
-            newHandle->items = (rmt_item32_t*)malloc(newHandle->items_length * sizeof(rmt_item32_t));
-            if(newHandle->items == NULL)
-            {
-                LOG_E(TAG, "Can not allocate memory for ledstrips items buffer");
-                return;
-            }
-
             break;
 
         default:
-            // Unknown
-            newHandle->rmt_item_0 = (rmt_item32_t){{{ 0, 0, 0, 0 }}};
-            newHandle->rmt_item_1 = (rmt_item32_t){{{ 0, 0, 0, 0 }}};
-            newHandle->rmt_item_res = (rmt_item32_t){{{ 0, 0, 0, 0 }}};
+            LOG_E(TAG, "Unknown ledstrips chip type: %d", chip_type);
+            ledstrips_free_device(newHandle);
+            ESP_ERROR_CHECK(rmt_driver_uninstall(config.channel));
             return;
     }
+
+    if(!ledstrips_allocate_frames(newHandle))
+    {
+        ledstrips_free_device(newHandle);
+        ESP_ERROR_CHECK(rmt_driver_uninstall(config.channel));
+        return;
+    }
+
+    if(xTaskCreate(ledstrips_tx_task, "ledstrips_tx", CONFIG_LEDSTRIPS_TX_TASK_STACK_SIZE, newHandle, CONFIG_LEDSTRIPS_TX_TASK_PRIORITY, &newHandle->txTask) != pdPASS)
+    {
+        LOG_E(TAG, "Can not create ledstrips transmit task");
+        ledstrips_free_device(newHandle);
+        ESP_ERROR_CHECK(rmt_driver_uninstall(config.channel));
+        return;
+    }
+
+    // Assign the new handle
+    *handle = newHandle;
 }
 
 void ledstrips_remove_device(ledstrips_device_handle_t handle)
 {
     if(handle != NULL)
     {
+        // Send the queued frames, then stop the transmit task
+        frame_buffer_t* stop = NULL;
+        xQueueSend(handle->queuedFrames, &stop, portMAX_DELAY);
+        xSemaphoreTake(handle->txTaskStopped, portMAX_DELAY);
+
         ESP_ERROR_CHECK(rmt_driver_uninstall(handle->rmt_channel));
 
-        free(handle);
+        ledstrips_free_device(handle);
     }
 }
 
-void ledstrips_set_colors(const ledstrips_device_handle_t handle, const ledstrips_color_t* const colors, size_t length)
+bool ledstrips_submit_frame(const ledstrips_device_handle_t handle, const ledstrips_color_t* const colors, size_t length, TickType_t timeout)
 {
+    frame_buffer_t* buffer;
+    if(xQueueReceive(handle->freeBuffers, &buffer, timeout) != pdTRUE)
+    {
+        return false;
+    }
+
     // Ensure length does not exeed ledstrip length
-    length= fmin(length, handle->length);
+    length = fmin(length, handle->length);
 
     for(size_t i = 0; i < length; ++i)
     {
-        ledstrips_set_items_for_color(handle, &colors[i], i);
+        ledstrips_set_items_for_color(handle, buffer->items, &colors[i], i);
     }
-    
-    rmt_transmission(handle->rmt_channel, handle->items, handle->items_length);
-    ledstrips_reset(handle);
+
+    // Leds that are not set keep the color of the previous frame
+    if(length < handle->length && buffer != handle->lastFrame)
+    {
+        size_t offset = length * handle->nrOfColors * cgNrOfRmtItemsPerColor;
+        memcpy(&buffer->items[offset], &handle->lastFrame->items[offset], (handle->items_length - 1 - offset) * sizeof(rmt_item32_t));
+    }
+
+    buffer->frame = handle->nextFrame++;
+    handle->lastFrame = buffer;
+
+    // Can not fail, there is room for every buffer and the stop frame
+    xQueueSend(handle->queuedFrames, &buffer, portMAX_DELAY);
+
+    return true;
+}
+
+bool ledstrips_wait_frames(const ledstrips_device_handle_t handle, TickType_t timeout)
+{
+    frame_buffer_t* buffers[CONFIG_LEDSTRIPS_FRAME_BUFFERS];
+    size_t taken = 0;
+
+    // All frames are sent when every buffer is free again
+    TimeOut_t timeOut;
+    vTaskSetTimeOutState(&timeOut);
+    while(taken < CONFIG_LEDSTRIPS_FRAME_BUFFERS)
+    {
+        if(xQueueReceive(handle->freeBuffers, &buffers[taken], timeout) != pdTRUE)
+        {
+            break;
+        }
+        ++taken;
+
+        // Shrink the timeout by the time spent waiting, keep trying the free buffers without waiting once it is spent
+        if(xTaskCheckForTimeOut(&timeOut, &timeout) == pdTRUE)
+        {
+            timeout = 0;
+        }
+    }
+
+    for(size_t i = 0; i < taken; ++i)
+    {
+        xQueueSend(handle->freeBuffers, &buffers[i], 0);
+    }
+
+    return taken == CONFIG_LEDSTRIPS_FRAME_BUFFERS;
+}
+
+void ledstrips_set_frame_callback(const ledstrips_device_handle_t handle, ledstrips_frame_callback_t callback, void* user_data)
+{
+    handle->frameCallbackUserData = user_data;
+    handle->frameCallback = callback;
+}
+
+void ledstrips_set_colors(const ledstrips_device_handle_t handle, const ledstrips_color_t* const colors, size_t length)
+{
+    ledstrips_submit_frame(handle, colors, length, portMAX_DELAY);
 }
 
 void ledstrips_set_sequence(const ledstrips_device_handle_t handle, const ledstrips_color_t* const sequence_colors, size_t sequence_length)
 {
     // Ensure sequence length does not exeed ledstrip length
     sequence_length = fmin(sequence_length, handle->length);
+    if(sequence_length == 0)
+    {
+        return;
+    }
+
+    frame_buffer_t* buffer;
+    xQueueReceive(handle->freeBuffers, &buffer, portMAX_DELAY);
 
-    for(size_t i = 0; i < handle->length; i += sequence_length)
+    for(size_t i = 0; i < handle->length; ++i)
     {
-        for(size_t j = 0; j < sequence_length; ++j)
-        {
-            ledstrips_set_items_for_color(handle, &sequence_colors[j], i+j);
-        }
+        ledstrips_set_items_for_color(handle, buffer->items, &sequence_colors[i % sequence_length], i);
     }
 
-    rmt_transmission(handle->rmt_channel, handle->items, handle->items_length);
-    ledstrips_reset(handle);
+    buffer->frame = handle->nextFrame++;
+    handle->lastFrame = buffer;
+
+    xQueueSend(handle->queuedFrames, &buffer, portMAX_DELAY);
 }
\ No newline at end of file
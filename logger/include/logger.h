@@ -6,11 +6,34 @@
     // Use the logger service for advanced logging scenarios
     #include "logger_service.h"
 
-    #define LOG_E(tag, format, ... ) logger_service_log(LOGGER_SERVICE_LOGLEVEL_ERROR,   LOGGER_SERVICE_FORMAT(E, format), logger_service_timestamp, tag, ##__VA_ARGS__)
-    #define LOG_W(tag, format, ... ) logger_service_log(LOGGER_SERVICE_LOGLEVEL_WARN,    LOGGER_SERVICE_FORMAT(W, format), logger_service_timestamp, tag, ##__VA_ARGS__)
-    #define LOG_I(tag, format, ... ) logger_service_log(LOGGER_SERVICE_LOGLEVEL_INFO,    LOGGER_SERVICE_FORMAT(I, format), logger_service_timestamp, tag, ##__VA_ARGS__)
-    #define LOG_D(tag, format, ... ) logger_service_log(LOGGER_SERVICE_LOGLEVEL_DEBUG,   LOGGER_SERVICE_FORMAT(D, format), logger_service_timestamp, tag, ##__VA_ARGS__)
-    #define LOG_V(tag, format, ... ) logger_service_log(LOGGER_SERVICE_LOGLEVEL_VERBOSE, LOGGER_SERVICE_FORMAT(V, format), logger_service_timestamp, tag, ##__VA_ARGS__)
+    #include <sdkconfig.h>
+
+    // Most verbose level compiled in, can be overridden per file by defining it before including this header
+    #ifndef LOGGER_SERVICE_MIN_LEVEL
+    #define LOGGER_SERVICE_MIN_LEVEL CONFIG_LOGGER_SERVICE_MIN_LEVEL
+    #endif
+
+    // Calls above LOGGER_SERVICE_MIN_LEVEL are removed by the compiler, their arguments are not evaluated
+    #define LOGGER_SERVICE_LOG_LEVEL(level, tag, format, ... ) do { if((level) <= LOGGER_SERVICE_MIN_LEVEL) { logger_service_log_tagged(level, tag, format, ##__VA_ARGS__); } } while(0)
+
+    // The service adds the prefix, so it knows the tag to check the level of. Tags must never be
+    // freed, with deferred formatting (CONFIG_LOGGER_SERVICE_BINARY) only the format, tag and raw
+    // arguments are recorded.
+    #define LOG_E(tag, format, ... ) LOGGER_SERVICE_LOG_LEVEL(LOGGER_SERVICE_LOGLEVEL_ERROR,   tag, format, ##__VA_ARGS__)
+    #define LOG_W(tag, format, ... ) LOGGER_SERVICE_LOG_LEVEL(LOGGER_SERVICE_LOGLEVEL_WARN,    tag, format, ##__VA_ARGS__)
+    #define LOG_I(tag, format, ... ) LOGGER_SERVICE_LOG_LEVEL(LOGGER_SERVICE_LOGLEVEL_INFO,    tag, format, ##__VA_ARGS__)
+    #define LOG_D(tag, format, ... ) LOGGER_SERVICE_LOG_LEVEL(LOGGER_SERVICE_LOGLEVEL_DEBUG,   tag, format, ##__VA_ARGS__)
+    #define LOG_V(tag, format, ... ) LOGGER_SERVICE_LOG_LEVEL(LOGGER_SERVICE_LOGLEVEL_VERBOSE, tag, format, ##__VA_ARGS__)
+
+    // Structured messages, a fixed message followed by at least one field made with LOGGER_SERVICE_INT,
+    // LOGGER_SERVICE_STRING etc, e.g. LOG_KV_I(TAG, "connected", LOGGER_SERVICE_INT("rssi", rssi))
+    #define LOGGER_SERVICE_LOG_FIELDS(level, tag, message, ... ) do { if((level) <= LOGGER_SERVICE_MIN_LEVEL) { const logger_service_field_t loggerFields_[] = { __VA_ARGS__ }; logger_service_log_fields(level, tag, message, loggerFields_, sizeof(loggerFields_) / sizeof(loggerFields_[0])); } } while(0)
+
+    #define LOG_KV_E(tag, message, ... ) LOGGER_SERVICE_LOG_FIELDS(LOGGER_SERVICE_LOGLEVEL_ERROR,   tag, message, __VA_ARGS__)
+    #define LOG_KV_W(tag, message, ... ) LOGGER_SERVICE_LOG_FIELDS(LOGGER_SERVICE_LOGLEVEL_WARN,    tag, message, __VA_ARGS__)
+    #define LOG_KV_I(tag, message, ... ) LOGGER_SERVICE_LOG_FIELDS(LOGGER_SERVICE_LOGLEVEL_INFO,    tag, message, __VA_ARGS__)
+    #define LOG_KV_D(tag, message, ... ) LOGGER_SERVICE_LOG_FIELDS(LOGGER_SERVICE_LOGLEVEL_DEBUG,   tag, message, __VA_ARGS__)
+    #define LOG_KV_V(tag, message, ... ) LOGGER_SERVICE_LOG_FIELDS(LOGGER_SERVICE_LOGLEVEL_VERBOSE, tag, message, __VA_ARGS__)
 
 #else
 
@@ -23,6 +46,13 @@
     #define LOG_D(tag, format, ... ) ESP_LOGD(tag, format, ##__VA_ARGS__)
     #define LOG_V(tag, format, ... ) ESP_LOGV(tag, format, ##__VA_ARGS__)
 
+    // The ESP log utilities only print the message of structured messages
+    #define LOG_KV_E(tag, message, ... ) ESP_LOGE(tag, "%s", message)
+    #define LOG_KV_W(tag, message, ... ) ESP_LOGW(tag, "%s", message)
+    #define LOG_KV_I(tag, message, ... ) ESP_LOGI(tag, "%s", message)
+    #define LOG_KV_D(tag, message, ... ) ESP_LOGD(tag, "%s", message)
+    #define LOG_KV_V(tag, message, ... ) ESP_LOGV(tag, "%s", message)
+
 #endif // USE_LOGGER_SERVICE
 
 #endif // LOG_H
\ No newline at end of file
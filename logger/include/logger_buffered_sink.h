@@ -0,0 +1,39 @@
+#ifndef LOGGER_BUFFERED_SINK_H
+#define LOGGER_BUFFERED_SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger_service.h"
+
+// Sink that collects messages and writes them in larger chunks to a batch sink, e.g. to send one
+// network packet for many log lines. The buffer is written when the next message does not fit
+// anymore, when the first buffered message has waited for max_delay_ms and when it is flushed.
+// The batch sink is never called from the timer task: once max_delay_ms has passed the buffer is
+// written by the logging task when logging asynchronously, and by the timer work task or a log call
+// that comes first otherwise.
+//
+//   logger_buffered_sink_conf_t conf;
+//   logger_buffered_sink_conf_init(&conf, udp_batch_sink, socket);
+//   logger_buffered_sink_t buffered = logger_buffered_sink_new(&conf);
+//   sink_handle_t sink = logger_service_register_sink(logger_buffered_sink_write, buffered);
+
+typedef struct logger_buffered_sink_s* logger_buffered_sink_t;
+
+typedef struct logger_buffered_sink_conf_s
+{
+    logger_batch_sink_t callback;   // Receives the buffered messages
+    void* user_data;
+    size_t size;                    // Bytes that are buffered, larger messages are written directly
+    uint32_t max_delay_ms;          // 0 to only write when the buffer is full or flushed
+} logger_buffered_sink_conf_t;
+
+void                   logger_buffered_sink_conf_init(logger_buffered_sink_conf_t* conf, logger_batch_sink_t callback, void* user_data);
+logger_buffered_sink_t logger_buffered_sink_new(const logger_buffered_sink_conf_t* conf);
+void                   logger_buffered_sink_delete(logger_buffered_sink_t sink);   // Flushes, unregister the sink first
+void                   logger_buffered_sink_flush(logger_buffered_sink_t sink);
+
+// Register with logger_service_register_sink or logger_service_register_batch_sink, with the buffered sink as user data
+void                   logger_buffered_sink_write(const char* messages, const size_t len, void* user_data);
+
+#endif // LOGGER_BUFFERED_SINK_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef LOGGER_LIVE_SINK_H
+#define LOGGER_LIVE_SINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logger_service.h"
+
+// Sink that keeps the messages for a number of clients that read them at their own pace, e.g. the
+// websocket connections of a webserver. Every client has its own level and a bounded backlog, when
+// a client falls behind its oldest messages are dropped, so slow clients never stall logging. The
+// clients are expected to be read from a single task, e.g. the webserver thread.
+//
+//   logger_live_sink_conf_t conf;
+//   logger_live_sink_conf_init(&conf);
+//   logger_live_sink_t live = logger_live_sink_new(&conf);
+//   sink_handle_t sink = logger_service_register_sink(logger_live_sink_write, live);
+
+typedef struct logger_live_sink_s* logger_live_sink_t;
+typedef struct logger_live_client_s* logger_live_client_t;
+
+typedef struct logger_live_sink_conf_s
+{
+    size_t max_clients;
+    size_t backlog_size;                        // Bytes of messages kept per client, rounded up to a power of 2
+    logger_service_loglevel_t default_level;    // Level of new clients
+} logger_live_sink_conf_t;
+
+void                 logger_live_sink_conf_init(logger_live_sink_conf_t* conf);
+logger_live_sink_t   logger_live_sink_new(const logger_live_sink_conf_t* conf);
+void                 logger_live_sink_delete(logger_live_sink_t sink);   // Unregister the sink first
+
+// Register with logger_service_register_sink, with the live sink as user data
+void                 logger_live_sink_write(const char* message, const size_t len, void* user_data);
+
+// Clients are identified by a context, e.g. their connection. Returns NULL if there are max_clients already.
+logger_live_client_t logger_live_sink_add_client(logger_live_sink_t sink, void* context);
+logger_live_client_t logger_live_sink_find_client(logger_live_sink_t sink, void* context);
+void                 logger_live_sink_remove_client(logger_live_sink_t sink, logger_live_client_t client);
+void                 logger_live_sink_set_client_level(logger_live_sink_t sink, logger_live_client_t client, logger_service_loglevel_t level);
+
+// Copies the oldest message of the client into buffer and removes it, longer messages are truncated.
+// A note with the number of dropped messages comes first if messages were dropped. Returns false if
+// there are no messages.
+bool                 logger_live_sink_read(logger_live_sink_t sink, logger_live_client_t client, char* buffer, size_t size, size_t* len);
+
+#endif // LOGGER_LIVE_SINK_H
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef LOGGER_RING_H
+#define LOGGER_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Persistent log ring that keeps the log across resets, e.g. in a flash partition or in RTC RAM.
+//
+// The storage is used as a circle of sectors that are erased one at a time, so every sector is
+// erased equally often. Every sector starts with a header that holds a sequence number, one more
+// than that of the previous sector, which lets opening the ring find the newest sector with a
+// binary search. Records have a sequence number and a CRC, so a record that was only partly
+// written when the device reset is recognized and skipped.
+//
+// Appending writes to the storage directly, so register the ring as a batch sink or behind a
+// buffered sink to write many messages at once:
+//
+//   logger_ring_storage_t storage;
+//   logger_ring_storage_partition(&storage, "log");
+//   logger_ring_t ring = logger_ring_open(&storage);
+//   sink_handle_t sink = logger_service_register_batch_sink(logger_ring_write, ring);
+
+typedef struct logger_ring_storage_s
+{
+    size_t sector_size;
+    size_t sector_count;
+    void* context;
+    bool (*read)(void* context, size_t offset, void* data, size_t len);
+    bool (*write)(void* context, size_t offset, const void* data, size_t len);  // Only writes erased bytes
+    bool (*erase)(void* context, size_t offset, size_t len);                    // Sets whole sectors to 0xFF
+    void (*close)(void* context);                                               // Optional
+} logger_ring_storage_t;
+
+typedef struct logger_ring_s* logger_ring_t;
+
+// Position of a reader in the ring
+typedef struct logger_ring_cursor_s
+{
+    size_t sector;
+    size_t offset;
+    uint32_t sector_seq;
+    uint32_t seq;           // Sequence number of the next record
+} logger_ring_cursor_t;
+
+// Storage in memory, e.g. an RTC_NOINIT_ATTR buffer that keeps its contents across resets
+void        logger_ring_storage_memory(logger_ring_storage_t* storage, void* memory, size_t sector_size, size_t sector_count);
+
+// Storage in a file, which is created if it does not exist
+bool        logger_ring_storage_file(logger_ring_storage_t* storage, const char* path, size_t sector_size, size_t sector_count);
+
+#ifdef ESP_PLATFORM
+// Storage in the data partition with the given label
+bool        logger_ring_storage_partition(logger_ring_storage_t* storage, const char* label);
+#endif
+
+// Finds the end of the log in the storage. Returns NULL if the storage has less than two sectors
+// or sectors that are not a multiple of 4 bytes.
+logger_ring_t logger_ring_open(const logger_ring_storage_t* storage);
+void        logger_ring_close(logger_ring_t ring);   // Unregister the sink first
+void        logger_ring_clear(logger_ring_t ring);
+
+bool        logger_ring_append(logger_ring_t ring, const char* data, size_t len);
+
+// Register with logger_service_register_batch_sink or as the callback of a buffered sink, with the ring as user data
+void        logger_ring_write(const char* messages, const size_t len, void* user_data);
+
+// Sequence number the next record gets
+uint32_t    logger_ring_next_seq(logger_ring_t ring);
+
+// Reading starts at the oldest record. Returns false once the reader has read all records, more
+// records can be read after they have been appended. A reader that falls behind so far that its
+// records are overwritten continues at the oldest record, which the sequence numbers reveal.
+// Records longer than size are truncated.
+void        logger_ring_cursor_init(logger_ring_t ring, logger_ring_cursor_t* cursor);
+bool        logger_ring_read(logger_ring_t ring, logger_ring_cursor_t* cursor, char* buffer, size_t size, size_t* len);
+
+#endif // LOGGER_RING_H
\ No newline at end of file
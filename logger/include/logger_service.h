@@ -1,9 +1,11 @@
 #ifndef LOGGER_SERVICE_H
 #define LOGGER_SERVICE_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdarg.h>
+#include <time.h>
 
 #define LOGGER_SERVICE_COLOR_BLACK     "30"
 #define LOGGER_SERVICE_COLOR_RED       "31"
@@ -23,6 +25,8 @@
 #define LOGGER_SERVICE_COLOR_D         LOGGER_SERVICE_COLOR(LOGGER_SERVICE_COLOR_WHITE)
 #define LOGGER_SERVICE_COLOR_V         LOGGER_SERVICE_FAINT(LOGGER_SERVICE_COLOR_WHITE)
 
+// Prefix of the LOG_X macros for logger_service_log, the timestamp and tag are the first arguments. The
+// LOG_X macros and logger_service_log_tagged format the timestamp of every message themselves.
 #define LOGGER_SERVICE_FORMAT(letter, format)  LOGGER_SERVICE_COLOR_ ## letter #letter " (%s) %s: " format LOGGER_SERVICE_RESET_COLOR "\n"
 
 typedef enum logger_service_loglevel_e
@@ -35,16 +39,190 @@ typedef enum logger_service_loglevel_e
     LOGGER_SERVICE_LOGLEVEL_VERBOSE = 5
 } logger_service_loglevel_t; 
 
+typedef enum logger_service_overflow_policy_e
+{
+    LOGGER_SERVICE_OVERFLOW_DROP_NEWEST = 0,    // Discard the new message
+    LOGGER_SERVICE_OVERFLOW_DROP_OLDEST = 1,    // Discard the oldest queued message
+    LOGGER_SERVICE_OVERFLOW_BLOCK       = 2     // Wait until the queue has room
+} logger_service_overflow_policy_t;
+
+// Encoding of the messages a sink receives
+typedef enum logger_service_encoding_e
+{
+    LOGGER_SERVICE_ENCODING_TEXT = 0,       // Colored lines as printed by the LOG_X macros
+    LOGGER_SERVICE_ENCODING_JSON = 1,       // JSON Lines, an object per message
+    LOGGER_SERVICE_ENCODING_CBOR = 2        // A CBOR map per message, concatenated into a CBOR sequence
+} logger_service_encoding_t;
+
+#define LOGGER_SERVICE_ENCODINGS 3
+
+typedef enum logger_service_field_type_e
+{
+    LOGGER_SERVICE_FIELD_INT    = 0,
+    LOGGER_SERVICE_FIELD_UINT   = 1,
+    LOGGER_SERVICE_FIELD_DOUBLE = 2,
+    LOGGER_SERVICE_FIELD_BOOL   = 3,
+    LOGGER_SERVICE_FIELD_STRING = 4
+} logger_service_field_type_t;
+
+// Typed key value field of a structured message, keys and strings are not copied when logging
+// synchronously
+typedef struct logger_service_field_s
+{
+    const char* key;
+    logger_service_field_type_t type;
+    union
+    {
+        int64_t     i;
+        uint64_t    u;
+        double      d;
+        bool        b;
+        const char* s;
+    } value;
+} logger_service_field_t;
+
+#define LOGGER_SERVICE_INT(key, value)     ((logger_service_field_t){ (key), LOGGER_SERVICE_FIELD_INT,    { .i = (value) } })
+#define LOGGER_SERVICE_UINT(key, value)    ((logger_service_field_t){ (key), LOGGER_SERVICE_FIELD_UINT,   { .u = (value) } })
+#define LOGGER_SERVICE_DOUBLE(key, value)  ((logger_service_field_t){ (key), LOGGER_SERVICE_FIELD_DOUBLE, { .d = (value) } })
+#define LOGGER_SERVICE_BOOL(key, value)    ((logger_service_field_t){ (key), LOGGER_SERVICE_FIELD_BOOL,   { .b = (value) } })
+#define LOGGER_SERVICE_STRING(key, value)  ((logger_service_field_t){ (key), LOGGER_SERVICE_FIELD_STRING, { .s = (value) } })
+
+typedef struct logger_service_stats_s
+{
+    uint32_t queued;        // Messages queued for asynchronous delivery
+    uint32_t dropped;       // New messages discarded because no queue slot or format buffer was free
+    uint32_t overwritten;   // Queued messages discarded to make room for new messages
+    uint32_t suppressed;    // Messages discarded by the rate limit of their call site
+} logger_service_stats_t;
+
+// Log2 histogram of the time spent in a sink callback. Bucket 0 counts the calls that took less than
+// a microsecond, bucket i those that took from 2^(i-1) up to 2^i microseconds, and the last bucket
+// all slower calls too.
+#define LOGGER_SERVICE_LATENCY_BUCKETS 16
+
+typedef struct logger_service_metrics_s
+{
+    logger_service_stats_t stats;
+    uint32_t messages[LOGGER_SERVICE_LOGLEVEL_VERBOSE + 1];   // Messages logged per level
+    uint64_t bytes;                                             // Bytes delivered to sinks, counted for every sink
+} logger_service_metrics_t;
+
+typedef struct logger_service_sink_metrics_s
+{
+    struct sink_s* sink;
+    const char* name;       // NULL if no name was set
+    logger_service_encoding_t encoding;
+    uint32_t calls;         // Of the callback, a call of a batch sink can deliver many messages
+    uint64_t bytes;
+    uint64_t time_us;       // Total time spent in the callback
+    uint32_t max_us;
+    uint32_t latency[LOGGER_SERVICE_LATENCY_BUCKETS];
+} logger_service_sink_metrics_t;
+
+typedef struct logger_service_tag_metrics_s
+{
+    const char* tag;
+    uint32_t messages;      // Messages logged with the tag
+} logger_service_tag_metrics_t;
+
+// Message of which formatting is deferred (CONFIG_LOGGER_SERVICE_BINARY). The format and tag are
+// stored as pointers, the arguments are stored raw in the order of the format string, each with
+// the size of its promoted C type and unaligned, strings inline including their terminator.
+typedef struct logger_service_record_s
+{
+    const char* format;
+    const char* tag;        // NULL if the format string already contains the prefix
+    int64_t     time;       // time() of the log call
+    uint32_t    clock;      // clock() of the log call, 0 if the time was set
+    uint16_t    args_len;
+    uint8_t     level;
+    uint8_t     structured; // format is the message and args holds its fields as CBOR key value pairs
+    uint8_t     args[];
+} logger_service_record_t;
+
+// Source of the time of messages and of the sink latencies, the system clock by default. Tests and
+// benchmarks can set a clock of their own, e.g. to get the same timestamps every run. Functions that
+// are NULL read the system clock.
+typedef struct logger_service_clock_s
+{
+    time_t  (*time)(void* user_data);           // Seconds since the epoch, like time()
+    clock_t (*ticks)(void* user_data);          // Processor time like clock(), only read while the time is not set
+    int64_t (*monotonic_us)(void* user_data);   // Microseconds since any start
+    void*   user_data;
+} logger_service_clock_t;
+
 typedef struct sink_s* sink_handle_t;
 typedef void (*logger_sink_t)(const char* message, const size_t len, void* user_data);
+typedef void (*logger_binary_sink_t)(const logger_service_record_t* record, const size_t len, void* user_data);
 
-extern char logger_service_timestamp[20];
+// Receives messages concatenated as they would have been written one by one, the messages that were
+// queued at the same time when logging asynchronously and single messages otherwise
+typedef void (*logger_batch_sink_t)(const char* messages, const size_t len, void* user_data);
 
 void        logger_service_init(void);
 int         logger_service_log(logger_service_loglevel_t level, const char* format, ...);
 int         logger_service_vlog(logger_service_loglevel_t level, const char* format, va_list vlist);
 
+// Logs with the prefix of the LOG_X macros added by the service, formatting is deferred to the
+// logging task when CONFIG_LOGGER_SERVICE_BINARY is set (returns 0 then)
+int         logger_service_log_tagged(logger_service_loglevel_t level, const char* tag, const char* format, ...);
+int         logger_service_vlog_tagged(logger_service_loglevel_t level, const char* tag, const char* format, va_list vlist);
+
+// Logs a message with typed fields, e.g. for a log collector. Text sinks receive the fields after
+// the message as key=value, JSON and CBOR sinks as members of the message object.
+int         logger_service_log_fields(logger_service_loglevel_t level, const char* tag, const char* message, const logger_service_field_t* fields, size_t count);
+
+// Formats a deferred message like logger_service_vlog would have, returns the untruncated length
+int         logger_service_format_record(const logger_service_record_t* record, char* buffer, size_t size);
+
+// Encodes a deferred message like it is encoded for sinks with the encoding. Returns the length,
+// which is at least size if the message did not fit.
+int         logger_service_encode_record(const logger_service_record_t* record, logger_service_encoding_t encoding, char* buffer, size_t size);
+
+// Level of a message formatted by the service from its prefix, LOGGER_SERVICE_LOGLEVEL_NONE for messages
+// logged without a tag
+logger_service_loglevel_t logger_service_message_level(const char* message, size_t len);
+
+// Runtime log levels per tag name, tag "*" sets the level of tags without a level of their own.
+// Levels start at CONFIG_LOG_DEFAULT_LEVEL. Returns false if the tag table is full.
+bool                      logger_service_set_level(const char* tag, logger_service_loglevel_t level);
+logger_service_loglevel_t logger_service_get_level(const char* tag);
+
+// Rate limit per call site of the messages logged with a tag, a call site being the format string or
+// message of the LOG_X or LOG_KV_X call. A call site can log burst messages at once and rate messages
+// per second after that. The messages above the limit are discarded and reported once a second as
+// "last message repeated N times". A rate of 0 disables rate limiting. The limit starts at
+// CONFIG_LOGGER_SERVICE_RATE_LIMIT and CONFIG_LOGGER_SERVICE_RATE_LIMIT_BURST.
+void        logger_service_set_rate_limit(uint32_t rate, uint32_t burst);
+
+// The clock is not copied, it must stay valid until another clock is set. NULL restores the system clock.
+void        logger_service_set_clock(const logger_service_clock_t* clock);
+
+void        logger_service_get_stats(logger_service_stats_t* stats);
+
+// Counters and sink latencies (CONFIG_LOGGER_SERVICE_METRICS), these are all zero without. Sinks and
+// tags are numbered from 0, the functions return false after the last one. Sinks that are added or
+// removed while iterating may be skipped or seen twice.
+void        logger_service_get_metrics(logger_service_metrics_t* metrics);
+bool        logger_service_get_sink_metrics(size_t index, logger_service_sink_metrics_t* metrics);
+bool        logger_service_get_tag_metrics(size_t index, logger_service_tag_metrics_t* metrics);
+
+// Writes all metrics as a JSON object, returns the untruncated length like snprintf
+int         logger_service_metrics_json(char* buffer, size_t size);
+
+// Asynchronous logging (CONFIG_LOGGER_SERVICE_ASYNC), these do nothing when logging synchronously
+void        logger_service_set_overflow_policy(logger_service_overflow_policy_t policy);
+void        logger_service_flush(void);
+
 sink_handle_t logger_service_register_sink(logger_sink_t callback, void* user_data);
-void          logger_service_unregister_sink(sink_handle_t handle);
+sink_handle_t logger_service_register_binary_sink(logger_binary_sink_t callback, void* user_data); // Only receives deferred messages
+sink_handle_t logger_service_register_batch_sink(logger_batch_sink_t callback, void* user_data);
+
+// Sinks that receive their messages as JSON or CBOR instead of text. Messages that do not fit in
+// CONFIG_LOGGER_SERVICE_MESSAGE_SIZE are truncated as text, but dropped as JSON or CBOR.
+sink_handle_t logger_service_register_encoded_sink(logger_service_encoding_t encoding, logger_sink_t callback, void* user_data);
+sink_handle_t logger_service_register_encoded_batch_sink(logger_service_encoding_t encoding, logger_batch_sink_t callback, void* user_data);
+void          logger_service_set_sink_name(sink_handle_t handle, const char* name);   // Shown in the metrics, the name is not copied
+void          logger_service_unregister_sink(sink_handle_t handle);   // Waits until no log call uses the sink, must not be called from a sink
 
 #endif // LOGGER_SERVICE_H
\ No newline at end of file
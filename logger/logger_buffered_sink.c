@@ -0,0 +1,178 @@
+#include "logger_buffered_sink.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger_port.h"
+#include "logger_work.h"
+
+#define DEFAULT_SIZE 1024
+#define DEFAULT_MAX_DELAY_MS 100
+
+struct logger_buffered_sink_s
+{
+    logger_batch_sink_t callback;
+    void* user_data;
+    uint32_t max_delay_ms;
+    logger_port_mutex_t lock;       // Sinks are called by every task that logs when logging synchronously
+    logger_port_timer_t timer;      // NULL without a maximum delay
+    atomic_bool timer_pending;
+    atomic_bool flush_due;          // The timer expired, the next writer or the posted work flushes
+    logger_work_t flush_work;
+    size_t size;
+    size_t len;
+    char buffer[];
+};
+
+// Must be called with the lock held
+static void flush_locked(logger_buffered_sink_t sink)
+{
+    if(sink->len > 0)
+    {
+        sink->callback(sink->buffer, sink->len, sink->user_data);
+        sink->len = 0;
+    }
+}
+
+static void flush_if_due(void* arg)
+{
+    logger_buffered_sink_t sink = (logger_buffered_sink_t)arg;
+
+    logger_port_mutex_lock(sink->lock);
+    if(atomic_exchange(&sink->flush_due, false))
+    {
+        flush_locked(sink);
+    }
+    logger_port_mutex_unlock(sink->lock);
+}
+
+// Runs on the timer task, which must not wait for the lock while the batch sink writes
+static void timer_expired(void* arg)
+{
+    logger_buffered_sink_t sink = (logger_buffered_sink_t)arg;
+
+    atomic_store(&sink->flush_due, true);
+    atomic_store(&sink->timer_pending, false);
+    logger_work_post(&sink->flush_work);
+}
+
+static void start_timer(logger_buffered_sink_t sink)
+{
+    if(!atomic_exchange(&sink->timer_pending, true) && !logger_port_timer_start(sink->timer, sink->max_delay_ms))
+    {
+        // The next message that is buffered tries again
+        atomic_store(&sink->timer_pending, false);
+    }
+}
+
+void logger_buffered_sink_conf_init(logger_buffered_sink_conf_t* conf, logger_batch_sink_t callback, void* user_data)
+{
+    conf->callback = callback;
+    conf->user_data = user_data;
+    conf->size = DEFAULT_SIZE;
+    conf->max_delay_ms = DEFAULT_MAX_DELAY_MS;
+}
+
+logger_buffered_sink_t logger_buffered_sink_new(const logger_buffered_sink_conf_t* conf)
+{
+    if(conf->callback == NULL || conf->size == 0)
+    {
+        return NULL;
+    }
+
+    logger_buffered_sink_t sink = (logger_buffered_sink_t)malloc(sizeof(*sink) + conf->size);
+
+    if(sink == NULL)
+    {
+        return NULL;
+    }
+
+    sink->callback = conf->callback;
+    sink->user_data = conf->user_data;
+    sink->max_delay_ms = conf->max_delay_ms;
+    sink->timer = NULL;
+    atomic_init(&sink->timer_pending, false);
+    atomic_init(&sink->flush_due, false);
+    sink->size = conf->size;
+    sink->len = 0;
+
+    if(!logger_port_mutex_create(&sink->lock))
+    {
+        free(sink);
+        return NULL;
+    }
+
+    if(conf->max_delay_ms > 0 && !logger_port_timer_create(timer_expired, sink, &sink->timer))
+    {
+        logger_port_mutex_delete(sink->lock);
+        free(sink);
+        return NULL;
+    }
+
+    logger_work_add(&sink->flush_work, flush_if_due, sink);
+
+    return sink;
+}
+
+void logger_buffered_sink_delete(logger_buffered_sink_t sink)
+{
+    if(sink == NULL)
+    {
+        return;
+    }
+
+    if(sink->timer != NULL)
+    {
+        logger_port_timer_delete(sink->timer);
+    }
+    logger_work_remove(&sink->flush_work);
+
+    logger_buffered_sink_flush(sink);
+
+    logger_port_mutex_delete(sink->lock);
+    free(sink);
+}
+
+void logger_buffered_sink_flush(logger_buffered_sink_t sink)
+{
+    logger_port_mutex_lock(sink->lock);
+    flush_locked(sink);
+    logger_port_mutex_unlock(sink->lock);
+}
+
+void logger_buffered_sink_write(const char* messages, const size_t len, void* user_data)
+{
+    logger_buffered_sink_t sink = (logger_buffered_sink_t)user_data;
+    bool startTimer = false;
+
+    logger_port_mutex_lock(sink->lock);
+
+    if(atomic_exchange(&sink->flush_due, false) || len > sink->size - sink->len)
+    {
+        flush_locked(sink);
+    }
+
+    if(len > sink->size)
+    {
+        // Does not fit in the buffer at all
+        sink->callback(messages, len, sink->user_data);
+    }
+    else if(len > 0)
+    {
+        // The first message determines when the buffer is written, a timer that is still pending
+        // for messages that were written already expires earlier, which is fine
+        startTimer = sink->len == 0 && sink->timer != NULL;
+
+        memcpy(sink->buffer + sink->len, messages, len);
+        sink->len += len;
+    }
+
+    logger_port_mutex_unlock(sink->lock);
+
+    if(startTimer)
+    {
+        start_timer(sink);
+    }
+}
\ No newline at end of file
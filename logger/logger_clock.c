@@ -0,0 +1,35 @@
+#include "logger_clock.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "logger_service.h"
+#include "logger_port.h"
+
+static _Atomic(const logger_service_clock_t*) source = NULL;
+
+time_t logger_clock_time(void)
+{
+    const logger_service_clock_t* custom = atomic_load_explicit(&source, memory_order_acquire);
+
+    return custom != NULL && custom->time != NULL ? custom->time(custom->user_data) : time(NULL);
+}
+
+clock_t logger_clock_ticks(void)
+{
+    const logger_service_clock_t* custom = atomic_load_explicit(&source, memory_order_acquire);
+
+    return custom != NULL && custom->ticks != NULL ? custom->ticks(custom->user_data) : clock();
+}
+
+int64_t logger_clock_us(void)
+{
+    const logger_service_clock_t* custom = atomic_load_explicit(&source, memory_order_acquire);
+
+    return custom != NULL && custom->monotonic_us != NULL ? custom->monotonic_us(custom->user_data) : logger_port_time_us();
+}
+
+void logger_service_set_clock(const logger_service_clock_t* clock)
+{
+    atomic_store_explicit(&source, clock, memory_order_release);
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef LOGGER_CLOCK_H
+#define LOGGER_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Clock of the logger service, see logger_service_set_clock. Without a clock
+// of its own these only add a load and a branch to the system clock.
+
+time_t  logger_clock_time(void);
+clock_t logger_clock_ticks(void);
+int64_t logger_clock_us(void);
+
+#endif // LOGGER_CLOCK_H
\ No newline at end of file
@@ -0,0 +1,756 @@
+#include "logger_encode.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "logger_format.h"
+#include "logger_timestamp.h"
+
+// Prefix and suffix the LOG_X macros add to messages, by level
+static const char* const levelPrefixes[] = {
+    "",
+    LOGGER_SERVICE_COLOR_E "E",
+    LOGGER_SERVICE_COLOR_W "W",
+    LOGGER_SERVICE_COLOR_I "I",
+    LOGGER_SERVICE_COLOR_D "D",
+    LOGGER_SERVICE_COLOR_V "V"
+};
+
+static const char levelSuffix[] = LOGGER_SERVICE_RESET_COLOR "\n";
+static const char levelLetters[] = "NEWIDV";
+
+// Writes up to the end of the buffer, the length keeps counting past it like snprintf
+typedef struct output_s
+{
+    char* buffer;
+    size_t size;
+    size_t len;
+} output_t;
+
+// Field of a message, whether it was passed as an array or captured as CBOR
+typedef struct field_view_s
+{
+    const char* key;
+    size_t key_len;
+    logger_service_field_type_t type;
+    int64_t i;
+    uint64_t u;
+    double d;
+    bool b;
+    const char* s;
+    size_t s_len;
+} field_view_t;
+
+typedef struct field_iter_s
+{
+    const logger_encode_message_t* message;
+    size_t index;
+    const uint8_t* cbor;
+    const uint8_t* end;
+} field_iter_t;
+
+static size_t room(const output_t* out)
+{
+    return out->len < out->size ? out->size - out->len : 0;
+}
+
+static char* cursor(output_t* out)
+{
+    return out->len < out->size ? out->buffer + out->len : NULL;
+}
+
+static void put(output_t* out, const void* data, size_t len)
+{
+    size_t n = room(out);
+
+    if(n > 0)
+    {
+        memcpy(out->buffer + out->len, data, len < n ? len : n);
+    }
+
+    out->len += len;
+}
+
+static void put_char(output_t* out, char c)
+{
+    if(out->len < out->size)
+    {
+        out->buffer[out->len] = c;
+    }
+
+    out->len++;
+}
+
+static void put_str(output_t* out, const char* s)
+{
+    put(out, s, strlen(s));
+}
+
+static void put_printf(output_t* out, const char* format, ...)
+{
+    va_list list;
+    va_start(list, format);
+    int n = vsnprintf(cursor(out), room(out), format, list);
+    va_end(list);
+
+    out->len += n > 0 ? (size_t)n : 0;
+}
+
+// Writes the text of the message, formatted in place for printf style messages
+static void put_body(output_t* out, const logger_encode_message_t* message)
+{
+    int n;
+
+    switch(message->source)
+    {
+        case LOGGER_ENCODE_VLIST:
+        {
+            va_list copy;
+            va_copy(copy, *message->vlist);
+            n = vsnprintf(cursor(out), room(out), message->format, copy);
+            va_end(copy);
+            break;
+        }
+
+        case LOGGER_ENCODE_ARGS:
+            n = logger_format_render(cursor(out), room(out), message->format, message->args, message->args_len);
+            break;
+
+        default:
+            put_str(out, message->format);
+            return;
+    }
+
+    out->len += n > 0 ? (size_t)n : 0;
+}
+
+// Removes the color escapes and line end of messages formatted with LOGGER_SERVICE_FORMAT, in place
+static size_t strip_text(char* text, size_t len)
+{
+    size_t j = len;
+
+    if(memchr(text, '\033', len) != NULL)
+    {
+        j = 0;
+        for(size_t i = 0; i < len; i++)
+        {
+            if(text[i] == '\033' && i + 1 < len && text[i + 1] == '[')
+            {
+                // Skip up to the final byte of the sequence
+                for(i += 2; i < len && (text[i] < 0x40 || text[i] > 0x7E); i++)
+                {
+                }
+                continue;
+            }
+
+            text[j++] = text[i];
+        }
+    }
+
+    while(j > 0 && text[j - 1] == '\n')
+    {
+        j--;
+    }
+
+    return j;
+}
+
+static uint64_t cbor_read_uint(const uint8_t** p, size_t n)
+{
+    uint64_t value = 0;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        value = (value << 8) | *(*p)++;
+    }
+
+    return value;
+}
+
+// Reads the initial byte of a CBOR item and the value that follows it
+static bool cbor_read_head(const uint8_t** p, const uint8_t* end, uint8_t* initial, uint64_t* value)
+{
+    static const uint8_t lengths[] = { 1, 2, 4, 8 };
+
+    if(*p >= end)
+    {
+        return false;
+    }
+
+    *initial = *(*p)++;
+
+    uint8_t info = *initial & 0x1F;
+    if(info < 24)
+    {
+        *value = info;
+        return true;
+    }
+
+    if(info > 27 || (size_t)(end - *p) < lengths[info - 24])
+    {
+        return false;
+    }
+
+    *value = cbor_read_uint(p, lengths[info - 24]);
+    return true;
+}
+
+static void field_view(const logger_service_field_t* field, field_view_t* view)
+{
+    view->key = field->key;
+    view->key_len = strlen(field->key);
+    view->type = field->type;
+
+    switch(field->type)
+    {
+        case LOGGER_SERVICE_FIELD_INT:      view->i = field->value.i; break;
+        case LOGGER_SERVICE_FIELD_UINT:     view->u = field->value.u; break;
+        case LOGGER_SERVICE_FIELD_DOUBLE:   view->d = field->value.d; break;
+        case LOGGER_SERVICE_FIELD_BOOL:     view->b = field->value.b; break;
+        default:
+            view->type = LOGGER_SERVICE_FIELD_STRING;
+            view->s = field->value.s != NULL ? field->value.s : "(null)";
+            view->s_len = strlen(view->s);
+            break;
+    }
+}
+
+static void field_iter_init(field_iter_t* it, const logger_encode_message_t* message)
+{
+    it->message = message;
+    it->index = 0;
+    it->cbor = message->args;
+    it->end = message->args + message->args_len;
+}
+
+static bool next_field(field_iter_t* it, field_view_t* field)
+{
+    const logger_encode_message_t* message = it->message;
+
+    if(message->source == LOGGER_ENCODE_FIELDS)
+    {
+        if(it->index >= message->field_count)
+        {
+            return false;
+        }
+
+        field_view(&message->fields[it->index++], field);
+        return true;
+    }
+
+    if(message->source != LOGGER_ENCODE_CBOR_FIELDS)
+    {
+        return false;
+    }
+
+    const uint8_t* p = it->cbor;
+    uint8_t initial;
+    uint64_t value;
+
+    // Text key
+    if(!cbor_read_head(&p, it->end, &initial, &value) || (initial >> 5) != 3 || value > (uint64_t)(it->end - p))
+    {
+        return false;
+    }
+
+    field->key = (const char*)p;
+    field->key_len = (size_t)value;
+    p += value;
+
+    if(!cbor_read_head(&p, it->end, &initial, &value))
+    {
+        return false;
+    }
+
+    switch(initial >> 5)
+    {
+        case 0:
+            field->type = LOGGER_SERVICE_FIELD_UINT;
+            field->u = value;
+            break;
+
+        case 1:
+            field->type = LOGGER_SERVICE_FIELD_INT;
+            field->i = -1 - (int64_t)value;
+            break;
+
+        case 3:
+            if(value > (uint64_t)(it->end - p))
+            {
+                return false;
+            }
+            field->type = LOGGER_SERVICE_FIELD_STRING;
+            field->s = (const char*)p;
+            field->s_len = (size_t)value;
+            p += value;
+            break;
+
+        case 7:
+            if(initial == 0xF4 || initial == 0xF5)
+            {
+                field->type = LOGGER_SERVICE_FIELD_BOOL;
+                field->b = initial == 0xF5;
+                break;
+            }
+            if(initial == 0xFB)
+            {
+                field->type = LOGGER_SERVICE_FIELD_DOUBLE;
+                memcpy(&field->d, &value, sizeof(field->d));
+                break;
+            }
+            return false;
+
+        default:
+            return false;
+    }
+
+    it->cbor = p;
+    return true;
+}
+
+static size_t count_fields(const logger_encode_message_t* message)
+{
+    field_iter_t it;
+    field_view_t field;
+    size_t count = 0;
+
+    field_iter_init(&it, message);
+    while(next_field(&it, &field))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/*
+ * Text
+ */
+static void put_text_value(output_t* out, const field_view_t* field)
+{
+    switch(field->type)
+    {
+        case LOGGER_SERVICE_FIELD_INT:      put_printf(out, "%" PRId64, field->i); break;
+        case LOGGER_SERVICE_FIELD_UINT:     put_printf(out, "%" PRIu64, field->u); break;
+        case LOGGER_SERVICE_FIELD_DOUBLE:   put_printf(out, "%.15g", field->d); break;
+        case LOGGER_SERVICE_FIELD_BOOL:     put_str(out, field->b ? "true" : "false"); break;
+        default:                            put(out, field->s, field->s_len); break;
+    }
+}
+
+static void encode_text(output_t* out, const logger_encode_message_t* message)
+{
+    if(message->tag != NULL)
+    {
+        char timestamp[LOGGER_TIMESTAMP_SIZE];
+        logger_timestamp_format(message->time, message->clock, timestamp);
+
+        put_printf(out, "%s (%s) %s: ", levelPrefixes[message->level], timestamp, message->tag);
+    }
+
+    put_body(out, message);
+
+    field_iter_t it;
+    field_view_t field;
+
+    field_iter_init(&it, message);
+    while(next_field(&it, &field))
+    {
+        put_char(out, ' ');
+        put(out, field.key, field.key_len);
+        put_char(out, '=');
+        put_text_value(out, &field);
+    }
+
+    if(message->tag != NULL)
+    {
+        put(out, levelSuffix, sizeof(levelSuffix) - 1);
+    }
+    else if(message->source == LOGGER_ENCODE_FIELDS || message->source == LOGGER_ENCODE_CBOR_FIELDS)
+    {
+        // Printf style messages without a tag bring their own line end
+        put_char(out, '\n');
+    }
+}
+
+/*
+ * JSON Lines
+ */
+static size_t json_escaped_len(unsigned char c)
+{
+    switch(c)
+    {
+        case '"': case '\\': case '\b': case '\f': case '\n': case '\r': case '\t':
+            return 2;
+        default:
+            return c < 0x20 ? 6 : 1;
+    }
+}
+
+static void json_escape(char* dst, unsigned char c)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    dst[0] = '\\';
+    switch(c)
+    {
+        case '"':   dst[1] = '"'; break;
+        case '\\':  dst[1] = '\\'; break;
+        case '\b':  dst[1] = 'b'; break;
+        case '\f':  dst[1] = 'f'; break;
+        case '\n':  dst[1] = 'n'; break;
+        case '\r':  dst[1] = 'r'; break;
+        case '\t':  dst[1] = 't'; break;
+        default:
+            memcpy(dst + 1, "u00", 3);
+            dst[4] = hex[c >> 4];
+            dst[5] = hex[c & 0x0F];
+            break;
+    }
+}
+
+static void put_json_string(output_t* out, const char* s, size_t len)
+{
+    put_char(out, '"');
+
+    for(size_t i = 0; i < len; i++)
+    {
+        unsigned char c = (unsigned char)s[i];
+        size_t n = json_escaped_len(c);
+
+        if(n == 1)
+        {
+            put_char(out, (char)c);
+        }
+        else
+        {
+            char escaped[6];
+            json_escape(escaped, c);
+            put(out, escaped, n);
+        }
+    }
+
+    put_char(out, '"');
+}
+
+static void put_json_value(output_t* out, const field_view_t* field)
+{
+    switch(field->type)
+    {
+        case LOGGER_SERVICE_FIELD_INT:      put_printf(out, "%" PRId64, field->i); break;
+        case LOGGER_SERVICE_FIELD_UINT:     put_printf(out, "%" PRIu64, field->u); break;
+        case LOGGER_SERVICE_FIELD_BOOL:     put_str(out, field->b ? "true" : "false"); break;
+        case LOGGER_SERVICE_FIELD_STRING:   put_json_string(out, field->s, field->s_len); break;
+        default:
+            // JSON has no infinity or NaN
+            if(isfinite(field->d))
+            {
+                put_printf(out, "%.15g", field->d);
+            }
+            else
+            {
+                put_str(out, "null");
+            }
+            break;
+    }
+}
+
+static void put_json_body(output_t* out, const logger_encode_message_t* message)
+{
+    size_t start = out->len;
+
+    put_body(out, message);
+
+    if(out->len >= out->size)
+    {
+        // Does not fit, which fails the whole message
+        return;
+    }
+
+    char* text = out->buffer + start;
+    size_t len = strip_text(text, out->len - start);
+    size_t extra = 0;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        extra += json_escaped_len((unsigned char)text[i]) - 1;
+    }
+
+    out->len = start + len + extra;
+
+    if(extra == 0 || out->len >= out->size)
+    {
+        return;
+    }
+
+    // Escaped from the end, so every character is moved before it is overwritten
+    char* dst = text + len + extra;
+    for(size_t i = len; i-- > 0;)
+    {
+        unsigned char c = (unsigned char)text[i];
+        size_t n = json_escaped_len(c);
+
+        dst -= n;
+        if(n == 1)
+        {
+            *dst = (char)c;
+        }
+        else
+        {
+            json_escape(dst, c);
+        }
+    }
+}
+
+static void encode_json(output_t* out, const logger_encode_message_t* message)
+{
+    if(logger_timestamp_time_is_set(message->time))
+    {
+        put_printf(out, "{\"ts\":%lld", (long long)message->time);
+    }
+    else
+    {
+        put_printf(out, "{\"clk\":%lu", (unsigned long)message->clock);
+    }
+
+    put_printf(out, ",\"lvl\":\"%c\"", levelLetters[message->level]);
+
+    if(message->tag != NULL)
+    {
+        put_str(out, ",\"tag\":");
+        put_json_string(out, message->tag, strlen(message->tag));
+    }
+
+    put_str(out, ",\"msg\":\"");
+    put_json_body(out, message);
+    put_char(out, '"');
+
+    field_iter_t it;
+    field_view_t field;
+
+    field_iter_init(&it, message);
+    while(next_field(&it, &field))
+    {
+        put_char(out, ',');
+        put_json_string(out, field.key, field.key_len);
+        put_char(out, ':');
+        put_json_value(out, &field);
+    }
+
+    put_str(out, "}\n");
+}
+
+/*
+ * CBOR
+ */
+static void put_cbor_head(output_t* out, uint8_t major, uint64_t value)
+{
+    uint8_t head[9];
+    size_t n;
+
+    if(value < 24)
+    {
+        head[0] = (uint8_t)(major << 5 | value);
+        n = 1;
+    }
+    else
+    {
+        // 1, 2, 4 or 8 bytes big endian
+        uint8_t info = value <= 0xFF ? 24 : value <= 0xFFFF ? 25 : value <= 0xFFFFFFFF ? 26 : 27;
+        n = (size_t)1 << (info - 24);
+
+        head[0] = (uint8_t)(major << 5 | info);
+        for(size_t i = 0; i < n; i++)
+        {
+            head[n - i] = (uint8_t)(value >> (8 * i));
+        }
+        n++;
+    }
+
+    put(out, head, n);
+}
+
+static void put_cbor_text(output_t* out, const char* s, size_t len)
+{
+    put_cbor_head(out, 3, len);
+    put(out, s, len);
+}
+
+static void put_cbor_value(output_t* out, const field_view_t* field)
+{
+    switch(field->type)
+    {
+        case LOGGER_SERVICE_FIELD_INT:
+            if(field->i >= 0)
+            {
+                put_cbor_head(out, 0, (uint64_t)field->i);
+            }
+            else
+            {
+                put_cbor_head(out, 1, (uint64_t)(-1 - field->i));
+            }
+            break;
+
+        case LOGGER_SERVICE_FIELD_UINT:
+            put_cbor_head(out, 0, field->u);
+            break;
+
+        case LOGGER_SERVICE_FIELD_DOUBLE:
+        {
+            uint64_t bits;
+            uint8_t value[9];
+
+            memcpy(&bits, &field->d, sizeof(bits));
+            value[0] = 0xFB;
+            for(size_t i = 0; i < 8; i++)
+            {
+                value[8 - i] = (uint8_t)(bits >> (8 * i));
+            }
+            put(out, value, sizeof(value));
+            break;
+        }
+
+        case LOGGER_SERVICE_FIELD_BOOL:
+            put_char(out, field->b ? (char)0xF5 : (char)0xF4);
+            break;
+
+        default:
+            put_cbor_text(out, field->s, field->s_len);
+            break;
+    }
+}
+
+static void put_cbor_body(output_t* out, const logger_encode_message_t* message)
+{
+    // The text goes after the longest head its length can need, the head is moved up against the
+    // text once its length is known
+    size_t head = out->len;
+    out->len += 3;
+
+    size_t start = out->len;
+    put_body(out, message);
+
+    if(out->len >= out->size)
+    {
+        return;
+    }
+
+    size_t len = strip_text(out->buffer + start, out->len - start);
+
+    if(len > 0xFFFF)
+    {
+        out->len = out->size;
+        return;
+    }
+
+    out->len = head;
+    put_cbor_head(out, 3, len);
+    memmove(out->buffer + out->len, out->buffer + start, len);
+    out->len += len;
+}
+
+static void encode_cbor(output_t* out, const logger_encode_message_t* message)
+{
+    put_cbor_head(out, 5, 3 + (message->tag != NULL ? 1 : 0) + count_fields(message));
+
+    if(logger_timestamp_time_is_set(message->time))
+    {
+        put_cbor_text(out, "ts", 2);
+        put_cbor_head(out, 0, (uint64_t)message->time);
+    }
+    else
+    {
+        put_cbor_text(out, "clk", 3);
+        put_cbor_head(out, 0, (uint64_t)message->clock);
+    }
+
+    put_cbor_text(out, "lvl", 3);
+    put_cbor_text(out, &levelLetters[message->level], 1);
+
+    if(message->tag != NULL)
+    {
+        put_cbor_text(out, "tag", 3);
+        put_cbor_text(out, message->tag, strlen(message->tag));
+    }
+
+    put_cbor_text(out, "msg", 3);
+    put_cbor_body(out, message);
+
+    field_iter_t it;
+    field_view_t field;
+
+    field_iter_init(&it, message);
+    while(next_field(&it, &field))
+    {
+        put_cbor_text(out, field.key, field.key_len);
+        put_cbor_value(out, &field);
+    }
+}
+
+size_t logger_encode(logger_service_encoding_t encoding, const logger_encode_message_t* message, char* buffer, size_t size)
+{
+    output_t out = { buffer, size, 0 };
+
+    switch(encoding)
+    {
+        case LOGGER_SERVICE_ENCODING_JSON:
+            encode_json(&out, message);
+            break;
+
+        case LOGGER_SERVICE_ENCODING_CBOR:
+            encode_cbor(&out, message);
+            return out.len;
+
+        default:
+            encode_text(&out, message);
+            break;
+    }
+
+    // Terminated like snprintf does
+    if(size > 0)
+    {
+        buffer[out.len < size ? out.len : size - 1] = '\0';
+    }
+
+    return out.len;
+}
+
+size_t logger_encode_capture_fields(uint8_t* args, size_t size, const logger_service_field_t* fields, size_t count)
+{
+    output_t out = { (char*)args, size, 0 };
+
+    for(size_t i = 0; i < count; i++)
+    {
+        size_t len = out.len;
+        field_view_t field;
+
+        field_view(&fields[i], &field);
+        put_cbor_text(&out, field.key, field.key_len);
+        put_cbor_value(&out, &field);
+
+        if(out.len > size)
+        {
+            return len;
+        }
+    }
+
+    return out.len;
+}
+
+logger_service_loglevel_t logger_encode_text_level(const char* message, size_t len)
+{
+    for(size_t level = LOGGER_SERVICE_LOGLEVEL_ERROR; level <= LOGGER_SERVICE_LOGLEVEL_VERBOSE; level++)
+    {
+        size_t prefixLen = strlen(levelPrefixes[level]);
+
+        if(len >= prefixLen && memcmp(message, levelPrefixes[level], prefixLen) == 0)
+        {
+            return (logger_service_loglevel_t)level;
+        }
+    }
+
+    return LOGGER_SERVICE_LOGLEVEL_NONE;
+}
\ No newline at end of file
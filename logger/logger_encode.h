@@ -0,0 +1,60 @@
+#ifndef LOGGER_ENCODE_H
+#define LOGGER_ENCODE_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "logger_service.h"
+
+// Encodes messages for the sinks: as the colored text lines of the LOG_X
+// macros, as JSON Lines or as CBOR maps, without color escapes.
+//
+// A message is printf style, with its arguments in a va_list or captured for
+// deferred formatting, or structured: a fixed message with typed fields. The
+// fields are passed as an array, or as CBOR key value pairs when they were
+// captured for deferred formatting.
+//
+// The encoders write straight into the buffer of the message. The text of a
+// printf style message is formatted in place, then stripped of its color
+// escapes and escaped for JSON in place.
+//
+// JSON and CBOR messages have the members "ts" (time in seconds since the
+// epoch) or "clk" (processor clock while the time is not set), "lvl" (level
+// letter), "tag" (for tagged messages) and "msg", followed by the fields.
+
+typedef enum logger_encode_source_e
+{
+    LOGGER_ENCODE_VLIST,        // format with the arguments in vlist
+    LOGGER_ENCODE_ARGS,         // format with the captured arguments in args
+    LOGGER_ENCODE_FIELDS,       // format is the message, the fields are in fields
+    LOGGER_ENCODE_CBOR_FIELDS   // format is the message, the fields are captured in args
+} logger_encode_source_t;
+
+typedef struct logger_encode_message_s
+{
+    logger_encode_source_t source;
+    logger_service_loglevel_t level;
+    const char* tag;            // NULL for messages without the prefix of the LOG_X macros
+    time_t time;
+    clock_t clock;              // 0 once the time is set
+    const char* format;
+    va_list* vlist;             // Copied before use, so a message can be encoded more than once
+    const uint8_t* args;
+    size_t args_len;
+    const logger_service_field_t* fields;
+    size_t field_count;
+} logger_encode_message_t;
+
+// Returns the length of the message. Text is truncated and its untruncated length returned like
+// snprintf does, JSON and CBOR cannot be truncated and return a length of at least size then.
+size_t logger_encode(logger_service_encoding_t encoding, const logger_encode_message_t* message, char* buffer, size_t size);
+
+// Captures fields as CBOR key value pairs for deferred formatting, fields that do not fit are left out
+size_t logger_encode_capture_fields(uint8_t* args, size_t size, const logger_service_field_t* fields, size_t count);
+
+// Level of a text message from its prefix, LOGGER_SERVICE_LOGLEVEL_NONE for messages without one
+logger_service_loglevel_t logger_encode_text_level(const char* message, size_t len);
+
+#endif // LOGGER_ENCODE_H
\ No newline at end of file
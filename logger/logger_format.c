@@ -0,0 +1,447 @@
+#include "logger_format.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Longest conversion specification that is rendered, e.g. "%-+#012.6llx"
+#define SPEC_MAX_LEN 32
+
+typedef enum arg_type_e
+{
+    ARG_INVALID,
+    ARG_PERCENT,
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_INTMAX,
+    ARG_SIZE,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_LDOUBLE,
+    ARG_STRING,
+    ARG_POINTER
+} arg_type;
+
+typedef struct format_spec_s
+{
+    arg_type type;
+    bool star_width;
+    bool star_precision;
+    int precision;              // Literal precision, -1 if there is none
+    const char* precision_text; // The '.' of the precision, NULL if there is none
+    const char* end;
+} format_spec;
+
+typedef enum length_e
+{
+    LENGTH_NONE,
+    LENGTH_LONG,
+    LENGTH_LLONG,
+    LENGTH_INTMAX,
+    LENGTH_SIZE,
+    LENGTH_PTRDIFF,
+    LENGTH_LDOUBLE
+} length;
+
+// Parses a conversion specification, p points to the character after the '%'
+static void parse_spec(const char* p, format_spec* spec)
+{
+    spec->type = ARG_INVALID;
+    spec->star_width = false;
+    spec->star_precision = false;
+    spec->precision = -1;
+    spec->precision_text = NULL;
+
+    // Flags
+    while(*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+    {
+        p++;
+    }
+
+    // Width
+    if(*p == '*')
+    {
+        spec->star_width = true;
+        p++;
+    }
+    while(*p >= '0' && *p <= '9')
+    {
+        p++;
+    }
+
+    // Precision
+    if(*p == '.')
+    {
+        spec->precision_text = p;
+        spec->precision = 0;
+        p++;
+        if(*p == '*')
+        {
+            spec->star_precision = true;
+            spec->precision = -1;
+            p++;
+        }
+        while(*p >= '0' && *p <= '9')
+        {
+            if(spec->precision < 100000)
+            {
+                spec->precision = spec->precision * 10 + (*p - '0');
+            }
+            p++;
+        }
+    }
+
+    // Length modifier, hh and h arguments are promoted to int
+    length len = LENGTH_NONE;
+    switch(*p)
+    {
+        case 'h':
+            p += p[1] == 'h' ? 2 : 1;
+            break;
+        case 'l':
+            len = p[1] == 'l' ? LENGTH_LLONG : LENGTH_LONG;
+            p += p[1] == 'l' ? 2 : 1;
+            break;
+        case 'q':
+            len = LENGTH_LLONG;
+            p++;
+            break;
+        case 'j':
+            len = LENGTH_INTMAX;
+            p++;
+            break;
+        case 'z':
+            len = LENGTH_SIZE;
+            p++;
+            break;
+        case 't':
+            len = LENGTH_PTRDIFF;
+            p++;
+            break;
+        case 'L':
+            len = LENGTH_LDOUBLE;
+            p++;
+            break;
+        default:
+            break;
+    }
+
+    switch(*p)
+    {
+        case '%':
+            spec->type = ARG_PERCENT;
+            break;
+
+        case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+            switch(len)
+            {
+                case LENGTH_LONG:    spec->type = ARG_LONG;    break;
+                case LENGTH_LLONG:   spec->type = ARG_LLONG;   break;
+                case LENGTH_INTMAX:  spec->type = ARG_INTMAX;  break;
+                case LENGTH_SIZE:    spec->type = ARG_SIZE;    break;
+                case LENGTH_PTRDIFF: spec->type = ARG_PTRDIFF; break;
+                default:             spec->type = ARG_INT;     break;
+            }
+
+            // Wide characters are not supported
+            if(*p == 'c' && len == LENGTH_LONG)
+            {
+                spec->type = ARG_INVALID;
+            }
+            break;
+
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->type = len == LENGTH_LDOUBLE ? ARG_LDOUBLE : ARG_DOUBLE;
+            break;
+
+        case 's':
+            // Wide strings are not supported
+            spec->type = len == LENGTH_NONE ? ARG_STRING : ARG_INVALID;
+            break;
+
+        case 'p':
+            spec->type = ARG_POINTER;
+            break;
+
+        default:
+            // Includes %n, which is never useful after the fact
+            break;
+    }
+
+    spec->end = *p != '\0' ? p + 1 : p;
+}
+
+static bool put(uint8_t* args, size_t size, size_t* used, const void* value, size_t valueSize)
+{
+    if(size - *used < valueSize)
+    {
+        return false;
+    }
+
+    memcpy(args + *used, value, valueSize);
+    *used += valueSize;
+
+    return true;
+}
+
+static bool get(const uint8_t* args, size_t len, size_t* offset, void* value, size_t valueSize)
+{
+    if(len - *offset < valueSize)
+    {
+        return false;
+    }
+
+    memcpy(value, args + *offset, valueSize);
+    *offset += valueSize;
+
+    return true;
+}
+
+#define CAPTURE(type)                                         \
+    {                                                         \
+        type value = va_arg(vlist, type);                     \
+        if(!put(args, size, &used, &value, sizeof(value)))    \
+        {                                                     \
+            return used;                                      \
+        }                                                     \
+    }
+
+// Captures a string argument, reading at most maxLen characters of it, so strings that are not
+// terminated can be logged with a precision, e.g. "%.*s"
+static bool capture_string(uint8_t* args, size_t size, size_t* used, const char* str, size_t maxLen)
+{
+    if(str == NULL)
+    {
+        str = "(null)";
+    }
+
+    // Copy as much of the string as fits after its length
+    if(size - *used < sizeof(uint16_t))
+    {
+        return false;
+    }
+
+    size_t available = size - *used - sizeof(uint16_t);
+    if(available > UINT16_MAX)
+    {
+        available = UINT16_MAX;
+    }
+
+    uint16_t strLen = (uint16_t)strnlen(str, maxLen < available ? maxLen : available);
+    put(args, size, used, &strLen, sizeof(strLen));
+    put(args, size, used, str, strLen);
+
+    return true;
+}
+
+size_t logger_format_capture(uint8_t* args, size_t size, const char* format, va_list vlist)
+{
+    size_t used = 0;
+
+    for(const char* p = format; *p != '\0'; p++)
+    {
+        if(*p != '%')
+        {
+            continue;
+        }
+
+        format_spec spec;
+        parse_spec(p + 1, &spec);
+
+        if(spec.type == ARG_INVALID)
+        {
+            // The argument list cannot be followed past an unknown conversion
+            break;
+        }
+
+        if(spec.star_width)
+        {
+            CAPTURE(int);
+        }
+
+        int precision = spec.precision;
+        if(spec.star_precision)
+        {
+            precision = va_arg(vlist, int);
+            if(!put(args, size, &used, &precision, sizeof(precision)))
+            {
+                return used;
+            }
+        }
+
+        switch(spec.type)
+        {
+            case ARG_INT:       CAPTURE(int);                   break;
+            case ARG_LONG:      CAPTURE(long);                  break;
+            case ARG_LLONG:     CAPTURE(long long);             break;
+            case ARG_INTMAX:    CAPTURE(intmax_t);              break;
+            case ARG_SIZE:      CAPTURE(size_t);                break;
+            case ARG_PTRDIFF:   CAPTURE(ptrdiff_t);             break;
+            case ARG_DOUBLE:    CAPTURE(double);                break;
+            case ARG_LDOUBLE:   CAPTURE(long double);           break;
+            case ARG_POINTER:   CAPTURE(void*);                 break;
+
+            case ARG_STRING:
+                // A negative precision is taken as if it were omitted
+                if(!capture_string(args, size, &used, va_arg(vlist, const char*), precision >= 0 ? (size_t)precision : SIZE_MAX))
+                {
+                    return used;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        p = spec.end - 1;
+    }
+
+    return used;
+}
+
+static void append(char* buffer, size_t size, size_t* written, const char* str, size_t len)
+{
+    if(*written < size)
+    {
+        size_t room = size - *written;
+        memcpy(buffer + *written, str, len < room ? len : room);
+    }
+
+    *written += len;
+}
+
+#define RENDER(type)                                                                                 \
+    {                                                                                                \
+        type value;                                                                                  \
+        if(!get(args, len, &offset, &value, sizeof(value)))                                          \
+        {                                                                                            \
+            goto missing;                                                                            \
+        }                                                                                            \
+        int n = snprintf(written < size ? buffer + written : NULL, written < size ? size - written : 0, specText, value); \
+        written += n > 0 ? (size_t)n : 0;                                                            \
+    }
+
+int logger_format_render(char* buffer, size_t size, const char* format, const uint8_t* args, size_t len)
+{
+    size_t written = 0;
+    size_t offset = 0;
+    const char* p = format;
+
+    while(*p != '\0')
+    {
+        // Copy literal text up to the next conversion
+        const char* next = strchr(p, '%');
+        size_t literalLen = next != NULL ? (size_t)(next - p) : strlen(p);
+        append(buffer, size, &written, p, literalLen);
+        p += literalLen;
+
+        if(*p == '\0')
+        {
+            break;
+        }
+
+        format_spec spec;
+        parse_spec(p + 1, &spec);
+
+        if(spec.type == ARG_PERCENT)
+        {
+            append(buffer, size, &written, "%", 1);
+            p = spec.end;
+            continue;
+        }
+
+        if(spec.type == ARG_INVALID || (size_t)(spec.end - p) >= SPEC_MAX_LEN)
+        {
+            goto missing;
+        }
+
+        // Copy the specification, replacing '*' by the captured width and precision. The precision of a
+        // string is replaced by its captured length, as the captured string is not terminated.
+        const char* specEnd = spec.end;
+        if(spec.type == ARG_STRING)
+        {
+            specEnd = spec.precision_text != NULL ? spec.precision_text : spec.end - 1;
+        }
+
+        char specText[SPEC_MAX_LEN + 24];
+        size_t specLen = 0;
+        for(const char* s = p; s < specEnd; s++)
+        {
+            if(*s != '*')
+            {
+                specText[specLen++] = *s;
+                continue;
+            }
+
+            int value;
+            if(!get(args, len, &offset, &value, sizeof(value)))
+            {
+                goto missing;
+            }
+
+            if(s[-1] == '.' && value < 0)
+            {
+                // A negative precision is taken as if it were omitted
+                specLen--;
+                continue;
+            }
+
+            specLen += (size_t)snprintf(specText + specLen, sizeof(specText) - specLen, "%d", value);
+        }
+        specText[specLen] = '\0';
+
+        switch(spec.type)
+        {
+            case ARG_INT:       RENDER(int);            break;
+            case ARG_LONG:      RENDER(long);           break;
+            case ARG_LLONG:     RENDER(long long);      break;
+            case ARG_INTMAX:    RENDER(intmax_t);       break;
+            case ARG_SIZE:      RENDER(size_t);         break;
+            case ARG_PTRDIFF:   RENDER(ptrdiff_t);      break;
+            case ARG_DOUBLE:    RENDER(double);         break;
+            case ARG_LDOUBLE:   RENDER(long double);    break;
+            case ARG_POINTER:   RENDER(void*);          break;
+
+            case ARG_STRING:
+            {
+                int precision;
+                uint16_t strLen;
+                if((spec.star_precision && !get(args, len, &offset, &precision, sizeof(precision))) ||
+                   !get(args, len, &offset, &strLen, sizeof(strLen)) || len - offset < strLen)
+                {
+                    goto missing;
+                }
+
+                const char* value = (const char*)args + offset;
+                offset += strLen;
+
+                snprintf(specText + specLen, sizeof(specText) - specLen, ".%us", (unsigned)strLen);
+                int n = snprintf(written < size ? buffer + written : NULL, written < size ? size - written : 0, specText, value);
+                written += n > 0 ? (size_t)n : 0;
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        p = spec.end;
+    }
+
+    goto done;
+
+missing:
+    // The rest of the arguments were not captured
+    append(buffer, size, &written, "...", 3);
+
+done:
+    if(size > 0)
+    {
+        buffer[written < size ? written : size - 1] = '\0';
+    }
+
+    return (int)written;
+}
\ No newline at end of file
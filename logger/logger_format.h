@@ -0,0 +1,21 @@
+#ifndef LOGGER_FORMAT_H
+#define LOGGER_FORMAT_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Deferred formatting: the arguments of a printf style call are copied into a
+// buffer at the call site and formatted later from that buffer.
+//
+// Arguments are stored one after another in the order of the format string,
+// each with the size of its promoted C type (int, long, double, ...) and
+// without alignment. Strings are stored inline as a uint16_t length followed by
+// their characters, without terminator, and are read no further than their
+// precision, so "%.*s" can log strings that are not terminated.
+// Arguments that do not fit anymore are not captured and are rendered as "...".
+
+size_t logger_format_capture(uint8_t* args, size_t size, const char* format, va_list vlist);
+int    logger_format_render(char* buffer, size_t size, const char* format, const uint8_t* args, size_t len);
+
+#endif // LOGGER_FORMAT_H
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include "logger_level.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+
+#include "logger_port.h"
+
+// Level of an entry that follows the default level
+#define LEVEL_DEFAULT 0xFF
+
+// Slots tried when interning a tag pointer
+#define MAX_PROBES 8
+
+typedef struct tag_entry_s
+{
+    const char* name;
+    atomic_uchar level;
+    atomic_uint_least32_t messages;
+} tag_entry;
+
+typedef struct tag_slot_s
+{
+    _Atomic(const char*) tag;   // Published after entry is set
+    tag_entry* entry;
+} tag_slot;
+
+static tag_entry entries[CONFIG_LOGGER_SERVICE_TAGS];
+static atomic_size_t entriesCount;
+static tag_slot slots[CONFIG_LOGGER_SERVICE_TAG_CACHE_SIZE];
+
+// Entry of the tags that do not fit in the tables, which always log at the default level
+static tag_entry otherEntry = { "(other)", LEVEL_DEFAULT, 0 };
+
+static atomic_uchar defaultLevel = CONFIG_LOG_DEFAULT_LEVEL;
+static atomic_uchar maxLevel = CONFIG_LOG_DEFAULT_LEVEL;    // Highest level of any tag, disabled calls stop here
+static logger_port_mutex_t lock = NULL;                     // Serializes adding entries and slots
+
+static size_t slot_index(const char* tag)
+{
+    // Fibonacci hashing, the low bits of string addresses carry little information
+    return (size_t)(((uint32_t)(uintptr_t)tag * 2654435769u) >> 16) % CONFIG_LOGGER_SERVICE_TAG_CACHE_SIZE;
+}
+
+static tag_entry* find_entry(const char* name)
+{
+    size_t count = atomic_load_explicit(&entriesCount, memory_order_acquire);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        if(strcmp(entries[i].name, name) == 0)
+        {
+            return &entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Must be called with the lock held
+static tag_entry* add_entry(const char* name)
+{
+    size_t count = atomic_load_explicit(&entriesCount, memory_order_relaxed);
+
+    if(count == CONFIG_LOGGER_SERVICE_TAGS)
+    {
+        return NULL;
+    }
+
+    tag_entry* entry = &entries[count];
+    entry->name = name;
+    atomic_store_explicit(&entry->level, LEVEL_DEFAULT, memory_order_relaxed);
+    atomic_store_explicit(&entry->messages, 0, memory_order_relaxed);
+    atomic_store_explicit(&entriesCount, count + 1, memory_order_release);
+
+    return entry;
+}
+
+// Must be called with the lock held
+static void add_slot(const char* tag, tag_entry* entry)
+{
+    size_t start = slot_index(tag);
+
+    for(size_t i = 0; i < MAX_PROBES; i++)
+    {
+        tag_slot* slot = &slots[(start + i) % CONFIG_LOGGER_SERVICE_TAG_CACHE_SIZE];
+        const char* slotTag = atomic_load_explicit(&slot->tag, memory_order_relaxed);
+
+        if(slotTag == tag)
+        {
+            return;
+        }
+
+        if(slotTag == NULL)
+        {
+            slot->entry = entry;
+            atomic_store_explicit(&slot->tag, tag, memory_order_release);
+            return;
+        }
+    }
+}
+
+// Must be called with the lock held
+static void update_max_level(void)
+{
+    unsigned int max = atomic_load_explicit(&defaultLevel, memory_order_relaxed);
+    size_t count = atomic_load_explicit(&entriesCount, memory_order_relaxed);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        unsigned int level = atomic_load_explicit(&entries[i].level, memory_order_relaxed);
+
+        if(level != LEVEL_DEFAULT && level > max)
+        {
+            max = level;
+        }
+    }
+
+    atomic_store_explicit(&maxLevel, max, memory_order_relaxed);
+}
+
+// Finds or adds the entry of a tag, caching the tag pointer with it if cache is set
+static tag_entry* intern(const char* tag, bool cache)
+{
+    if(lock == NULL)
+    {
+        // Not initialized yet
+        tag_entry* entry = find_entry(tag);
+        return entry != NULL ? entry : &otherEntry;
+    }
+
+    logger_port_mutex_lock(lock);
+
+    tag_entry* entry = find_entry(tag);
+
+    if(entry == NULL)
+    {
+        entry = add_entry(tag);
+    }
+
+    if(entry == NULL)
+    {
+        // The entries are full, cache the tag with the other tags so it is not interned again
+        entry = &otherEntry;
+    }
+
+    if(cache)
+    {
+        add_slot(tag, entry);
+    }
+
+    logger_port_mutex_unlock(lock);
+
+    return entry;
+}
+
+static tag_entry* lookup(const char* tag)
+{
+    size_t start = slot_index(tag);
+
+    for(size_t i = 0; i < MAX_PROBES; i++)
+    {
+        tag_slot* slot = &slots[(start + i) % CONFIG_LOGGER_SERVICE_TAG_CACHE_SIZE];
+        const char* slotTag = atomic_load_explicit(&slot->tag, memory_order_acquire);
+
+        if(slotTag == tag)
+        {
+            return slot->entry;
+        }
+
+        if(slotTag == NULL)
+        {
+            // First time this tag pointer is seen
+            return intern(tag, true);
+        }
+    }
+
+    // The slots the tag pointer hashes to are all taken, so it can not be cached. Compare names on
+    // every call instead, which only takes the lock while the tag has no entry and there is room for it.
+    tag_entry* entry = find_entry(tag);
+
+    if(entry != NULL)
+    {
+        return entry;
+    }
+
+    if(atomic_load_explicit(&entriesCount, memory_order_relaxed) == CONFIG_LOGGER_SERVICE_TAGS)
+    {
+        return &otherEntry;
+    }
+
+    return intern(tag, false);
+}
+
+void logger_level_init(void)
+{
+    if(lock == NULL)
+    {
+        logger_port_mutex_create(&lock);
+    }
+}
+
+bool logger_level_enabled(logger_service_loglevel_t level, const char* tag, logger_level_tag_t* entry)
+{
+    *entry = NULL;
+
+    if(level > atomic_load_explicit(&maxLevel, memory_order_relaxed))
+    {
+        // No tag logs at this level
+        return false;
+    }
+
+    unsigned int tagLevel = LEVEL_DEFAULT;
+
+    if(tag != NULL)
+    {
+        *entry = lookup(tag);
+        tagLevel = atomic_load_explicit(&(*entry)->level, memory_order_relaxed);
+    }
+
+    if(tagLevel == LEVEL_DEFAULT)
+    {
+        tagLevel = atomic_load_explicit(&defaultLevel, memory_order_relaxed);
+    }
+
+    return level <= tagLevel;
+}
+
+void logger_level_count(logger_level_tag_t entry)
+{
+    if(entry != NULL)
+    {
+        atomic_fetch_add_explicit(&entry->messages, 1, memory_order_relaxed);
+    }
+}
+
+bool logger_service_set_level(const char* tag, logger_service_loglevel_t level)
+{
+    if(lock == NULL)
+    {
+        return false;
+    }
+
+    logger_port_mutex_lock(lock);
+
+    bool set = true;
+
+    if(strcmp(tag, "*") == 0)
+    {
+        atomic_store_explicit(&defaultLevel, level, memory_order_relaxed);
+    }
+    else
+    {
+        tag_entry* entry = find_entry(tag);
+
+        if(entry == NULL)
+        {
+            // The tag may not be persistent, keep a copy of the name
+            char* name = strdup(tag);
+            entry = name != NULL ? add_entry(name) : NULL;
+
+            if(entry == NULL)
+            {
+                free(name);
+            }
+        }
+
+        if(entry != NULL)
+        {
+            atomic_store_explicit(&entry->level, level, memory_order_relaxed);
+        }
+
+        set = entry != NULL;
+    }
+
+    update_max_level();
+
+    logger_port_mutex_unlock(lock);
+
+    return set;
+}
+
+logger_service_loglevel_t logger_service_get_level(const char* tag)
+{
+    unsigned int level = LEVEL_DEFAULT;
+
+    if(strcmp(tag, "*") != 0)
+    {
+        tag_entry* entry = find_entry(tag);
+
+        if(entry != NULL)
+        {
+            level = atomic_load_explicit(&entry->level, memory_order_relaxed);
+        }
+    }
+
+    if(level == LEVEL_DEFAULT)
+    {
+        level = atomic_load_explicit(&defaultLevel, memory_order_relaxed);
+    }
+
+    return (logger_service_loglevel_t)level;
+}
+
+bool logger_service_get_tag_metrics(size_t index, logger_service_tag_metrics_t* metrics)
+{
+    size_t count = atomic_load_explicit(&entriesCount, memory_order_acquire);
+    const tag_entry* entry = index < count ? &entries[index] : NULL;
+
+    // The other tags follow the entries once they logged
+    if(index == count && atomic_load_explicit(&otherEntry.messages, memory_order_relaxed) != 0)
+    {
+        entry = &otherEntry;
+    }
+
+    if(entry == NULL)
+    {
+        return false;
+    }
+
+    metrics->tag = entry->name;
+    metrics->messages = atomic_load_explicit(&entry->messages, memory_order_relaxed);
+
+    return true;
+}
\ No newline at end of file
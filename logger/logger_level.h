@@ -0,0 +1,29 @@
+#ifndef LOGGER_LEVEL_H
+#define LOGGER_LEVEL_H
+
+#include <stdbool.h>
+
+#include "logger_service.h"
+
+// Runtime log levels per tag, see logger_service_set_level.
+//
+// Levels are kept per tag name, but looking a name up on every log call is too
+// slow. Instead each tag pointer that is logged with is interned once into a
+// small hash table that maps it to the entry of its name, so a check is a hash
+// of the pointer and a few loads. Both tables are only ever added to, so
+// checks do not take a lock. Tag pointers must stay valid forever, which holds
+// for the string literals and static TAG variables the LOG_X macros are used with.
+// Tag pointers that do not fit in the hash table are looked up by name on every
+// call. Tags that do not fit in the entries share a single entry at the default level.
+
+typedef struct tag_entry_s* logger_level_tag_t;
+
+void logger_level_init(void);
+
+// Checks the level of a call, entry is set to the entry of the tag, NULL for calls without tag
+bool logger_level_enabled(logger_service_loglevel_t level, const char* tag, logger_level_tag_t* entry);
+
+// Counts a message in the entry of its tag from logger_level_enabled, for the metrics
+void logger_level_count(logger_level_tag_t entry);
+
+#endif // LOGGER_LEVEL_H
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include "logger_limit.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include <sdkconfig.h>
+
+#include "logger_port.h"
+#include "logger_work.h"
+
+// Buckets are refilled with the rate once per interval
+#define REFILL_INTERVAL_MS 1000
+
+// Slots tried when interning a format pointer, sites that do not fit are not rate limited
+#define MAX_PROBES 8
+
+typedef struct call_site_s
+{
+    _Atomic(const char*) format;    // Published after tag and level are set
+    const char* tag;
+    logger_service_loglevel_t level;
+    atomic_uint used;               // Tokens taken from the bucket, exceeds the bucket size while messages are suppressed
+    atomic_uint suppressed;         // Messages suppressed since the last refill
+    atomic_uint unreported;         // Suppressed messages counted by the refills, not yet reported
+} call_site;
+
+static call_site sites[CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES];
+
+static atomic_uint rate = CONFIG_LOGGER_SERVICE_RATE_LIMIT;
+static atomic_uint burst = CONFIG_LOGGER_SERVICE_RATE_LIMIT_BURST;
+static atomic_uint_least32_t suppressedCount;
+static atomic_bool refillPending;                   // The timer runs, set by whoever starts it
+static logger_port_timer_t refillTimer = NULL;
+static logger_work_t reportWork;
+static logger_port_mutex_t lock = NULL;             // Serializes claiming sites
+static logger_limit_report_t reportSite = NULL;
+
+static size_t site_index(const char* format)
+{
+    // Fibonacci hashing, the low bits of string addresses carry little information
+    return (size_t)(((uint32_t)(uintptr_t)format * 2654435769u) >> 16) % CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES;
+}
+
+// The bucket holds at least the tokens added per interval, otherwise the rate could never be reached
+static unsigned int bucket_size(void)
+{
+    unsigned int size = atomic_load_explicit(&burst, memory_order_relaxed);
+    unsigned int refill = atomic_load_explicit(&rate, memory_order_relaxed);
+
+    return size > refill ? size : refill;
+}
+
+static call_site* claim(const char* format, const char* tag, logger_service_loglevel_t level)
+{
+    if(lock == NULL)
+    {
+        // Not initialized yet
+        return NULL;
+    }
+
+    logger_port_mutex_lock(lock);
+
+    size_t start = site_index(format);
+    call_site* claimed = NULL;
+
+    for(size_t i = 0; i < MAX_PROBES && claimed == NULL; i++)
+    {
+        call_site* site = &sites[(start + i) % CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES];
+        const char* siteFormat = atomic_load_explicit(&site->format, memory_order_relaxed);
+
+        if(siteFormat == NULL)
+        {
+            site->tag = tag;
+            site->level = level;
+            atomic_store_explicit(&site->format, format, memory_order_release);
+            claimed = site;
+        }
+        else if(siteFormat == format)
+        {
+            // Claimed by another task in the meantime
+            claimed = site;
+        }
+    }
+
+    logger_port_mutex_unlock(lock);
+
+    return claimed;
+}
+
+static call_site* lookup(const char* format, const char* tag, logger_service_loglevel_t level)
+{
+    size_t start = site_index(format);
+
+    for(size_t i = 0; i < MAX_PROBES; i++)
+    {
+        call_site* site = &sites[(start + i) % CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES];
+        const char* siteFormat = atomic_load_explicit(&site->format, memory_order_acquire);
+
+        if(siteFormat == format)
+        {
+            return site;
+        }
+
+        if(siteFormat == NULL)
+        {
+            // First time this call site logs
+            return claim(format, tag, level);
+        }
+    }
+
+    // All slots are taken, the site is not rate limited but also does not take the lock on every call
+    return NULL;
+}
+
+static void start_refill(void)
+{
+    if(refillTimer != NULL && !atomic_exchange(&refillPending, true) && !logger_port_timer_start(refillTimer, REFILL_INTERVAL_MS))
+    {
+        // The next log call of a site tries again
+        atomic_store(&refillPending, false);
+    }
+}
+
+// Posted by the refill, logs the reports on a task that may call the sinks
+static void report(void* arg)
+{
+    for(size_t i = 0; i < CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES; i++)
+    {
+        call_site* site = &sites[i];
+        const char* format = atomic_load_explicit(&site->format, memory_order_acquire);
+        unsigned int count = format != NULL ? atomic_exchange_explicit(&site->unreported, 0, memory_order_relaxed) : 0;
+
+        if(count > 0)
+        {
+            reportSite(site->level, site->tag, format, count);
+        }
+    }
+}
+
+// Runs on the timer task, so it only refills the buckets and leaves the reports to the posted work
+static void refill(void* arg)
+{
+    unsigned int tokens = atomic_load_explicit(&rate, memory_order_relaxed);
+    unsigned int size = bucket_size();
+    bool active = false;
+    bool suppressed = false;
+
+    if(tokens == 0)
+    {
+        // Rate limiting was disabled, empty all buckets
+        tokens = size;
+    }
+
+    for(size_t i = 0; i < CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES; i++)
+    {
+        call_site* site = &sites[i];
+        const char* format = atomic_load_explicit(&site->format, memory_order_acquire);
+
+        if(format == NULL)
+        {
+            continue;
+        }
+
+        unsigned int used = atomic_load_explicit(&site->used, memory_order_relaxed);
+        unsigned int left = 0;
+
+        while(used != 0)
+        {
+            left = used < size ? used : size;
+            left = left > tokens ? left - tokens : 0;
+
+            if(atomic_compare_exchange_weak_explicit(&site->used, &used, left, memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        unsigned int count = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+
+        if(count > 0)
+        {
+            atomic_fetch_add_explicit(&site->unreported, count, memory_order_relaxed);
+            suppressed = true;
+        }
+
+        active = active || left > 0;
+    }
+
+    if(suppressed)
+    {
+        logger_work_post(&reportWork);
+    }
+
+    if(active && logger_port_timer_start(refillTimer, REFILL_INTERVAL_MS))
+    {
+        return;
+    }
+
+    atomic_store(&refillPending, false);
+
+    // A site that took its first token after it was refilled could not start the timer, and active sites
+    // have to be refilled again if the timer could not be restarted
+    for(size_t i = 0; i < CONFIG_LOGGER_SERVICE_RATE_LIMIT_SITES; i++)
+    {
+        if(atomic_load_explicit(&sites[i].used, memory_order_relaxed) > 0)
+        {
+            start_refill();
+            break;
+        }
+    }
+}
+
+void logger_limit_init(logger_limit_report_t report_site)
+{
+    if(lock != NULL)
+    {
+        return;
+    }
+
+    reportSite = report_site;
+    logger_work_add(&reportWork, report, NULL);
+
+    // Sites can only be claimed once the timer exists
+    if(logger_port_timer_create(refill, NULL, &refillTimer))
+    {
+        logger_port_mutex_create(&lock);
+    }
+}
+
+bool logger_limit_allow(logger_service_loglevel_t level, const char* tag, const char* format)
+{
+    if(atomic_load_explicit(&rate, memory_order_relaxed) == 0)
+    {
+        return true;
+    }
+
+    call_site* site = lookup(format, tag, level);
+
+    if(site == NULL)
+    {
+        return true;
+    }
+
+    unsigned int used = atomic_fetch_add_explicit(&site->used, 1, memory_order_relaxed);
+
+    if(!atomic_load_explicit(&refillPending, memory_order_relaxed))
+    {
+        // The bucket was full or the timer could not be restarted, have it refilled
+        start_refill();
+    }
+
+    if(used < bucket_size())
+    {
+        return true;
+    }
+
+    atomic_fetch_add_explicit(&site->suppressed, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&suppressedCount, 1, memory_order_relaxed);
+
+    return false;
+}
+
+uint32_t logger_limit_suppressed(void)
+{
+    return atomic_load(&suppressedCount);
+}
+
+void logger_service_set_rate_limit(uint32_t messages_per_second, uint32_t burst_size)
+{
+    atomic_store_explicit(&burst, burst_size, memory_order_relaxed);
+    atomic_store_explicit(&rate, messages_per_second, memory_order_relaxed);
+}
\ No newline at end of file
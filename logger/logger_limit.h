@@ -0,0 +1,26 @@
+#ifndef LOGGER_LIMIT_H
+#define LOGGER_LIMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "logger_service.h"
+
+// Rate limiting per call site, see logger_service_set_rate_limit.
+//
+// A call site is identified by its format pointer, which is interned once into
+// a small hash table like the tags of logger_level. Every site has a token
+// bucket of which a log call only takes a token with an atomic increment, a
+// timer refills the buckets of active sites once a second. The messages that
+// found their bucket empty are counted and reported as a single "last message
+// repeated N times" message, which the timer posts as logger_work so it is not
+// logged on the timer task.
+
+// Logs the report of a site, which must not be rate limited itself
+typedef void (*logger_limit_report_t)(logger_service_loglevel_t level, const char* tag, const char* format, unsigned int count);
+
+void logger_limit_init(logger_limit_report_t report);
+bool logger_limit_allow(logger_service_loglevel_t level, const char* tag, const char* format);
+uint32_t logger_limit_suppressed(void);
+
+#endif // LOGGER_LIMIT_H
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "logger_live_sink.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ringbuf.h>
+
+#include "logger_port.h"
+
+#define DEFAULT_MAX_CLIENTS 2
+#define DEFAULT_BACKLOG_SIZE 4096
+
+struct logger_live_client_s
+{
+    void* context;
+    ringbuf backlog;                    // NULL if the client slot is free
+    logger_service_loglevel_t level;
+    uint32_t dropped;                   // Messages dropped since the client last read
+};
+
+struct logger_live_sink_s
+{
+    logger_port_mutex_t lock;           // Protects the clients and their backlogs
+    atomic_size_t client_count;         // Lets messages skip the lock when nobody is connected
+    size_t max_clients;
+    size_t backlog_size;
+    logger_service_loglevel_t default_level;
+    struct logger_live_client_s clients[];
+};
+
+// Must be called with the lock held
+static void write_client(logger_live_client_t client, const char* message, size_t len)
+{
+    for(;;)
+    {
+        util_err_t err = ringbuf_write(client->backlog, message, len);
+
+        if(err != UTIL_ERR_FULL)
+        {
+            if(err != UTIL_OK)
+            {
+                // Larger than the backlog
+                client->dropped++;
+            }
+            return;
+        }
+
+        // Make room by dropping the oldest message, the lock keeps the reader out
+        const void* oldest;
+        size_t oldestLen;
+
+        if(ringbuf_peek(client->backlog, &oldest, &oldestLen) != UTIL_OK)
+        {
+            client->dropped++;
+            return;
+        }
+
+        ringbuf_release(client->backlog);
+        client->dropped++;
+    }
+}
+
+void logger_live_sink_conf_init(logger_live_sink_conf_t* conf)
+{
+    conf->max_clients = DEFAULT_MAX_CLIENTS;
+    conf->backlog_size = DEFAULT_BACKLOG_SIZE;
+    conf->default_level = LOGGER_SERVICE_LOGLEVEL_INFO;
+}
+
+logger_live_sink_t logger_live_sink_new(const logger_live_sink_conf_t* conf)
+{
+    if(conf->max_clients == 0 || conf->backlog_size == 0)
+    {
+        return NULL;
+    }
+
+    logger_live_sink_t sink = (logger_live_sink_t)calloc(1, sizeof(*sink) + conf->max_clients * sizeof(struct logger_live_client_s));
+
+    if(sink == NULL)
+    {
+        return NULL;
+    }
+
+    if(!logger_port_mutex_create(&sink->lock))
+    {
+        free(sink);
+        return NULL;
+    }
+
+    sink->max_clients = conf->max_clients;
+    sink->backlog_size = conf->backlog_size;
+    sink->default_level = conf->default_level;
+
+    return sink;
+}
+
+void logger_live_sink_delete(logger_live_sink_t sink)
+{
+    if(sink == NULL)
+    {
+        return;
+    }
+
+    for(size_t i = 0; i < sink->max_clients; i++)
+    {
+        if(sink->clients[i].backlog != NULL)
+        {
+            ringbuf_delete(sink->clients[i].backlog);
+        }
+    }
+
+    logger_port_mutex_delete(sink->lock);
+    free(sink);
+}
+
+void logger_live_sink_write(const char* message, const size_t len, void* user_data)
+{
+    logger_live_sink_t sink = (logger_live_sink_t)user_data;
+
+    if(atomic_load_explicit(&sink->client_count, memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    // Messages without a level are sent to every client
+    logger_service_loglevel_t level = logger_service_message_level(message, len);
+
+    logger_port_mutex_lock(sink->lock);
+
+    for(size_t i = 0; i < sink->max_clients; i++)
+    {
+        logger_live_client_t client = &sink->clients[i];
+
+        if(client->backlog != NULL && level <= client->level)
+        {
+            write_client(client, message, len);
+        }
+    }
+
+    logger_port_mutex_unlock(sink->lock);
+}
+
+logger_live_client_t logger_live_sink_add_client(logger_live_sink_t sink, void* context)
+{
+    logger_live_client_t client = NULL;
+
+    logger_port_mutex_lock(sink->lock);
+
+    for(size_t i = 0; i < sink->max_clients && client == NULL; i++)
+    {
+        if(sink->clients[i].backlog == NULL && ringbuf_new(sink->backlog_size, &sink->clients[i].backlog) == UTIL_OK)
+        {
+            client = &sink->clients[i];
+            client->context = context;
+            client->level = sink->default_level;
+            client->dropped = 0;
+
+            atomic_fetch_add(&sink->client_count, 1);
+        }
+    }
+
+    logger_port_mutex_unlock(sink->lock);
+
+    return client;
+}
+
+logger_live_client_t logger_live_sink_find_client(logger_live_sink_t sink, void* context)
+{
+    // Only the reading task adds and removes clients, so it can look them up without the lock
+    for(size_t i = 0; i < sink->max_clients; i++)
+    {
+        if(sink->clients[i].backlog != NULL && sink->clients[i].context == context)
+        {
+            return &sink->clients[i];
+        }
+    }
+
+    return NULL;
+}
+
+void logger_live_sink_remove_client(logger_live_sink_t sink, logger_live_client_t client)
+{
+    logger_port_mutex_lock(sink->lock);
+
+    ringbuf_delete(client->backlog);
+    client->backlog = NULL;
+    client->context = NULL;
+
+    atomic_fetch_sub(&sink->client_count, 1);
+
+    logger_port_mutex_unlock(sink->lock);
+}
+
+void logger_live_sink_set_client_level(logger_live_sink_t sink, logger_live_client_t client, logger_service_loglevel_t level)
+{
+    logger_port_mutex_lock(sink->lock);
+    client->level = level;
+    logger_port_mutex_unlock(sink->lock);
+}
+
+bool logger_live_sink_read(logger_live_sink_t sink, logger_live_client_t client, char* buffer, size_t size, size_t* len)
+{
+    bool read = true;
+
+    logger_port_mutex_lock(sink->lock);
+
+    if(client->dropped > 0)
+    {
+        int n = snprintf(buffer, size, "... %u messages dropped\n", (unsigned int)client->dropped);
+        *len = n < 0 ? 0 : ((size_t)n < size ? (size_t)n : size - 1);
+        client->dropped = 0;
+    }
+    else
+    {
+        read = ringbuf_read(client->backlog, buffer, size, len) == UTIL_OK;
+
+        if(read && *len > size)
+        {
+            // Truncated
+            *len = size;
+        }
+    }
+
+    logger_port_mutex_unlock(sink->lock);
+
+    return read;
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "logger_metrics.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "logger_clock.h"
+#include "logger_level.h"
+#include "logger_sinks.h"
+
+static atomic_uint_least32_t messageCounts[LOGGER_SERVICE_LOGLEVEL_VERBOSE + 1];
+static atomic_uint_least64_t bytesCount;
+
+#ifdef CONFIG_LOGGER_SERVICE_METRICS
+void logger_metrics_message(logger_service_loglevel_t level, logger_level_tag_t tag)
+{
+    if(level <= LOGGER_SERVICE_LOGLEVEL_VERBOSE)
+    {
+        atomic_fetch_add_explicit(&messageCounts[level], 1, memory_order_relaxed);
+    }
+
+    logger_level_count(tag);
+}
+
+int64_t logger_metrics_start(void)
+{
+    return logger_clock_us();
+}
+
+static unsigned int latency_bucket(uint32_t us)
+{
+    unsigned int bucket = 0;
+
+    while(us != 0 && bucket < LOGGER_SERVICE_LATENCY_BUCKETS - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+int64_t logger_metrics_sink_call(sink_handle_t sink, size_t len, int64_t start)
+{
+    int64_t end = logger_clock_us();
+    int64_t elapsed = end - start;
+    uint32_t us = elapsed < UINT32_MAX ? (uint32_t)elapsed : UINT32_MAX;
+    logger_metrics_sink_t* metrics = &sink->metrics;
+
+    atomic_fetch_add_explicit(&metrics->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics->bytes, len, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics->time_us, us, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metrics->latency[latency_bucket(us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytesCount, len, memory_order_relaxed);
+
+    uint32_t max = atomic_load_explicit(&metrics->max_us, memory_order_relaxed);
+    while(us > max && !atomic_compare_exchange_weak_explicit(&metrics->max_us, &max, us, memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+
+    return end;
+}
+#endif
+
+void logger_service_get_metrics(logger_service_metrics_t* metrics)
+{
+    logger_service_get_stats(&metrics->stats);
+
+    for(size_t i = 0; i <= LOGGER_SERVICE_LOGLEVEL_VERBOSE; i++)
+    {
+        metrics->messages[i] = atomic_load_explicit(&messageCounts[i], memory_order_relaxed);
+    }
+
+    metrics->bytes = atomic_load_explicit(&bytesCount, memory_order_relaxed);
+}
+
+bool logger_service_get_sink_metrics(size_t index, logger_service_sink_metrics_t* metrics)
+{
+    unsigned int reader;
+    const sink_set* set = logger_sinks_acquire(&reader);
+    bool found = set != NULL && index < set->count;
+
+    if(found)
+    {
+        sink_handle_t sink = set->sinks[index];
+
+        metrics->sink = sink;
+        metrics->name = sink->name;
+        metrics->encoding = sink->encoding;
+        metrics->calls = atomic_load_explicit(&sink->metrics.calls, memory_order_relaxed);
+        metrics->bytes = atomic_load_explicit(&sink->metrics.bytes, memory_order_relaxed);
+        metrics->time_us = atomic_load_explicit(&sink->metrics.time_us, memory_order_relaxed);
+        metrics->max_us = atomic_load_explicit(&sink->metrics.max_us, memory_order_relaxed);
+
+        for(size_t i = 0; i < LOGGER_SERVICE_LATENCY_BUCKETS; i++)
+        {
+            metrics->latency[i] = atomic_load_explicit(&sink->metrics.latency[i], memory_order_relaxed);
+        }
+    }
+
+    logger_sinks_release(reader);
+
+    return found;
+}
+
+/*
+ * JSON
+ */
+typedef struct json_writer_s
+{
+    char* buffer;
+    size_t size;
+    size_t len;     // Untruncated
+} json_writer;
+
+static void json_printf(json_writer* writer, const char* format, ...)
+{
+    bool fits = writer->len < writer->size;
+
+    va_list list;
+    va_start(list, format);
+    int len = vsnprintf(fits ? writer->buffer + writer->len : NULL, fits ? writer->size - writer->len : 0, format, list);
+    va_end(list);
+
+    if(len > 0)
+    {
+        writer->len += (size_t)len;
+    }
+}
+
+static void json_string(json_writer* writer, const char* s)
+{
+    if(s == NULL)
+    {
+        json_printf(writer, "null");
+        return;
+    }
+
+    json_printf(writer, "\"");
+
+    for(; *s != '\0'; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+
+        if(c == '"' || c == '\\')
+        {
+            json_printf(writer, "\\%c", c);
+        }
+        else if(c < 0x20)
+        {
+            json_printf(writer, "\\u%04x", c);
+        }
+        else
+        {
+            json_printf(writer, "%c", c);
+        }
+    }
+
+    json_printf(writer, "\"");
+}
+
+int logger_service_metrics_json(char* buffer, size_t size)
+{
+    static const char* const levelNames[] = { "none", "error", "warn", "info", "debug", "verbose" };
+    static const char* const encodingNames[LOGGER_SERVICE_ENCODINGS] = { "text", "json", "cbor" };
+
+    json_writer writer = { buffer, size, 0 };
+
+    if(size > 0)
+    {
+        buffer[0] = '\0';
+    }
+
+    logger_service_metrics_t metrics;
+    logger_service_get_metrics(&metrics);
+
+    json_printf(&writer, "{\"messages\":{");
+    for(size_t i = LOGGER_SERVICE_LOGLEVEL_ERROR; i <= LOGGER_SERVICE_LOGLEVEL_VERBOSE; i++)
+    {
+        json_printf(&writer, "%s\"%s\":%" PRIu32, i > LOGGER_SERVICE_LOGLEVEL_ERROR ? "," : "", levelNames[i], metrics.messages[i]);
+    }
+
+    json_printf(&writer, "},\"queued\":%" PRIu32 ",\"dropped\":%" PRIu32 ",\"overwritten\":%" PRIu32 ",\"suppressed\":%" PRIu32 ",\"bytes\":%" PRIu64,
+        metrics.stats.queued, metrics.stats.dropped, metrics.stats.overwritten, metrics.stats.suppressed, metrics.bytes);
+
+    json_printf(&writer, ",\"sinks\":[");
+
+    logger_service_sink_metrics_t sink;
+    for(size_t i = 0; logger_service_get_sink_metrics(i, &sink); i++)
+    {
+        json_printf(&writer, "%s{\"name\":", i > 0 ? "," : "");
+        json_string(&writer, sink.name);
+        json_printf(&writer, ",\"encoding\":\"%s\",\"calls\":%" PRIu32 ",\"bytes\":%" PRIu64 ",\"time_us\":%" PRIu64 ",\"max_us\":%" PRIu32 ",\"latency_log2_us\":[",
+            encodingNames[sink.encoding], sink.calls, sink.bytes, sink.time_us, sink.max_us);
+
+        for(size_t j = 0; j < LOGGER_SERVICE_LATENCY_BUCKETS; j++)
+        {
+            json_printf(&writer, "%s%" PRIu32, j > 0 ? "," : "", sink.latency[j]);
+        }
+
+        json_printf(&writer, "]}");
+    }
+
+    json_printf(&writer, "],\"tags\":[");
+
+    logger_service_tag_metrics_t tag;
+    for(size_t i = 0; logger_service_get_tag_metrics(i, &tag); i++)
+    {
+        json_printf(&writer, "%s{\"tag\":", i > 0 ? "," : "");
+        json_string(&writer, tag.tag);
+        json_printf(&writer, ",\"messages\":%" PRIu32 "}", tag.messages);
+    }
+
+    json_printf(&writer, "]}");
+
+    return (int)writer.len;
+}
\ No newline at end of file
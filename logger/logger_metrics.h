@@ -0,0 +1,43 @@
+#ifndef LOGGER_METRICS_H
+#define LOGGER_METRICS_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sdkconfig.h>
+
+#include "logger_level.h"
+#include "logger_service.h"
+
+// Counters of the logger service, see logger_service_get_metrics.
+//
+// Counters are only incremented with relaxed atomics, readers take a snapshot
+// without a lock while messages are being logged. Every sink keeps its own
+// counters in its handle. The time spent in a sink is measured around every
+// call of its callback and counted in a log2 histogram of microseconds.
+
+typedef struct logger_metrics_sink_s
+{
+    atomic_uint_least32_t calls;
+    atomic_uint_least64_t bytes;
+    atomic_uint_least64_t time_us;
+    atomic_uint_least32_t max_us;
+    atomic_uint_least32_t latency[LOGGER_SERVICE_LATENCY_BUCKETS];
+} logger_metrics_sink_t;
+
+#ifdef CONFIG_LOGGER_SERVICE_METRICS
+// A message passed the level check and rate limit, tag is the entry from logger_level_enabled
+void    logger_metrics_message(logger_service_loglevel_t level, logger_level_tag_t tag);
+
+// Measures sink calls, pass the result of logger_metrics_start to logger_metrics_sink_call after calling
+// the sink. That returns when the call ended, which is the start of a call to the next sink.
+int64_t logger_metrics_start(void);
+int64_t logger_metrics_sink_call(sink_handle_t sink, size_t len, int64_t start);
+#else
+static inline void    logger_metrics_message(logger_service_loglevel_t level, logger_level_tag_t tag) {}
+static inline int64_t logger_metrics_start(void) { return 0; }
+static inline int64_t logger_metrics_sink_call(sink_handle_t sink, size_t len, int64_t start) { return 0; }
+#endif
+
+#endif // LOGGER_METRICS_H
\ No newline at end of file
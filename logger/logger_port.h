@@ -0,0 +1,50 @@
+#ifndef LOGGER_PORT_H
+#define LOGGER_PORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Operating system functions used by the logger service, so the service
+// itself does not depend on FreeRTOS directly.
+
+typedef void* logger_port_task_t;
+
+bool logger_port_task_start(void (*task)(void* arg), void* arg, const char* name, size_t stack_size, unsigned int priority, logger_port_task_t* handle);
+bool logger_port_task_is_current(logger_port_task_t handle);
+
+// Wakes up a task that is waiting in logger_port_task_wait
+void logger_port_task_notify(logger_port_task_t handle);
+void logger_port_task_wait(void);
+
+// Binary semaphore
+typedef void* logger_port_sem_t;
+
+bool logger_port_sem_create(logger_port_sem_t* sem);
+void logger_port_sem_give(logger_port_sem_t sem);
+bool logger_port_sem_take(logger_port_sem_t sem, uint32_t timeout_ms);
+
+// Mutex, with priority inheritance where the operating system supports it
+typedef void* logger_port_mutex_t;
+
+bool logger_port_mutex_create(logger_port_mutex_t* mutex);
+void logger_port_mutex_lock(logger_port_mutex_t mutex);
+bool logger_port_mutex_try_lock(logger_port_mutex_t mutex);     // Fails if the mutex is held, also by the calling task
+void logger_port_mutex_unlock(logger_port_mutex_t mutex);
+void logger_port_mutex_delete(logger_port_mutex_t mutex);
+
+// One shot timer, the callback runs on a timer task and should not block for long
+typedef void* logger_port_timer_t;
+
+bool logger_port_timer_create(void (*callback)(void* arg), void* arg, logger_port_timer_t* timer);
+// Restarts the timer if it is running. Never blocks, so it can be called from timer callbacks and with a
+// lock held, returns false if the timer task had no room for the command.
+bool logger_port_timer_start(logger_port_timer_t timer, uint32_t ms);
+void logger_port_timer_delete(logger_port_timer_t timer);               // The callback does not run anymore once this returns
+
+void logger_port_sleep_ms(uint32_t ms);
+
+// Monotonic time in microseconds, cheap enough to read around every sink call
+int64_t logger_port_time_us(void);
+
+#endif // LOGGER_PORT_H
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "logger_port.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/timers.h>
+
+#include <esp_timer.h>
+
+#include <stdlib.h>
+
+bool logger_port_task_start(void (*task)(void* arg), void* arg, const char* name, size_t stack_size, unsigned int priority, logger_port_task_t* handle)
+{
+    TaskHandle_t taskHandle = NULL;
+
+    if(xTaskCreate(task, name, stack_size, arg, priority, &taskHandle) != pdPASS)
+    {
+        *handle = NULL;
+        return false;
+    }
+
+    *handle = taskHandle;
+    return true;
+}
+
+bool logger_port_task_is_current(logger_port_task_t handle)
+{
+    return xTaskGetCurrentTaskHandle() == (TaskHandle_t)handle;
+}
+
+void logger_port_task_notify(logger_port_task_t handle)
+{
+    xTaskNotifyGive((TaskHandle_t)handle);
+}
+
+void logger_port_task_wait(void)
+{
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+bool logger_port_sem_create(logger_port_sem_t* sem)
+{
+    *sem = xSemaphoreCreateBinary();
+    return *sem != NULL;
+}
+
+void logger_port_sem_give(logger_port_sem_t sem)
+{
+    xSemaphoreGive((SemaphoreHandle_t)sem);
+}
+
+bool logger_port_sem_take(logger_port_sem_t sem, uint32_t timeout_ms)
+{
+    return xSemaphoreTake((SemaphoreHandle_t)sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+bool logger_port_mutex_create(logger_port_mutex_t* mutex)
+{
+    *mutex = xSemaphoreCreateMutex();
+    return *mutex != NULL;
+}
+
+void logger_port_mutex_lock(logger_port_mutex_t mutex)
+{
+    xSemaphoreTake((SemaphoreHandle_t)mutex, portMAX_DELAY);
+}
+
+bool logger_port_mutex_try_lock(logger_port_mutex_t mutex)
+{
+    return xSemaphoreTake((SemaphoreHandle_t)mutex, 0) == pdTRUE;
+}
+
+void logger_port_mutex_unlock(logger_port_mutex_t mutex)
+{
+    xSemaphoreGive((SemaphoreHandle_t)mutex);
+}
+
+void logger_port_mutex_delete(logger_port_mutex_t mutex)
+{
+    vSemaphoreDelete((SemaphoreHandle_t)mutex);
+}
+
+typedef struct port_timer_s
+{
+    TimerHandle_t handle;
+    void (*callback)(void* arg);
+    void* arg;
+} port_timer;
+
+static void timer_callback(TimerHandle_t handle)
+{
+    port_timer* t = (port_timer*)pvTimerGetTimerID(handle);
+    t->callback(t->arg);
+}
+
+static void timer_deleted(void* done, uint32_t unused)
+{
+    xSemaphoreGive((SemaphoreHandle_t)done);
+}
+
+bool logger_port_timer_create(void (*callback)(void* arg), void* arg, logger_port_timer_t* timer)
+{
+    port_timer* t = (port_timer*)malloc(sizeof(*t));
+
+    if(t == NULL)
+    {
+        *timer = NULL;
+        return false;
+    }
+
+    t->callback = callback;
+    t->arg = arg;
+    t->handle = xTimerCreate("logger", 1, pdFALSE, t, timer_callback);
+
+    if(t->handle == NULL)
+    {
+        free(t);
+        *timer = NULL;
+        return false;
+    }
+
+    *timer = t;
+    return true;
+}
+
+bool logger_port_timer_start(logger_port_timer_t timer, uint32_t ms)
+{
+    TickType_t ticks = pdMS_TO_TICKS(ms);
+
+    // Changing the period starts the timer. Waiting for room in the command queue from the timer task
+    // itself would never end.
+    return xTimerChangePeriod(((port_timer*)timer)->handle, ticks > 0 ? ticks : 1, 0) == pdPASS;
+}
+
+void logger_port_timer_delete(logger_port_timer_t timer)
+{
+    port_timer* t = (port_timer*)timer;
+
+    xTimerDelete(t->handle, portMAX_DELAY);
+
+    // The timer task handles its commands in order, so once it has called this function it does not use the timer anymore
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+
+    if(done == NULL || xTimerPendFunctionCall(timer_deleted, done, 0, portMAX_DELAY) != pdPASS)
+    {
+        // Rather leak the timer than free it while it may still be used
+        if(done != NULL)
+        {
+            vSemaphoreDelete(done);
+        }
+        return;
+    }
+
+    xSemaphoreTake(done, portMAX_DELAY);
+    vSemaphoreDelete(done);
+    free(t);
+}
+
+void logger_port_sleep_ms(uint32_t ms)
+{
+    // Sleep at least one tick so lower priority tasks can run
+    TickType_t ticks = pdMS_TO_TICKS(ms);
+    vTaskDelay(ticks > 0 ? ticks : 1);
+}
+
+int64_t logger_port_time_us(void)
+{
+    return esp_timer_get_time();
+}
\ No newline at end of file
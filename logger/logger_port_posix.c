@@ -0,0 +1,324 @@
+#include "logger_port.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+// POSIX threads implementation, used to build and benchmark the logger service on a host
+
+typedef struct port_task_s
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    unsigned int notifications;
+    void (*task)(void* arg);
+    void* arg;
+} port_task;
+
+static __thread port_task* currentTask = NULL;
+
+static void* task_main(void* arg)
+{
+    port_task* t = (port_task*)arg;
+    currentTask = t;
+
+#ifdef SCHED_IDLE
+    // The logging task has a low priority, it should not preempt the tasks that log
+    struct sched_param param = { .sched_priority = 0 };
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+
+    t->task(t->arg);
+
+    return NULL;
+}
+
+bool logger_port_task_start(void (*task)(void* arg), void* arg, const char* name, size_t stack_size, unsigned int priority, logger_port_task_t* handle)
+{
+    (void)name;
+    (void)stack_size;
+    (void)priority;
+
+    port_task* t = (port_task*)calloc(1, sizeof(*t));
+
+    if(t == NULL)
+    {
+        *handle = NULL;
+        return false;
+    }
+
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->notified, NULL);
+    t->task = task;
+    t->arg = arg;
+
+    if(pthread_create(&t->thread, NULL, task_main, t) != 0)
+    {
+        free(t);
+        *handle = NULL;
+        return false;
+    }
+
+    pthread_detach(t->thread);
+
+    *handle = t;
+    return true;
+}
+
+bool logger_port_task_is_current(logger_port_task_t handle)
+{
+    return currentTask == (port_task*)handle;
+}
+
+void logger_port_task_notify(logger_port_task_t handle)
+{
+    port_task* t = (port_task*)handle;
+
+    pthread_mutex_lock(&t->lock);
+    t->notifications++;
+    pthread_cond_signal(&t->notified);
+    pthread_mutex_unlock(&t->lock);
+}
+
+void logger_port_task_wait(void)
+{
+    port_task* t = currentTask;
+
+    pthread_mutex_lock(&t->lock);
+    while(t->notifications == 0)
+    {
+        pthread_cond_wait(&t->notified, &t->lock);
+    }
+    t->notifications = 0;
+    pthread_mutex_unlock(&t->lock);
+}
+
+// Absolute time for the timed waits of pthreads
+static void deadline_after(uint32_t ms, struct timespec* deadline)
+{
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += ms / 1000;
+    deadline->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if(deadline->tv_nsec >= 1000000000L)
+    {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+static bool deadline_passed(const struct timespec* deadline)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+typedef struct port_sem_s
+{
+    pthread_mutex_t lock;
+    pthread_cond_t given;
+    bool available;
+} port_sem;
+
+bool logger_port_sem_create(logger_port_sem_t* sem)
+{
+    port_sem* s = (port_sem*)calloc(1, sizeof(*s));
+
+    if(s == NULL)
+    {
+        *sem = NULL;
+        return false;
+    }
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->given, NULL);
+
+    *sem = s;
+    return true;
+}
+
+void logger_port_sem_give(logger_port_sem_t sem)
+{
+    port_sem* s = (port_sem*)sem;
+
+    pthread_mutex_lock(&s->lock);
+    s->available = true;
+    pthread_cond_signal(&s->given);
+    pthread_mutex_unlock(&s->lock);
+}
+
+bool logger_port_sem_take(logger_port_sem_t sem, uint32_t timeout_ms)
+{
+    port_sem* s = (port_sem*)sem;
+
+    struct timespec deadline;
+    deadline_after(timeout_ms, &deadline);
+
+    pthread_mutex_lock(&s->lock);
+    while(!s->available)
+    {
+        if(pthread_cond_timedwait(&s->given, &s->lock, &deadline) != 0)
+        {
+            break;
+        }
+    }
+
+    bool taken = s->available;
+    s->available = false;
+    pthread_mutex_unlock(&s->lock);
+
+    return taken;
+}
+
+bool logger_port_mutex_create(logger_port_mutex_t* mutex)
+{
+    pthread_mutex_t* m = (pthread_mutex_t*)malloc(sizeof(*m));
+
+    if(m == NULL)
+    {
+        *mutex = NULL;
+        return false;
+    }
+
+    pthread_mutex_init(m, NULL);
+
+    *mutex = m;
+    return true;
+}
+
+void logger_port_mutex_lock(logger_port_mutex_t mutex)
+{
+    pthread_mutex_lock((pthread_mutex_t*)mutex);
+}
+
+bool logger_port_mutex_try_lock(logger_port_mutex_t mutex)
+{
+    return pthread_mutex_trylock((pthread_mutex_t*)mutex) == 0;
+}
+
+void logger_port_mutex_unlock(logger_port_mutex_t mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t*)mutex);
+}
+
+void logger_port_mutex_delete(logger_port_mutex_t mutex)
+{
+    pthread_mutex_destroy((pthread_mutex_t*)mutex);
+    free(mutex);
+}
+
+// Every timer has its own thread, which waits for the deadline
+typedef struct port_timer_s
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    struct timespec deadline;
+    bool armed;
+    bool stopping;
+    void (*callback)(void* arg);
+    void* arg;
+} port_timer;
+
+static void* timer_main(void* arg)
+{
+    port_timer* t = (port_timer*)arg;
+
+    pthread_mutex_lock(&t->lock);
+    while(!t->stopping)
+    {
+        if(!t->armed)
+        {
+            pthread_cond_wait(&t->changed, &t->lock);
+        }
+        else if(pthread_cond_timedwait(&t->changed, &t->lock, &t->deadline) == ETIMEDOUT && deadline_passed(&t->deadline))
+        {
+            t->armed = false;
+
+            pthread_mutex_unlock(&t->lock);
+            t->callback(t->arg);
+            pthread_mutex_lock(&t->lock);
+        }
+    }
+    pthread_mutex_unlock(&t->lock);
+
+    return NULL;
+}
+
+bool logger_port_timer_create(void (*callback)(void* arg), void* arg, logger_port_timer_t* timer)
+{
+    port_timer* t = (port_timer*)calloc(1, sizeof(*t));
+
+    if(t == NULL)
+    {
+        *timer = NULL;
+        return false;
+    }
+
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->changed, NULL);
+    t->callback = callback;
+    t->arg = arg;
+
+    if(pthread_create(&t->thread, NULL, timer_main, t) != 0)
+    {
+        free(t);
+        *timer = NULL;
+        return false;
+    }
+
+    *timer = t;
+    return true;
+}
+
+bool logger_port_timer_start(logger_port_timer_t timer, uint32_t ms)
+{
+    port_timer* t = (port_timer*)timer;
+
+    // The timer thread only holds the lock while it waits, not while it calls the callback
+    pthread_mutex_lock(&t->lock);
+    deadline_after(ms, &t->deadline);
+    t->armed = true;
+    pthread_cond_signal(&t->changed);
+    pthread_mutex_unlock(&t->lock);
+
+    return true;
+}
+
+void logger_port_timer_delete(logger_port_timer_t timer)
+{
+    port_timer* t = (port_timer*)timer;
+
+    pthread_mutex_lock(&t->lock);
+    t->stopping = true;
+    pthread_cond_signal(&t->changed);
+    pthread_mutex_unlock(&t->lock);
+
+    // Waits for a running callback
+    pthread_join(t->thread, NULL);
+
+    pthread_mutex_destroy(&t->lock);
+    pthread_cond_destroy(&t->changed);
+    free(t);
+}
+
+void logger_port_sleep_ms(uint32_t ms)
+{
+    struct timespec duration = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long)(ms % 1000) * 1000000L
+    };
+
+    nanosleep(&duration, NULL);
+}
+
+int64_t logger_port_time_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
\ No newline at end of file
@@ -0,0 +1,506 @@
+#include "logger_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger_port.h"
+
+#define SECTOR_MAGIC 0x474F4C52u    // "RLOG"
+#define RECORD_ALIGN 4
+#define RECORD_MAX_LEN 0xFFFEu
+#define CRC_CHUNK_SIZE 64
+
+typedef struct sector_header_s
+{
+    uint32_t magic;
+    uint32_t seq;                   // One more than the sequence number of the previous sector
+    uint32_t first_record_seq;      // Sequence number of the first record in the sector
+    uint32_t crc;
+} sector_header_t;
+
+typedef struct record_header_s
+{
+    uint32_t seq;
+    uint16_t len;                   // 0xFFFF when erased
+    uint16_t reserved;
+    uint32_t crc;                   // Of the sequence number, length and data
+} record_header_t;
+
+struct logger_ring_s
+{
+    logger_ring_storage_t storage;
+    logger_port_mutex_t lock;       // Readers run in other tasks than the sink
+    bool empty;                     // No sector has been written
+    size_t head;                    // Sector records are appended to
+    uint32_t head_seq;
+    size_t offset;                  // Of the next record in the head sector
+    uint32_t next_seq;
+};
+
+static uint32_t crc32_update(uint32_t crc, const void* data, size_t len)
+{
+    // Half byte table, small enough for IRAM constrained builds and fast enough for batches
+    static const uint32_t table[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    crc = ~crc;
+    for(size_t i = 0; i < len; i++)
+    {
+        crc = table[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+
+    return ~crc;
+}
+
+static size_t align_up(size_t offset)
+{
+    return (offset + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1);
+}
+
+static size_t sector_offset(logger_ring_t ring, size_t sector)
+{
+    return sector * ring->storage.sector_size;
+}
+
+static bool read_sector_header(logger_ring_t ring, size_t sector, sector_header_t* header)
+{
+    if(!ring->storage.read(ring->storage.context, sector_offset(ring, sector), header, sizeof(*header)))
+    {
+        return false;
+    }
+
+    return header->magic == SECTOR_MAGIC && header->crc == crc32_update(0, header, offsetof(sector_header_t, crc));
+}
+
+static uint32_t record_crc(const record_header_t* header)
+{
+    return crc32_update(0, header, offsetof(record_header_t, reserved));
+}
+
+// Reads the record at the offset into the buffer, or only checks it when buffer is NULL. Returns
+// false when there is no complete record at the offset.
+static bool read_record(logger_ring_t ring, size_t sector, size_t offset, record_header_t* header, char* buffer, size_t size)
+{
+    size_t sectorSize = ring->storage.sector_size;
+    size_t address = sector_offset(ring, sector) + offset;
+
+    if(offset + sizeof(*header) > sectorSize || !ring->storage.read(ring->storage.context, address, header, sizeof(*header)))
+    {
+        return false;
+    }
+
+    if(header->len > RECORD_MAX_LEN || offset + sizeof(*header) + header->len > sectorSize)
+    {
+        return false;
+    }
+
+    uint32_t crc = record_crc(header);
+    size_t copied = 0;
+
+    address += sizeof(*header);
+    if(buffer != NULL)
+    {
+        copied = header->len < size ? header->len : size;
+        if(!ring->storage.read(ring->storage.context, address, buffer, copied))
+        {
+            return false;
+        }
+        crc = crc32_update(crc, buffer, copied);
+    }
+
+    // The rest of the data only has to be checked
+    char chunk[CRC_CHUNK_SIZE];
+    for(size_t done = copied; done < header->len;)
+    {
+        size_t n = header->len - done < sizeof(chunk) ? header->len - done : sizeof(chunk);
+        if(!ring->storage.read(ring->storage.context, address + done, chunk, n))
+        {
+            return false;
+        }
+        crc = crc32_update(crc, chunk, n);
+        done += n;
+    }
+
+    return crc == header->crc;
+}
+
+// Sector i belongs to the ring that ends in the head sector when its sequence number matches its
+// distance to the head
+static bool sector_in_ring(logger_ring_t ring, size_t sector, sector_header_t* header)
+{
+    size_t count = ring->storage.sector_count;
+    uint32_t distance = (uint32_t)((ring->head + count - sector) % count);
+
+    return read_sector_header(ring, sector, header) && header->seq == ring->head_seq - distance;
+}
+
+// Binary search for the newest sector. Sectors written after sector 0 have consecutive sequence
+// numbers counting up from that of sector 0, older and erased sectors do not.
+static bool find_head(logger_ring_t ring, sector_header_t* header)
+{
+    size_t count = ring->storage.sector_count;
+    sector_header_t first;
+
+    if(!read_sector_header(ring, 0, &first))
+    {
+        // Sector 0 is erased in a new ring, and when erasing it to wrap around was interrupted
+        if(read_sector_header(ring, count - 1, header))
+        {
+            ring->head = count - 1;
+            ring->head_seq = header->seq;
+            return true;
+        }
+        return false;
+    }
+
+    size_t low = 0;
+    size_t high = count - 1;
+    *header = first;
+
+    while(low < high)
+    {
+        size_t mid = low + (high - low + 1) / 2;
+        sector_header_t candidate;
+
+        if(read_sector_header(ring, mid, &candidate) && candidate.seq == first.seq + (uint32_t)mid)
+        {
+            low = mid;
+            *header = candidate;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    ring->head = low;
+    ring->head_seq = header->seq;
+    return true;
+}
+
+static void recover(logger_ring_t ring)
+{
+    sector_header_t header;
+
+    ring->empty = !find_head(ring, &header);
+    if(ring->empty)
+    {
+        ring->head = 0;
+        ring->head_seq = 0;
+        ring->offset = 0;
+        ring->next_seq = 0;
+        return;
+    }
+
+    // Only the head sector is scanned
+    record_header_t record;
+    size_t offset = sizeof(sector_header_t);
+
+    ring->next_seq = header.first_record_seq;
+    while(read_record(ring, ring->head, offset, &record, NULL, 0))
+    {
+        ring->next_seq = record.seq + 1;
+        offset = align_up(offset + sizeof(record) + record.len);
+    }
+
+    if(offset + sizeof(record) <= ring->storage.sector_size &&
+       ring->storage.read(ring->storage.context, sector_offset(ring, ring->head) + offset, &record, sizeof(record)) &&
+       (record.seq != 0xFFFFFFFFu || record.len != 0xFFFF))
+    {
+        // The last record was interrupted, its bytes cannot be written again until the sector is erased
+        offset = ring->storage.sector_size;
+    }
+
+    ring->offset = offset;
+}
+
+// Must be called with the lock held
+static bool start_sector(logger_ring_t ring)
+{
+    size_t next = ring->empty ? 0 : (ring->head + 1) % ring->storage.sector_count;
+    sector_header_t header =
+    {
+        .magic = SECTOR_MAGIC,
+        .seq = ring->head_seq + 1,
+        .first_record_seq = ring->next_seq,
+    };
+
+    header.crc = crc32_update(0, &header, offsetof(sector_header_t, crc));
+
+    if(!ring->storage.erase(ring->storage.context, sector_offset(ring, next), ring->storage.sector_size) ||
+       !ring->storage.write(ring->storage.context, sector_offset(ring, next), &header, sizeof(header)))
+    {
+        return false;
+    }
+
+    ring->empty = false;
+    ring->head = next;
+    ring->head_seq = header.seq;
+    ring->offset = sizeof(header);
+    return true;
+}
+
+logger_ring_t logger_ring_open(const logger_ring_storage_t* storage)
+{
+    if(storage->sector_count < 2 || storage->sector_size % RECORD_ALIGN != 0 ||
+       storage->sector_size < sizeof(sector_header_t) + sizeof(record_header_t) + RECORD_ALIGN)
+    {
+        return NULL;
+    }
+
+    logger_ring_t ring = (logger_ring_t)malloc(sizeof(*ring));
+
+    if(ring == NULL)
+    {
+        return NULL;
+    }
+
+    ring->storage = *storage;
+
+    if(!logger_port_mutex_create(&ring->lock))
+    {
+        free(ring);
+        return NULL;
+    }
+
+    recover(ring);
+    return ring;
+}
+
+void logger_ring_close(logger_ring_t ring)
+{
+    if(ring == NULL)
+    {
+        return;
+    }
+
+    if(ring->storage.close != NULL)
+    {
+        ring->storage.close(ring->storage.context);
+    }
+
+    logger_port_mutex_delete(ring->lock);
+    free(ring);
+}
+
+void logger_ring_clear(logger_ring_t ring)
+{
+    logger_port_mutex_lock(ring->lock);
+
+    // Erasing the newest sector last keeps the ring consistent if this is interrupted
+    for(size_t i = 1; i <= ring->storage.sector_count; i++)
+    {
+        size_t sector = (ring->head + i) % ring->storage.sector_count;
+        ring->storage.erase(ring->storage.context, sector_offset(ring, sector), ring->storage.sector_size);
+    }
+
+    // Sequence numbers keep counting so readers notice
+    ring->empty = true;
+    ring->head = 0;
+    ring->offset = 0;
+
+    logger_port_mutex_unlock(ring->lock);
+}
+
+bool logger_ring_append(logger_ring_t ring, const char* data, size_t len)
+{
+    size_t sectorSize = ring->storage.sector_size;
+    bool ok = true;
+
+    logger_port_mutex_lock(ring->lock);
+
+    while(len > 0)
+    {
+        if(ring->empty || ring->offset + sizeof(record_header_t) >= sectorSize)
+        {
+            if(!start_sector(ring))
+            {
+                ok = false;
+                break;
+            }
+        }
+
+        size_t room = sectorSize - ring->offset - sizeof(record_header_t);
+        size_t chunk = len;
+
+        if(room > RECORD_MAX_LEN)
+        {
+            room = RECORD_MAX_LEN;
+        }
+
+        // Batches that do not fit are split after a message, data without messages goes to the
+        // next sector, and is only split when it does not fit in a sector at all
+        if(chunk > room)
+        {
+            chunk = room;
+            while(chunk > 0 && data[chunk - 1] != '\n')
+            {
+                chunk--;
+            }
+
+            if(chunk == 0)
+            {
+                if(ring->offset > sizeof(sector_header_t))
+                {
+                    ring->offset = sectorSize;
+                    continue;
+                }
+                chunk = room;
+            }
+        }
+
+        record_header_t header =
+        {
+            .seq = ring->next_seq,
+            .len = (uint16_t)chunk,
+            .reserved = 0xFFFF,
+        };
+
+        header.crc = crc32_update(record_crc(&header), data, chunk);
+
+        // The header goes first, an interrupted record then has a header that fails the CRC
+        size_t address = sector_offset(ring, ring->head) + ring->offset;
+        ring->offset = align_up(ring->offset + sizeof(header) + chunk);
+        ring->next_seq++;
+
+        if(!ring->storage.write(ring->storage.context, address, &header, sizeof(header)) ||
+           !ring->storage.write(ring->storage.context, address + sizeof(header), data, chunk))
+        {
+            ok = false;
+            break;
+        }
+
+        data += chunk;
+        len -= chunk;
+    }
+
+    logger_port_mutex_unlock(ring->lock);
+
+    return ok;
+}
+
+void logger_ring_write(const char* messages, const size_t len, void* user_data)
+{
+    logger_ring_append((logger_ring_t)user_data, messages, len);
+}
+
+uint32_t logger_ring_next_seq(logger_ring_t ring)
+{
+    logger_port_mutex_lock(ring->lock);
+    uint32_t seq = ring->next_seq;
+    logger_port_mutex_unlock(ring->lock);
+
+    return seq;
+}
+
+// Must be called with the lock held
+static void cursor_init_locked(logger_ring_t ring, logger_ring_cursor_t* cursor)
+{
+    size_t count = ring->storage.sector_count;
+    sector_header_t header;
+
+    cursor->offset = sizeof(sector_header_t);
+    cursor->seq = ring->next_seq;
+
+    if(ring->empty)
+    {
+        // Nothing to read until the first sector is written
+        cursor->sector = 0;
+        cursor->sector_seq = 0;
+        cursor->offset = 0;
+        return;
+    }
+
+    // The sector after the head is the oldest when the ring has wrapped around, unless it is being
+    // erased. Before that the ring starts at sector 0.
+    size_t candidates[] = { (ring->head + 1) % count, (ring->head + 2) % count, 0 };
+
+    for(size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++)
+    {
+        if(sector_in_ring(ring, candidates[i], &header))
+        {
+            cursor->sector = candidates[i];
+            cursor->sector_seq = header.seq;
+            cursor->seq = header.first_record_seq;
+            return;
+        }
+    }
+
+    cursor->sector = ring->head;
+    cursor->sector_seq = ring->head_seq;
+}
+
+void logger_ring_cursor_init(logger_ring_t ring, logger_ring_cursor_t* cursor)
+{
+    logger_port_mutex_lock(ring->lock);
+    cursor_init_locked(ring, cursor);
+    logger_port_mutex_unlock(ring->lock);
+}
+
+bool logger_ring_read(logger_ring_t ring, logger_ring_cursor_t* cursor, char* buffer, size_t size, size_t* len)
+{
+    bool found = false;
+    bool restarted = false;
+
+    logger_port_mutex_lock(ring->lock);
+
+    while(!ring->empty)
+    {
+        sector_header_t header;
+
+        if(cursor->offset == 0 || !read_sector_header(ring, cursor->sector, &header) || header.seq != cursor->sector_seq)
+        {
+            // The ring was empty, or the sector was overwritten or cleared since the last read
+            if(restarted)
+            {
+                break;
+            }
+            cursor_init_locked(ring, cursor);
+            restarted = true;
+            continue;
+        }
+
+        bool isHead = cursor->sector == ring->head;
+        if(isHead && cursor->offset >= ring->offset)
+        {
+            break;
+        }
+
+        record_header_t record;
+        if(read_record(ring, cursor->sector, cursor->offset, &record, buffer, size))
+        {
+            cursor->offset = align_up(cursor->offset + sizeof(record) + record.len);
+            cursor->seq = record.seq + 1;
+            *len = record.len < size ? record.len : size;
+            found = true;
+            break;
+        }
+
+        if(isHead)
+        {
+            break;
+        }
+
+        // End of the sector, or a record that was interrupted by a reset
+        size_t next = (cursor->sector + 1) % ring->storage.sector_count;
+        if(!read_sector_header(ring, next, &header) || header.seq != cursor->sector_seq + 1)
+        {
+            break;
+        }
+
+        cursor->sector = next;
+        cursor->sector_seq = header.seq;
+        cursor->offset = sizeof(sector_header_t);
+        cursor->seq = header.first_record_seq;
+    }
+
+    logger_port_mutex_unlock(ring->lock);
+
+    return found;
+}
\ No newline at end of file
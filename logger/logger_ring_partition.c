@@ -0,0 +1,39 @@
+#include "logger_ring.h"
+
+#include <esp_partition.h>
+#include <esp_spi_flash.h>
+
+static bool partition_read(void* context, size_t offset, void* data, size_t len)
+{
+    return esp_partition_read((const esp_partition_t*)context, offset, data, len) == ESP_OK;
+}
+
+static bool partition_write(void* context, size_t offset, const void* data, size_t len)
+{
+    return esp_partition_write((const esp_partition_t*)context, offset, data, len) == ESP_OK;
+}
+
+static bool partition_erase(void* context, size_t offset, size_t len)
+{
+    return esp_partition_erase_range((const esp_partition_t*)context, offset, len) == ESP_OK;
+}
+
+bool logger_ring_storage_partition(logger_ring_storage_t* storage, const char* label)
+{
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+
+    // Records are written unaligned, which encrypted partitions do not allow
+    if(partition == NULL || partition->encrypted)
+    {
+        return false;
+    }
+
+    storage->sector_size = SPI_FLASH_SEC_SIZE;
+    storage->sector_count = partition->size / SPI_FLASH_SEC_SIZE;
+    storage->context = (void*)partition;
+    storage->read = partition_read;
+    storage->write = partition_write;
+    storage->erase = partition_erase;
+    storage->close = NULL;
+    return true;
+}
\ No newline at end of file
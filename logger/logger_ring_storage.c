@@ -0,0 +1,119 @@
+#include "logger_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_CHUNK_SIZE 256
+
+static bool memory_read(void* context, size_t offset, void* data, size_t len)
+{
+    memcpy(data, (const uint8_t*)context + offset, len);
+    return true;
+}
+
+static bool memory_write(void* context, size_t offset, const void* data, size_t len)
+{
+    memcpy((uint8_t*)context + offset, data, len);
+    return true;
+}
+
+static bool memory_erase(void* context, size_t offset, size_t len)
+{
+    memset((uint8_t*)context + offset, 0xFF, len);
+    return true;
+}
+
+void logger_ring_storage_memory(logger_ring_storage_t* storage, void* memory, size_t sector_size, size_t sector_count)
+{
+    storage->sector_size = sector_size;
+    storage->sector_count = sector_count;
+    storage->context = memory;
+    storage->read = memory_read;
+    storage->write = memory_write;
+    storage->erase = memory_erase;
+    storage->close = NULL;
+}
+
+static bool file_read(void* context, size_t offset, void* data, size_t len)
+{
+    FILE* file = (FILE*)context;
+
+    return fseek(file, (long)offset, SEEK_SET) == 0 && fread(data, 1, len, file) == len;
+}
+
+static bool file_write(void* context, size_t offset, const void* data, size_t len)
+{
+    FILE* file = (FILE*)context;
+
+    // Flushed right away, the point of the ring is to keep what was written before a crash
+    return fseek(file, (long)offset, SEEK_SET) == 0 && fwrite(data, 1, len, file) == len && fflush(file) == 0;
+}
+
+static bool file_fill(FILE* file, size_t len)
+{
+    uint8_t chunk[FILE_CHUNK_SIZE];
+
+    memset(chunk, 0xFF, sizeof(chunk));
+    while(len > 0)
+    {
+        size_t n = len < sizeof(chunk) ? len : sizeof(chunk);
+        if(fwrite(chunk, 1, n, file) != n)
+        {
+            return false;
+        }
+        len -= n;
+    }
+
+    return fflush(file) == 0;
+}
+
+static bool file_erase(void* context, size_t offset, size_t len)
+{
+    FILE* file = (FILE*)context;
+
+    return fseek(file, (long)offset, SEEK_SET) == 0 && file_fill(file, len);
+}
+
+static void file_close(void* context)
+{
+    fclose((FILE*)context);
+}
+
+bool logger_ring_storage_file(logger_ring_storage_t* storage, const char* path, size_t sector_size, size_t sector_count)
+{
+    FILE* file = fopen(path, "r+b");
+
+    if(file == NULL)
+    {
+        file = fopen(path, "w+b");
+        if(file == NULL)
+        {
+            return false;
+        }
+    }
+
+    // A new or shorter file is extended with erased sectors
+    size_t size = sector_size * sector_count;
+    if(fseek(file, 0, SEEK_END) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    long end = ftell(file);
+    if(end < 0 || ((size_t)end < size && !file_fill(file, size - (size_t)end)))
+    {
+        fclose(file);
+        return false;
+    }
+
+    storage->sector_size = sector_size;
+    storage->sector_count = sector_count;
+    storage->context = file;
+    storage->read = file_read;
+    storage->write = file_write;
+    storage->erase = file_erase;
+    storage->close = file_close;
+    return true;
+}
\ No newline at end of file
@@ -5,23 +5,602 @@
 #include <string.h>
 #include <time.h>
 
+#include <stdatomic.h>
+
 #include <sdkconfig.h>
-#include <slist.h>
+#include <mpmcq.h>
+
+#include "logger_clock.h"
+#include "logger_encode.h"
+#include "logger_format.h"
+#include "logger_level.h"
+#include "logger_limit.h"
+#include "logger_metrics.h"
+#include "logger_sinks.h"
+#include "logger_timestamp.h"
+#include "logger_work.h"
+#include "logger_port.h"
+
+// Asynchronous logging, the queue is NULL when logging synchronously
+#ifdef CONFIG_LOGGER_SERVICE_BINARY
+// Records hold the format and raw arguments, the drain task formats them
+typedef logger_service_record_t log_record;
+#define LOG_RECORD_SIZE (sizeof(log_record) + CONFIG_LOGGER_SERVICE_BINARY_ARGS_SIZE)
+#else
+// Records hold a message encoded for the sinks of one encoding
+typedef struct log_record_s
+{
+    size_t len;
+    logger_service_encoding_t encoding;
+    char message[];
+} log_record;
+#define LOG_RECORD_SIZE (sizeof(log_record) + CONFIG_LOGGER_SERVICE_MESSAGE_SIZE)
+#endif
+
+static mpmcq queue = NULL;
+static logger_port_task_t drainTask = NULL;
+static atomic_uint overflowPolicy = LOGGER_SERVICE_OVERFLOW_DROP_NEWEST;
+static atomic_size_t pendingCount;   // Queued messages not yet delivered or discarded
+static atomic_uint_least32_t queuedCount;
+static atomic_uint_least32_t droppedCount;
+static atomic_uint_least32_t overwrittenCount;
+static atomic_bool drainIdle;         // The drain task found the queue empty and waits for a notification
+static atomic_uint blockedCount;      // Tasks waiting for room in the queue
+static logger_port_sem_t spaceAvailable = NULL;
+
+// Synchronous logging formats into preallocated buffers, claimed with a bit per buffer
+#define FORMAT_BUFFERS_MASK (UINT32_MAX >> (32 - CONFIG_LOGGER_SERVICE_FORMAT_BUFFERS))
+
+static char formatBuffers[CONFIG_LOGGER_SERVICE_FORMAT_BUFFERS][CONFIG_LOGGER_SERVICE_MESSAGE_SIZE];
+static atomic_uint_least32_t formatBuffersInUse;
+
+// The processor clock is only part of the timestamp while the time is not set
+static clock_t timestamp_clock(time_t now)
+{
+    return logger_timestamp_time_is_set(now) ? 0 : logger_clock_ticks();
+}
+
+static logger_encode_message_t new_message(logger_encode_source_t source, logger_service_loglevel_t level, const char* tag, const char* format)
+{
+    time_t now = logger_clock_time();
+    logger_encode_message_t message =
+    {
+        .source = source,
+        .level = level,
+        .tag = tag,
+        .time = now,
+        .clock = timestamp_clock(now),
+        .format = format,
+    };
+
+    return message;
+}
+
+static logger_encode_message_t record_message(const logger_service_record_t* record)
+{
+    logger_encode_message_t message =
+    {
+        .source = record->structured ? LOGGER_ENCODE_CBOR_FIELDS : LOGGER_ENCODE_ARGS,
+        .level = (logger_service_loglevel_t)record->level,
+        .tag = record->tag,
+        .time = (time_t)record->time,
+        .clock = (clock_t)record->clock,
+        .format = record->format,
+        .args = record->args,
+        .args_len = record->args_len,
+    };
+
+    return message;
+}
+
+// Encodes a message for the sinks of an encoding, returns the length to deliver or 0 if there is
+// nothing to deliver. Text is truncated, other encodings that do not fit are dropped.
+static size_t encode_message(logger_service_encoding_t encoding, const logger_encode_message_t* message, char* buffer, int* result)
+{
+    size_t len = logger_encode(encoding, message, buffer, CONFIG_LOGGER_SERVICE_MESSAGE_SIZE);
+
+    if(encoding == LOGGER_SERVICE_ENCODING_TEXT)
+    {
+        *result = (int)len;
+        return len < CONFIG_LOGGER_SERVICE_MESSAGE_SIZE ? len : CONFIG_LOGGER_SERVICE_MESSAGE_SIZE - 1;
+    }
+
+    if(len >= CONFIG_LOGGER_SERVICE_MESSAGE_SIZE)
+    {
+        atomic_fetch_add(&droppedCount, 1);
+        return 0;
+    }
+
+    return len;
+}
+
+// Calls the text sinks of the encoding, and its batch sinks with a batch of just this message unless
+// it is collected into a larger batch. Returns true if there are batch sinks.
+static bool deliver(logger_service_encoding_t encoding, const char* message, size_t len, bool batched)
+{
+    bool hasBatchSinks = false;
+
+    unsigned int reader;
+    const sink_set* set = logger_sinks_acquire(&reader);
+    int64_t start = logger_metrics_start();
+
+    // Print to sinks 
+    for(size_t i = 0; set != NULL && i < set->count; i++)
+    {
+        // Call the sink
+        sink_handle_t sink = set->sinks[i];
+        if(sink->encoding != encoding)
+        {
+            continue;
+        }
+
+        if(sink->callback != NULL)
+        {
+            sink->callback(message, len, sink->user_data);
+            start = logger_metrics_sink_call(sink, len, start);
+        }
+        else if(sink->batch_callback != NULL)
+        {
+            hasBatchSinks = true;
+
+            if(!batched)
+            {
+                sink->batch_callback(message, len, sink->user_data);
+                start = logger_metrics_sink_call(sink, len, start);
+            }
+        }
+    }
+
+    logger_sinks_release(reader);
+
+    return hasBatchSinks;
+}
+
+static char* claim_format_buffer(unsigned int* index)
+{
+    uint32_t inUse = atomic_load_explicit(&formatBuffersInUse, memory_order_relaxed);
+
+    for(;;)
+    {
+        uint32_t available = ~inUse & FORMAT_BUFFERS_MASK;
+
+        if(available == 0)
+        {
+            return NULL;
+        }
+
+        unsigned int i = __builtin_ctz(available);
+
+        if(atomic_compare_exchange_weak_explicit(&formatBuffersInUse, &inUse, inUse | (1u << i), memory_order_acquire, memory_order_relaxed))
+        {
+            *index = i;
+            return formatBuffers[i];
+        }
+    }
+}
+
+static void release_format_buffer(unsigned int index)
+{
+    atomic_fetch_and_explicit(&formatBuffersInUse, ~(1u << index), memory_order_release);
+}
+
+static bool discard_oldest(void)
+{
+    log_record* record;
+
+    if(mpmcq_acquire(queue, (void**)&record) != UTIL_OK)
+    {
+        // The oldest message is still being written
+        return false;
+    }
+
+    mpmcq_release(queue, record);
+    atomic_fetch_sub(&pendingCount, 1);
+    atomic_fetch_add(&overwrittenCount, 1);
+
+    return true;
+}
+
+static void wait_for_space(void)
+{
+    atomic_fetch_add(&blockedCount, 1);
+    logger_port_task_notify(drainTask);
+
+    // The drain task may have made room before it saw this task waiting, the timeout covers the rest of that race
+    if(mpmcq_count(queue) >= mpmcq_capacity(queue))
+    {
+        logger_port_sem_take(spaceAvailable, 10);
+    }
+
+    atomic_fetch_sub(&blockedCount, 1);
+}
+
+static bool reserve_record(log_record** record)
+{
+    for(;;)
+    {
+        if(mpmcq_reserve(queue, (void**)record) == UTIL_OK)
+        {
+            atomic_fetch_add(&pendingCount, 1);
+            return true;
+        }
 
-char logger_service_timestamp[20] = "";
+        switch(atomic_load(&overflowPolicy))
+        {
+            case LOGGER_SERVICE_OVERFLOW_DROP_OLDEST:
+                if(discard_oldest())
+                {
+                    continue;
+                }
+                break;
+
+            case LOGGER_SERVICE_OVERFLOW_BLOCK:
+                // Sinks that log would wait for themselves
+                if(!logger_port_task_is_current(drainTask))
+                {
+                    wait_for_space();
+                    continue;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        atomic_fetch_add(&droppedCount, 1);
+        return false;
+    }
+}
+
+static void commit_record(log_record* record)
+{
+    mpmcq_commit(queue, record);
+    atomic_fetch_add(&queuedCount, 1);
+
+    // Only wake the drain task if it is not busy with earlier messages already
+    if(atomic_exchange(&drainIdle, false))
+    {
+        logger_port_task_notify(drainTask);
+    }
+}
+
+static int enqueue(const logger_encode_message_t* message)
+{
+    log_record* record;
+
+#ifdef CONFIG_LOGGER_SERVICE_BINARY
+    if(!reserve_record(&record))
+    {
+        return -1;
+    }
+
+    // Only capture the arguments or fields, the drain task encodes the message
+    record->format = message->format;
+    record->tag = message->tag;
+    record->time = message->time;
+    record->clock = (uint32_t)message->clock;
+    record->level = (uint8_t)message->level;
+    record->structured = message->source == LOGGER_ENCODE_FIELDS;
+
+    if(record->structured)
+    {
+        record->args_len = (uint16_t)logger_encode_capture_fields(record->args, CONFIG_LOGGER_SERVICE_BINARY_ARGS_SIZE, message->fields, message->field_count);
+    }
+    else
+    {
+        record->args_len = (uint16_t)logger_format_capture(record->args, CONFIG_LOGGER_SERVICE_BINARY_ARGS_SIZE, message->format, *message->vlist);
+    }
+
+    commit_record(record);
+    return 0;
+#else
+    unsigned int encodings = logger_sinks_encodings();
+    int result = 0;
+
+    // Encoded straight into the queue, a record for every encoding
+    for(unsigned int encoding = 0; encodings != 0; encoding++, encodings >>= 1)
+    {
+        if((encodings & 1) == 0)
+        {
+            continue;
+        }
+
+        if(!reserve_record(&record))
+        {
+            return -1;
+        }
+
+        record->encoding = (logger_service_encoding_t)encoding;
+        record->len = encode_message(record->encoding, message, record->message, &result);
+        commit_record(record);
+    }
+
+    return result;
+#endif
+}
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+// The drain task collects the messages for the batch sinks until the queue is empty or the batch is full
+static char batch[CONFIG_LOGGER_SERVICE_ASYNC_BATCH_SIZE];
+static size_t batchLen;
+static logger_service_encoding_t batchEncoding;
+static size_t handledCount;   // Messages taken from the queue since the batch was delivered, still pending
+
+static void deliver_batch(logger_service_encoding_t encoding, const char* messages, size_t len)
+{
+    unsigned int reader;
+    const sink_set* set = logger_sinks_acquire(&reader);
+    int64_t start = logger_metrics_start();
+
+    for(size_t i = 0; set != NULL && i < set->count; i++)
+    {
+        sink_handle_t sink = set->sinks[i];
+        if(sink->batch_callback != NULL && sink->encoding == encoding)
+        {
+            sink->batch_callback(messages, len, sink->user_data);
+            start = logger_metrics_sink_call(sink, len, start);
+        }
+    }
+
+    logger_sinks_release(reader);
+}
+
+static void flush_batch(void)
+{
+    if(batchLen > 0)
+    {
+        deliver_batch(batchEncoding, batch, batchLen);
+        batchLen = 0;
+    }
+
+    if(handledCount > 0)
+    {
+        atomic_fetch_sub(&pendingCount, handledCount);
+        handledCount = 0;
+    }
+}
+
+static void deliver_queued(logger_service_encoding_t encoding, const char* message, size_t len)
+{
+    if(!deliver(encoding, message, len, true))
+    {
+        return;
+    }
+
+    // A batch holds messages of one encoding
+    if(len > sizeof(batch) - batchLen || encoding != batchEncoding)
+    {
+        flush_batch();
+        batchEncoding = encoding;
+    }
+
+    if(len > sizeof(batch))
+    {
+        deliver_batch(encoding, message, len);
+        return;
+    }
 
-struct sink_s
+    memcpy(batch + batchLen, message, len);
+    batchLen += len;
+}
+
+#ifdef CONFIG_LOGGER_SERVICE_BINARY
+static void deliver_record(const log_record* record, char* text)
 {
-    logger_sink_t callback;
-    void* user_data;
-};
+    size_t size = sizeof(*record) + record->args_len;
+    bool hasTextSinks = false;
+
+    unsigned int reader;
+    const sink_set* set = logger_sinks_acquire(&reader);
+    int64_t start = logger_metrics_start();
+
+    for(size_t i = 0; set != NULL && i < set->count; i++)
+    {
+        sink_handle_t sink = set->sinks[i];
+        if(sink->binary_callback != NULL)
+        {
+            sink->binary_callback(record, size, sink->user_data);
+            start = logger_metrics_sink_call(sink, size, start);
+        }
+        else
+        {
+            // Text and batch sinks
+            hasTextSinks = true;
+        }
+    }
+
+    logger_sinks_release(reader);
 
-static slist sinks;
+    if(!hasTextSinks)
+    {
+        return;
+    }
+
+    logger_encode_message_t message = record_message(record);
+    unsigned int encodings = logger_sinks_encodings();
+    int result;
+
+    for(unsigned int encoding = 0; encodings != 0; encoding++, encodings >>= 1)
+    {
+        size_t len = (encodings & 1) != 0 ? encode_message((logger_service_encoding_t)encoding, &message, text, &result) : 0;
+
+        if(len > 0)
+        {
+            deliver_queued((logger_service_encoding_t)encoding, text, len);
+        }
+    }
+}
+#endif
+
+static void drain_task(void* arg)
+{
+    // Messages are copied out of the queue, so slow sinks do not keep the queue full
+#ifdef CONFIG_LOGGER_SERVICE_BINARY
+    static uint64_t recordBuffer[(LOG_RECORD_SIZE + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+#endif
+    static char buffer[CONFIG_LOGGER_SERVICE_MESSAGE_SIZE];
+
+    for(;;)
+    {
+        logger_work_run();
+
+        log_record* record;
+        if(mpmcq_acquire(queue, (void**)&record) != UTIL_OK)
+        {
+            flush_batch();
+
+            // Messages committed before the idle flag was set did not notify, so look once more before waiting
+            if(atomic_exchange(&drainIdle, true))
+            {
+                logger_port_task_wait();
+            }
+            continue;
+        }
+
+#ifdef CONFIG_LOGGER_SERVICE_BINARY
+        log_record* copy = (log_record*)recordBuffer;
+        memcpy(copy, record, sizeof(*record) + record->args_len);
+#else
+        size_t len = record->len;
+        logger_service_encoding_t encoding = record->encoding;
+        memcpy(buffer, record->message, len);
+#endif
+        mpmcq_release(queue, record);
+
+        if(atomic_load(&blockedCount) > 0)
+        {
+            logger_port_sem_give(spaceAvailable);
+        }
+
+#ifdef CONFIG_LOGGER_SERVICE_BINARY
+        deliver_record(copy, buffer);
+#else
+        if(len > 0)
+        {
+            deliver_queued(encoding, buffer, len);
+        }
+#endif
+
+        handledCount++;
+    }
+}
+
+static void start_async(void)
+{
+#if defined(CONFIG_LOGGER_SERVICE_ASYNC_OVERFLOW_DROP_OLDEST)
+    atomic_store(&overflowPolicy, LOGGER_SERVICE_OVERFLOW_DROP_OLDEST);
+#elif defined(CONFIG_LOGGER_SERVICE_ASYNC_OVERFLOW_BLOCK)
+    atomic_store(&overflowPolicy, LOGGER_SERVICE_OVERFLOW_BLOCK);
+#endif
+
+    if(!logger_port_sem_create(&spaceAvailable))
+    {
+        // Keep logging synchronously
+        return;
+    }
+
+    mpmcq newQueue;
+    if(mpmcq_new(LOG_RECORD_SIZE, CONFIG_LOGGER_SERVICE_ASYNC_QUEUE_LENGTH, &newQueue) != UTIL_OK)
+    {
+        // Keep logging synchronously
+        return;
+    }
+
+    // The task only reads the queue after it has been notified, which happens after it is published below
+    queue = newQueue;
+
+    if(!logger_port_task_start(drain_task, NULL, "logger", CONFIG_LOGGER_SERVICE_ASYNC_TASK_STACK_SIZE, CONFIG_LOGGER_SERVICE_ASYNC_TASK_PRIORITY, &drainTask))
+    {
+        queue = NULL;
+        mpmcq_delete(newQueue);
+    }
+}
+#endif
+
+static int log_message(const logger_encode_message_t* message)
+{
+    if(queue != NULL)
+    {
+        return enqueue(message);
+    }
+
+    // Without a drain task, work posted by timers runs on the tasks that log
+    logger_work_run();
+
+    unsigned int index;
+    char* str = claim_format_buffer(&index);
+
+    if(str == NULL)
+    {
+        // More tasks are logging at the same time than there are buffers
+        atomic_fetch_add(&droppedCount, 1);
+        return -1;
+    }
+
+    // Encode the message once for every encoding the sinks use
+    unsigned int encodings = logger_sinks_encodings();
+    int result = 0;
+
+    for(unsigned int encoding = 0; encodings != 0; encoding++, encodings >>= 1)
+    {
+        size_t len = (encodings & 1) != 0 ? encode_message((logger_service_encoding_t)encoding, message, str, &result) : 0;
+
+        if(len > 0)
+        {
+            deliver((logger_service_encoding_t)encoding, str, len, false);
+        }
+    }
+    
+    release_format_buffer(index);
+
+    return result;
+}
+
+static int log_tagged(logger_service_loglevel_t level, const char* tag, const char* format, va_list vlist)
+{
+    va_list copy;
+    va_copy(copy, vlist);
+    logger_encode_message_t message = new_message(LOGGER_ENCODE_VLIST, level, tag, format);
+    message.vlist = &copy;
+    int len = log_message(&message);
+    va_end(copy);
+
+    return len;
+}
+
+static void log_report(logger_service_loglevel_t level, const char* tag, const char* format, ...)
+{
+    va_list list;
+    va_start(list, format);
+    log_tagged(level, tag, format, list);
+    va_end(list);
+}
+
+// Work posted by timers runs on the drain task when logging asynchronously
+static void wake_drain_task(void)
+{
+    logger_port_task_notify(drainTask);
+}
+
+// Messages of a call site are counted as repeats even when their arguments differ, so the format is included
+static void report_suppressed(logger_service_loglevel_t level, const char* tag, const char* format, unsigned int count)
+{
+    log_report(level, tag, "last message repeated %u times: \"%s\"", count, format);
+}
 
 void logger_service_init(void)
 {
     // ESP_LOGI("logger", "Initializing Logger");
-    slist_new(&sinks);
+    logger_sinks_init();
+    logger_level_init();
+
+#ifdef CONFIG_LOGGER_SERVICE_ASYNC
+    start_async();
+#endif
+
+    // Without the drain task the work gets a task of its own
+    logger_work_init(drainTask != NULL ? wake_drain_task : NULL);
+    logger_limit_init(report_suppressed);
 }
 
 int logger_service_log(logger_service_loglevel_t level, const char* format, ...)
@@ -36,69 +615,150 @@ int logger_service_log(logger_service_loglevel_t level, const char* format, ...)
 
 int logger_service_vlog(logger_service_loglevel_t level, const char* format, va_list vlist)
 {
-    if(level > CONFIG_LOG_DEFAULT_LEVEL)
+    if(logger_sinks_empty())
+    {
+        // Nobody is listening, skip the timestamp and formatting
+        return 0;
+    }
+
+    logger_level_tag_t entry;
+    if(!logger_level_enabled(level, NULL, &entry))
     {
         // Don't log current level
         return 0;
     }
 
-    char* str = (char*) calloc(512, sizeof(char));
+    logger_metrics_message(level, entry);
 
-    if(str == NULL)
+    logger_encode_message_t message = new_message(LOGGER_ENCODE_VLIST, level, NULL, format);
+
+    va_list copy;
+    va_copy(copy, vlist);
+    message.vlist = &copy;
+    int len = log_message(&message);
+    va_end(copy);
+
+    return len;
+}
+
+int logger_service_log_tagged(logger_service_loglevel_t level, const char* tag, const char* format, ...)
+{
+    va_list list;
+    va_start(list, format);
+    int len = logger_service_vlog_tagged(level, tag, format, list);
+    va_end(list);
+
+    return len;
+}
+
+int logger_service_vlog_tagged(logger_service_loglevel_t level, const char* tag, const char* format, va_list vlist)
+{
+    if(logger_sinks_empty())
     {
-        // ESP_LOGW("Logger", "Could not allocate memory for writing to logger service sinks");
-        return -1;
+        // Nobody is listening, skip formatting
+        return 0;
     }
 
-    // Update timestamp so it has the correct value if it is present in vlist
-    time_t now;
-    struct tm timeinfo;
-    time(&now);
-    localtime_r(&now, &timeinfo);
+    logger_level_tag_t entry;
+    if(!logger_level_enabled(level, tag, &entry))
+    {
+        // Don't log current level
+        return 0;
+    }
 
-    if(now != (time_t)(-1) && timeinfo.tm_year >= (2020 - 1900))
+    if(!logger_limit_allow(level, tag, format))
     {
-        // Time is properly set, print it
-        strftime(logger_service_timestamp, 20, "%F %T", gmtime(&now));
+        // Counted and reported by the rate limit
+        return 0;
     }
-    else
+
+    logger_metrics_message(level, entry);
+
+    return log_tagged(level, tag, format, vlist);
+}
+
+int logger_service_log_fields(logger_service_loglevel_t level, const char* tag, const char* message, const logger_service_field_t* fields, size_t count)
+{
+    if(logger_sinks_empty())
     {
-        // Time is not properly set, print the clock
-        snprintf(logger_service_timestamp, 20, "%li", clock());
+        // Nobody is listening, skip encoding
+        return 0;
     }
 
-    // Format string
-    int len = vsnprintf(str, 512, format, vlist);
+    logger_level_tag_t entry;
+    if(!logger_level_enabled(level, tag, &entry))
+    {
+        // Don't log current level
+        return 0;
+    }
 
-    // Print to sinks 
-    sink_handle_t sink;
-    slist_iter sinksIter;
-    if(slist_iter_new(sinks, &sinksIter) != UTIL_ERR_ALLOC)
+    if(!logger_limit_allow(level, tag, message))
     {
-        while(slist_iter_next(sinksIter, (void**)(&sink)) != UTIL_ITER_END)
-        {
-            // Call the sink
-            if(sink != NULL)
-            {
-                sink->callback(str, len, sink->user_data);
-            }
-        }
-        
-        slist_iter_delete(sinksIter);
+        // Counted and reported by the rate limit
+        return 0;
     }
-    else
+
+    logger_metrics_message(level, entry);
+
+    logger_encode_message_t structured = new_message(LOGGER_ENCODE_FIELDS, level, tag, message);
+    structured.fields = fields;
+    structured.field_count = count;
+
+    return log_message(&structured);
+}
+
+int logger_service_format_record(const logger_service_record_t* record, char* buffer, size_t size)
+{
+    return logger_service_encode_record(record, LOGGER_SERVICE_ENCODING_TEXT, buffer, size);
+}
+
+int logger_service_encode_record(const logger_service_record_t* record, logger_service_encoding_t encoding, char* buffer, size_t size)
+{
+    logger_encode_message_t message = record_message(record);
+    return (int)logger_encode(encoding, &message, buffer, size);
+}
+
+logger_service_loglevel_t logger_service_message_level(const char* message, size_t len)
+{
+    return logger_encode_text_level(message, len);
+}
+
+void logger_service_set_overflow_policy(logger_service_overflow_policy_t policy)
+{
+    atomic_store(&overflowPolicy, policy);
+}
+
+void logger_service_get_stats(logger_service_stats_t* stats)
+{
+    stats->queued = atomic_load(&queuedCount);
+    stats->dropped = atomic_load(&droppedCount);
+    stats->overwritten = atomic_load(&overwrittenCount);
+    stats->suppressed = logger_limit_suppressed();
+}
+
+void logger_service_flush(void)
+{
+    if(queue == NULL || logger_port_task_is_current(drainTask))
     {
-        // ESP_LOGW("Logger", "Could not allocate memory for itterating logger service sinks");
+        return;
     }
-    
-    free(str);
 
-    return len;
+    while(atomic_load(&pendingCount) > 0)
+    {
+        logger_port_task_notify(drainTask);
+        logger_port_sleep_ms(1);
+    }
 }
 
-sink_handle_t logger_service_register_sink(logger_sink_t callback, void* user_data)
+static sink_handle_t add_sink(logger_sink_t callback, logger_binary_sink_t binary_callback, logger_batch_sink_t batch_callback, logger_service_encoding_t encoding, void* user_data)
 {
-    sink_handle_t newSink = (sink_handle_t)malloc(sizeof(*newSink));
+    if(encoding >= LOGGER_SERVICE_ENCODINGS)
+    {
+        return NULL;
+    }
+
+    // Zeroed, which also clears the metrics
+    sink_handle_t newSink = (sink_handle_t)calloc(1, sizeof(*newSink));
 
     if(newSink == NULL)
     {
@@ -107,14 +767,63 @@ sink_handle_t logger_service_register_sink(logger_sink_t callback, void* user_da
     }
 
     newSink->callback = callback;
+    newSink->binary_callback = binary_callback;
+    newSink->batch_callback = batch_callback;
     newSink->user_data = user_data;
+    newSink->encoding = encoding;
 
-    slist_add(sinks, (void*)newSink);
+    if(!logger_sinks_add(newSink))
+    {
+        free(newSink);
+        return NULL;
+    }
 
     return newSink;
 }
 
+sink_handle_t logger_service_register_sink(logger_sink_t callback, void* user_data)
+{
+    return add_sink(callback, NULL, NULL, LOGGER_SERVICE_ENCODING_TEXT, user_data);
+}
+
+sink_handle_t logger_service_register_binary_sink(logger_binary_sink_t callback, void* user_data)
+{
+    return add_sink(NULL, callback, NULL, LOGGER_SERVICE_ENCODING_TEXT, user_data);
+}
+
+sink_handle_t logger_service_register_batch_sink(logger_batch_sink_t callback, void* user_data)
+{
+    return add_sink(NULL, NULL, callback, LOGGER_SERVICE_ENCODING_TEXT, user_data);
+}
+
+sink_handle_t logger_service_register_encoded_sink(logger_service_encoding_t encoding, logger_sink_t callback, void* user_data)
+{
+    return add_sink(callback, NULL, NULL, encoding, user_data);
+}
+
+sink_handle_t logger_service_register_encoded_batch_sink(logger_service_encoding_t encoding, logger_batch_sink_t callback, void* user_data)
+{
+    return add_sink(NULL, NULL, callback, encoding, user_data);
+}
+
+void logger_service_set_sink_name(sink_handle_t handle, const char* name)
+{
+    if(handle != NULL)
+    {
+        handle->name = name;
+    }
+}
+
 void logger_service_unregister_sink(sink_handle_t handle)
 {
-    slist_remove(sinks, (void*)handle);
+    if(handle == NULL)
+    {
+        return;
+    }
+
+    // Waits until log calls in other tasks are done with the sink
+    if(logger_sinks_remove(handle))
+    {
+        free(handle);
+    }
 }
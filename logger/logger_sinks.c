@@ -0,0 +1,179 @@
+#include "logger_sinks.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger_port.h"
+
+static _Atomic(sink_set*) current = NULL;
+static atomic_uint epoch;
+static atomic_uint readers[2];              // Readers that entered in an even or odd epoch
+static logger_port_mutex_t lock = NULL;     // Serializes writers
+static atomic_uint encodings;               // Of the current set, only a hint for what to encode
+
+static unsigned int encodings_of(const sink_set* set)
+{
+    unsigned int mask = 0;
+
+    for(size_t i = 0; set != NULL && i < set->count; i++)
+    {
+        if(set->sinks[i]->binary_callback == NULL)
+        {
+            mask |= 1u << set->sinks[i]->encoding;
+        }
+    }
+
+    return mask;
+}
+
+static sink_set* new_set(size_t count)
+{
+    return (sink_set*)malloc(sizeof(sink_set) + count * sizeof(sink_handle_t));
+}
+
+// Must be called with the lock held
+static void synchronize(void)
+{
+    // Readers that enter from now on count in the other counter and see the published set
+    unsigned int previous = atomic_fetch_add(&epoch, 1) & 1;
+
+    while(atomic_load(&readers[previous]) != 0)
+    {
+        logger_port_sleep_ms(1);
+    }
+}
+
+// Must be called with the lock held
+static void publish(sink_set* set)
+{
+    sink_set* old = atomic_exchange(&current, set);
+    atomic_store(&encodings, encodings_of(set));
+
+    synchronize();
+    free(old);
+}
+
+void logger_sinks_init(void)
+{
+    if(lock == NULL)
+    {
+        logger_port_mutex_create(&lock);
+    }
+}
+
+bool logger_sinks_empty(void)
+{
+    return atomic_load_explicit(&current, memory_order_relaxed) == NULL;
+}
+
+unsigned int logger_sinks_encodings(void)
+{
+    return atomic_load_explicit(&encodings, memory_order_relaxed);
+}
+
+const sink_set* logger_sinks_acquire(unsigned int* reader)
+{
+    for(;;)
+    {
+        unsigned int e = atomic_load(&epoch) & 1;
+        atomic_fetch_add(&readers[e], 1);
+
+        // A writer flipped the epoch in between and may not wait for this counter anymore
+        if((atomic_load(&epoch) & 1) == e)
+        {
+            *reader = e;
+            return atomic_load(&current);
+        }
+
+        atomic_fetch_sub(&readers[e], 1);
+    }
+}
+
+void logger_sinks_release(unsigned int reader)
+{
+    atomic_fetch_sub(&readers[reader], 1);
+}
+
+bool logger_sinks_add(sink_handle_t sink)
+{
+    if(lock == NULL)
+    {
+        return false;
+    }
+
+    logger_port_mutex_lock(lock);
+
+    sink_set* old = atomic_load(&current);
+    size_t count = old != NULL ? old->count : 0;
+    sink_set* set = new_set(count + 1);
+
+    if(set != NULL)
+    {
+        if(old != NULL)
+        {
+            memcpy(set->sinks, old->sinks, count * sizeof(sink_handle_t));
+        }
+
+        set->sinks[count] = sink;
+        set->count = count + 1;
+
+        publish(set);
+    }
+
+    logger_port_mutex_unlock(lock);
+
+    return set != NULL;
+}
+
+bool logger_sinks_remove(sink_handle_t sink)
+{
+    if(lock == NULL)
+    {
+        return false;
+    }
+
+    logger_port_mutex_lock(lock);
+
+    sink_set* old = atomic_load(&current);
+    size_t count = old != NULL ? old->count : 0;
+    size_t index = 0;
+
+    while(index < count && old->sinks[index] != sink)
+    {
+        index++;
+    }
+
+    if(index < count)
+    {
+        sink_set* set = count > 1 ? new_set(count - 1) : NULL;
+
+        if(set != NULL || count == 1)
+        {
+            if(set != NULL)
+            {
+                memcpy(set->sinks, old->sinks, index * sizeof(sink_handle_t));
+                memcpy(set->sinks + index, old->sinks + index + 1, (count - index - 1) * sizeof(sink_handle_t));
+                set->count = count - 1;
+            }
+
+            publish(set);
+        }
+        else
+        {
+            // Out of memory, briefly log to no sinks so the old set can be changed in place
+            atomic_store(&current, NULL);
+            synchronize();
+
+            memmove(old->sinks + index, old->sinks + index + 1, (count - index - 1) * sizeof(sink_handle_t));
+            old->count = count - 1;
+
+            atomic_store(&current, old);
+            atomic_store(&encodings, encodings_of(old));
+        }
+    }
+
+    logger_port_mutex_unlock(lock);
+
+    return index < count;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef LOGGER_SINKS_H
+#define LOGGER_SINKS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "logger_metrics.h"
+#include "logger_service.h"
+
+// Registry of the sinks, read by every log call without taking a lock.
+//
+// The registered sinks are kept in an immutable set that is replaced as a
+// whole when a sink is added or removed (read-copy-update). Readers count
+// themselves in one of two counters, selected by an epoch that writers flip
+// after publishing a new set. A writer then only has to wait until the
+// counter of the previous epoch drops to zero before it can free the previous
+// set, readers that arrive later can only see the new one.
+
+struct sink_s
+{
+    logger_sink_t callback;                 // Only one of the callbacks is set
+    logger_binary_sink_t binary_callback;
+    logger_batch_sink_t batch_callback;
+    void* user_data;
+    logger_service_encoding_t encoding;     // Of the text and batch sinks
+    const char* name;
+    logger_metrics_sink_t metrics;
+};
+
+typedef struct sink_set_s
+{
+    size_t count;
+    sink_handle_t sinks[];
+} sink_set;
+
+void logger_sinks_init(void);
+
+// True if there are no sinks, cheaper than acquiring the set
+bool logger_sinks_empty(void);
+
+// Bit per encoding of the registered text and batch sinks, without acquiring the set
+unsigned int logger_sinks_encodings(void);
+
+// The set stays valid until it is released, NULL if there are no sinks
+const sink_set* logger_sinks_acquire(unsigned int* reader);
+void            logger_sinks_release(unsigned int reader);
+
+// Adding and removing sinks may block, removing waits until no log call uses the sink anymore.
+// Sinks must not remove themselves. Returns false if the sink was not registered.
+bool logger_sinks_add(sink_handle_t sink);
+bool logger_sinks_remove(sink_handle_t sink);
+
+#endif // LOGGER_SINKS_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "logger_timestamp.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+// 2020-01-01 00:00:00 UTC, earlier times mean the clock has not been set
+#define TIME_SET_THRESHOLD ((time_t)1577836800)
+
+// Position of the seconds in "YYYY-MM-DD HH:MM:SS"
+#define SECONDS_OFFSET 17
+
+typedef struct timestamp_cache_s
+{
+    atomic_flag busy;
+    time_t second;      // -1 if nothing is cached yet
+    char text[LOGGER_TIMESTAMP_SIZE];
+} timestamp_cache;
+
+static timestamp_cache cache = { .busy = ATOMIC_FLAG_INIT, .second = -1 };
+
+static void format_time(time_t now, char* timestamp)
+{
+    struct tm timeinfo;
+    gmtime_r(&now, &timeinfo);
+    strftime(timestamp, LOGGER_TIMESTAMP_SIZE, "%F %T", &timeinfo);
+}
+
+bool logger_timestamp_time_is_set(time_t now)
+{
+    return now != (time_t)(-1) && now >= TIME_SET_THRESHOLD;
+}
+
+void logger_timestamp_format(time_t now, clock_t ticks, char* timestamp)
+{
+    if(!logger_timestamp_time_is_set(now))
+    {
+        // Time is not properly set, print the clock
+        snprintf(timestamp, LOGGER_TIMESTAMP_SIZE, "%li", (long)ticks);
+        return;
+    }
+
+    if(atomic_flag_test_and_set_explicit(&cache.busy, memory_order_acquire))
+    {
+        // Another task is using the cache
+        format_time(now, timestamp);
+        return;
+    }
+
+    if(now != cache.second)
+    {
+        // UTC has no leap seconds, so every minute starts at a multiple of 60
+        if(cache.second != -1 && now / 60 == cache.second / 60)
+        {
+            int seconds = (int)(now % 60);
+            cache.text[SECONDS_OFFSET] = (char)('0' + seconds / 10);
+            cache.text[SECONDS_OFFSET + 1] = (char)('0' + seconds % 10);
+        }
+        else
+        {
+            format_time(now, cache.text);
+        }
+
+        cache.second = now;
+    }
+
+    memcpy(timestamp, cache.text, LOGGER_TIMESTAMP_SIZE);
+
+    atomic_flag_clear_explicit(&cache.busy, memory_order_release);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef LOGGER_TIMESTAMP_H
+#define LOGGER_TIMESTAMP_H
+
+#include <stdbool.h>
+#include <time.h>
+
+// Timestamps of log messages: the UTC date and time once the clock has been
+// set (e.g. by SNTP), the processor clock before that.
+//
+// The formatted time of the last second is cached, so the timestamps of
+// messages logged in the same second are copied and only the seconds digits
+// change within a minute. The cache is claimed without waiting, a task that
+// finds it claimed by another task formats its timestamp itself.
+
+#define LOGGER_TIMESTAMP_SIZE 20
+
+// True if the time has been set, the processor clock is only needed if it is not
+bool logger_timestamp_time_is_set(time_t now);
+
+void logger_timestamp_format(time_t now, clock_t ticks, char* timestamp);
+
+#endif // LOGGER_TIMESTAMP_H
\ No newline at end of file
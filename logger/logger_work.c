@@ -0,0 +1,149 @@
+#include "logger_work.h"
+
+#include <stddef.h>
+
+#include <sdkconfig.h>
+
+#include "logger_port.h"
+
+static logger_work_t* first = NULL;
+static atomic_bool anyPosted;
+static void (*wakeRunner)(void) = NULL;
+static logger_port_mutex_t lock = NULL;     // Serializes changing the list and running the work
+
+// Runs the work when there is no wake function
+static atomic_bool workTaskStarted;
+static _Atomic(logger_port_task_t) workTask = NULL;
+
+static void work_task(void* arg)
+{
+    (void)arg;
+
+    for(;;)
+    {
+        // Running fails while another task holds the lock, which is only held shortly
+        while(atomic_load(&anyPosted))
+        {
+            logger_work_run();
+
+            if(atomic_load(&anyPosted))
+            {
+                logger_port_sleep_ms(1);
+            }
+        }
+
+        logger_port_task_wait();
+    }
+}
+
+static void wake_work_task(void)
+{
+    logger_port_task_t task = atomic_load(&workTask);
+
+    if(task != NULL)
+    {
+        logger_port_task_notify(task);
+        return;
+    }
+
+    // Started by the first post, so only configurations that post work pay for the task. Work runs on the
+    // next log call if it does not start.
+    if(lock != NULL && !atomic_exchange(&workTaskStarted, true)
+        && logger_port_task_start(work_task, NULL, "logger_work", CONFIG_LOGGER_SERVICE_WORK_TASK_STACK_SIZE, CONFIG_LOGGER_SERVICE_WORK_TASK_PRIORITY, &task))
+    {
+        atomic_store(&workTask, task);
+    }
+}
+
+void logger_work_init(void (*wake)(void))
+{
+    if(lock == NULL)
+    {
+        wakeRunner = wake;
+        logger_port_mutex_create(&lock);
+    }
+}
+
+void logger_work_add(logger_work_t* work, void (*run)(void* arg), void* arg)
+{
+    work->run = run;
+    work->arg = arg;
+    atomic_init(&work->posted, false);
+
+    if(lock != NULL)
+    {
+        logger_port_mutex_lock(lock);
+    }
+
+    work->next = first;
+    first = work;
+
+    if(lock != NULL)
+    {
+        logger_port_mutex_unlock(lock);
+    }
+}
+
+void logger_work_remove(logger_work_t* work)
+{
+    if(lock != NULL)
+    {
+        logger_port_mutex_lock(lock);
+    }
+
+    for(logger_work_t** link = &first; *link != NULL; link = &(*link)->next)
+    {
+        if(*link == work)
+        {
+            *link = work->next;
+            break;
+        }
+    }
+
+    if(lock != NULL)
+    {
+        logger_port_mutex_unlock(lock);
+    }
+}
+
+void logger_work_post(logger_work_t* work)
+{
+    atomic_store(&work->posted, true);
+    atomic_store(&anyPosted, true);
+
+    if(wakeRunner != NULL)
+    {
+        wakeRunner();
+    }
+    else
+    {
+        wake_work_task();
+    }
+}
+
+void logger_work_run(void)
+{
+    if(!atomic_load_explicit(&anyPosted, memory_order_relaxed))
+    {
+        return;
+    }
+
+    // Fails while the work of another task runs, or when the work itself logs
+    if(lock == NULL || !logger_port_mutex_try_lock(lock))
+    {
+        return;
+    }
+
+    // Cleared first, work posted while the list is walked is either run now or on the next call
+    atomic_store(&anyPosted, false);
+
+    for(logger_work_t* work = first; work != NULL; work = work->next)
+    {
+        if(atomic_exchange(&work->posted, false))
+        {
+            work->run(work->arg);
+        }
+    }
+
+    logger_port_mutex_unlock(lock);
+}
\ No newline at end of file
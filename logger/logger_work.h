@@ -0,0 +1,37 @@
+#ifndef LOGGER_WORK_H
+#define LOGGER_WORK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Work posted by timer callbacks.
+//
+// Timer callbacks run on the timer task, where they must neither block nor
+// call sinks, which may block on a full queue or write to flash. They only
+// post their work, which runs on the drain task when logging asynchronously.
+// Otherwise it runs on the next task that logs, or on a small task of the work
+// itself when nothing logs before that task wakes up. Posting is a few atomic
+// stores and running checks a single flag while nothing is posted.
+
+typedef struct logger_work_s
+{
+    void (*run)(void* arg);
+    void* arg;
+    atomic_bool posted;
+    struct logger_work_s* next;
+} logger_work_t;
+
+// The wake function makes the task that runs the work call logger_work_run. Without it the work runs on a
+// task of its own, which is started by the first post.
+void logger_work_init(void (*wake)(void));
+
+void logger_work_add(logger_work_t* work, void (*run)(void* arg), void* arg);
+void logger_work_remove(logger_work_t* work);   // Waits until the work does not run anymore, must not be called from it
+
+// Does not wait for other tasks, can be called from timer callbacks
+void logger_work_post(logger_work_t* work);
+
+// Runs the posted work. Work that logs does not run its own posts again, those run on the next call.
+void logger_work_run(void);
+
+#endif // LOGGER_WORK_H
\ No newline at end of file
@@ -21,6 +21,8 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <stddef.h>
+
 typedef enum 
 {
     UTIL_OK = 0,
@@ -28,8 +30,20 @@ typedef enum
     UTIL_ERR_ALLOC,
     UTIL_ERR_NOT_FOUND,
     UTIL_ERR_OUT_OF_RANGE,
+    UTIL_ERR_INVALID_ARG,
+    UTIL_ERR_FULL,
+    UTIL_ERR_EMPTY,
 
     UTIL_ITER_END
 } util_err_t;
 
+// Gets a pointer to the struct of the specified type that contains member at ptr
+#define UTIL_CONTAINER_OF(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+
+#define UTIL_CONCAT_(a, b) a##b
+#define UTIL_CONCAT(a, b)  UTIL_CONCAT_(a, b)
+
+// Generates an identifier that is unique per line, for use in macros that declare variables
+#define UTIL_UNIQUE_NAME(prefix) UTIL_CONCAT(prefix, __LINE__)
+
 #endif // COMMON_H
\ No newline at end of file
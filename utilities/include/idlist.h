@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef IDLIST_H
+#define IDLIST_H
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Intrusive Doubly Linked List
+ * 
+ * The link is embedded in the user's struct, so adding and removing items
+ * never allocates, and an item can be unlinked in O(1) given only its link.
+ * The list is circular around a sentinel link stored in the list itself.
+ * 
+ * struct device
+ * {
+ *     int id;
+ *     idlist_link link;
+ * };
+ * 
+ * idlist_push_back(&devices, &dev->link);
+ * IDLIST_FOREACH(link, &devices)
+ * {
+ *     struct device* dev = IDLIST_ENTRY(link, struct device, link);
+ * }
+ * idlist_unlink(&devices, &dev->link);
+ */
+typedef struct idlist_link_s
+{
+    struct idlist_link_s* next;
+    struct idlist_link_s* prev;
+} idlist_link;
+
+typedef struct idlist_s
+{
+    idlist_link head;
+    size_t      count;
+} idlist;
+
+#define IDLIST_ENTRY(link, type, member) UTIL_CONTAINER_OF(link, type, member)
+
+/**
+ * @brief Iterates over all links in the list. The current link must not be
+ * unlinked while iterating, use IDLIST_FOREACH_SAFE for that.
+ * 
+ * @param link Name of the idlist_link* variable that points to each link.
+ * @param list Pointer to the idlist to iterate.
+ */
+#define IDLIST_FOREACH(link, list) \
+    for(idlist_link* link = (list)->head.next; link != &(list)->head; link = link->next)
+
+/**
+ * @brief Iterates over all links in the list, the current link may be unlinked.
+ * 
+ * @param link Name of the idlist_link* variable that points to each link.
+ * @param list Pointer to the idlist to iterate.
+ */
+#define IDLIST_FOREACH_SAFE(link, list) \
+    IDLIST_FOREACH_SAFE_NEXT(link, list, UTIL_UNIQUE_NAME(idlist_foreach_next_))
+
+#define IDLIST_FOREACH_SAFE_NEXT(link, list, nextLink)                                            \
+    for(idlist_link *link = (list)->head.next, *nextLink = link->next; link != &(list)->head; \
+        link = nextLink, nextLink = link->next)
+
+/**
+ * @brief Initializes an empty list.
+ * 
+ * @param[out] list The list to initialize.
+ */
+static inline void idlist_init(idlist* list)
+{
+    list->head.next = &list->head;
+    list->head.prev = &list->head;
+    list->count = 0;
+}
+
+/**
+ * @brief Initializes a link as not being part of any list.
+ * 
+ * @param[out] link The link to initialize.
+ */
+static inline void idlist_link_init(idlist_link* link)
+{
+    link->next = NULL;
+    link->prev = NULL;
+}
+
+static inline bool idlist_is_linked(const idlist_link* link)
+{
+    return link->next != NULL;
+}
+
+static inline bool idlist_is_empty(const idlist* list)
+{
+    return list->head.next == &list->head;
+}
+
+static inline size_t idlist_count(const idlist* list)
+{
+    return list->count;
+}
+
+/**
+ * @brief Gets the first link, or NULL if the list is empty.
+ */
+static inline idlist_link* idlist_first(const idlist* list)
+{
+    return idlist_is_empty(list) ? NULL : list->head.next;
+}
+
+/**
+ * @brief Gets the last link, or NULL if the list is empty.
+ */
+static inline idlist_link* idlist_last(const idlist* list)
+{
+    return idlist_is_empty(list) ? NULL : list->head.prev;
+}
+
+/**
+ * @brief Gets the link after the specified link, or NULL if it is the last.
+ */
+static inline idlist_link* idlist_next(const idlist* list, const idlist_link* link)
+{
+    return link->next == &list->head ? NULL : link->next;
+}
+
+/**
+ * @brief Inserts a link after a link that is already in the list in O(1).
+ */
+static inline void idlist_insert_after(idlist* list, idlist_link* pos, idlist_link* link)
+{
+    link->prev = pos;
+    link->next = pos->next;
+    pos->next->prev = link;
+    pos->next = link;
+    list->count++;
+}
+
+/**
+ * @brief Inserts a link before a link that is already in the list in O(1).
+ */
+static inline void idlist_insert_before(idlist* list, idlist_link* pos, idlist_link* link)
+{
+    idlist_insert_after(list, pos->prev, link);
+}
+
+/**
+ * @brief Adds a link to the front of the list in O(1).
+ */
+static inline void idlist_push_front(idlist* list, idlist_link* link)
+{
+    idlist_insert_after(list, &list->head, link);
+}
+
+/**
+ * @brief Adds a link to the end of the list in O(1).
+ */
+static inline void idlist_push_back(idlist* list, idlist_link* link)
+{
+    idlist_insert_after(list, list->head.prev, link);
+}
+
+/**
+ * @brief Removes a link from the list in O(1). The link is reset to the
+ * unlinked state.
+ */
+static inline void idlist_unlink(idlist* list, idlist_link* link)
+{
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    idlist_link_init(link);
+    list->count--;
+}
+
+/**
+ * @brief Removes the first link from the list in O(1).
+ * 
+ * @return idlist_link* The removed link, or NULL if the list is empty.
+ */
+static inline idlist_link* idlist_pop_front(idlist* list)
+{
+    idlist_link* link = idlist_first(list);
+
+    if(link != NULL)
+    {
+        idlist_unlink(list, link);
+    }
+
+    return link;
+}
+
+/**
+ * @brief Removes the last link from the list in O(1).
+ * 
+ * @return idlist_link* The removed link, or NULL if the list is empty.
+ */
+static inline idlist_link* idlist_pop_back(idlist* list)
+{
+    idlist_link* link = idlist_last(list);
+
+    if(link != NULL)
+    {
+        idlist_unlink(list, link);
+    }
+
+    return link;
+}
+
+#endif // IDLIST_H
\ No newline at end of file
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef ISLIST_H
+#define ISLIST_H
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Intrusive Singly Linked List
+ * 
+ * The link is embedded in the user's struct, so adding and removing items
+ * never allocates. An item can only be in one list per embedded link.
+ * 
+ * struct device
+ * {
+ *     int id;
+ *     islist_link link;
+ * };
+ * 
+ * islist_push_back(&devices, &dev->link);
+ * ISLIST_FOREACH(link, &devices)
+ * {
+ *     struct device* dev = ISLIST_ENTRY(link, struct device, link);
+ * }
+ */
+typedef struct islist_link_s
+{
+    struct islist_link_s* next;
+} islist_link;
+
+typedef struct islist_s
+{
+    islist_link* first;
+    islist_link* last;
+    size_t       count;
+} islist;
+
+#define ISLIST_ENTRY(link, type, member) UTIL_CONTAINER_OF(link, type, member)
+
+/**
+ * @brief Iterates over all links in the list. The current link must not be
+ * removed while iterating.
+ * 
+ * @param link Name of the islist_link* variable that points to each link.
+ * @param list Pointer to the islist to iterate.
+ */
+#define ISLIST_FOREACH(link, list) \
+    for(islist_link* link = (list)->first; link != NULL; link = link->next)
+
+/**
+ * @brief Initializes an empty list.
+ * 
+ * @param[out] list The list to initialize.
+ */
+static inline void islist_init(islist* list)
+{
+    list->first = NULL;
+    list->last = NULL;
+    list->count = 0;
+}
+
+static inline bool islist_is_empty(const islist* list)
+{
+    return list->first == NULL;
+}
+
+static inline size_t islist_count(const islist* list)
+{
+    return list->count;
+}
+
+static inline islist_link* islist_first(const islist* list)
+{
+    return list->first;
+}
+
+/**
+ * @brief Adds a link to the front of the list in O(1).
+ */
+static inline void islist_push_front(islist* list, islist_link* link)
+{
+    link->next = list->first;
+    list->first = link;
+
+    if(list->last == NULL)
+    {
+        list->last = link;
+    }
+
+    list->count++;
+}
+
+/**
+ * @brief Adds a link to the end of the list in O(1).
+ */
+static inline void islist_push_back(islist* list, islist_link* link)
+{
+    link->next = NULL;
+
+    if(list->last == NULL)
+    {
+        list->first = link;
+    }
+    else
+    {
+        list->last->next = link;
+    }
+
+    list->last = link;
+    list->count++;
+}
+
+/**
+ * @brief Inserts a link after a link that is already in the list in O(1).
+ */
+static inline void islist_insert_after(islist* list, islist_link* pos, islist_link* link)
+{
+    link->next = pos->next;
+    pos->next = link;
+
+    if(list->last == pos)
+    {
+        list->last = link;
+    }
+
+    list->count++;
+}
+
+/**
+ * @brief Removes the first link from the list in O(1).
+ * 
+ * @return islist_link* The removed link, or NULL if the list is empty.
+ */
+static inline islist_link* islist_pop_front(islist* list)
+{
+    islist_link* link = list->first;
+
+    if(link != NULL)
+    {
+        list->first = link->next;
+
+        if(list->first == NULL)
+        {
+            list->last = NULL;
+        }
+
+        link->next = NULL;
+        list->count--;
+    }
+
+    return link;
+}
+
+/**
+ * @brief Removes a link from the list in O(n), use idlist for O(1) removal.
+ * 
+ * @return util_err_t UTIL_OK if the link was removed, or
+ * UTIL_ERR_NOT_FOUND if it is not in the list.
+ */
+static inline util_err_t islist_remove(islist* list, islist_link* link)
+{
+    islist_link* prev = NULL;
+    islist_link* node = list->first;
+
+    while(node != NULL && node != link)
+    {
+        prev = node;
+        node = node->next;
+    }
+
+    if(node == NULL)
+    {
+        return UTIL_ERR_NOT_FOUND;
+    }
+
+    if(prev == NULL)
+    {
+        list->first = link->next;
+    }
+    else
+    {
+        prev->next = link->next;
+    }
+
+    if(list->last == link)
+    {
+        list->last = prev;
+    }
+
+    link->next = NULL;
+    list->count--;
+
+    return UTIL_OK;
+}
+
+#endif // ISLIST_H
\ No newline at end of file
@@ -21,22 +21,93 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include "common.h"
+
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
 /**
  * @brief Map
+ * 
+ * Hash map using open addressing with linear probing. Entries are stored
+ * inline in a single table, so lookups do not allocate and only touch the
+ * table itself.
  */
 typedef struct map_s* map;
 
 typedef struct map_iter_s* map_iter;
 
+/**
+ * @brief Iterator state owned by the caller, so iterating does not need to allocate.
+ * Declare it on the stack, initialize it with map_iter_init or map_iter_begin
+ * and pass its address wherever a map_iter is expected.
+ */
+typedef struct map_iter_s
+{
+    map    m;
+    size_t index;
+} map_iter_state;
+
+typedef struct map_conf_s
+{
+    void* (*mem_alloc)(size_t size);
+    void* (*mem_calloc)(size_t blocks, size_t size);
+    void (*mem_free)(void* block);
+    size_t (*key_hash)(const void* key);
+    bool (*key_equals)(const void* key1, const void* key2);
+} map_conf;
+
+/**
+ * @brief Initializes a configuration object with default values.
+ * Keys are compared by pointer identity.
+ * 
+ * @param[out] conf The configuration object to initialize.
+ */
+void map_conf_init(map_conf* conf);
+
+/**
+ * @brief Hash function that hashes the key pointer itself.
+ */
+size_t map_hash_ptr(const void* key);
+
+/**
+ * @brief Equality function that compares key pointers.
+ */
+bool map_equals_ptr(const void* key1, const void* key2);
+
+/**
+ * @brief Hash function for NUL terminated string keys.
+ */
+size_t map_hash_str(const void* key);
+
+/**
+ * @brief Equality function for NUL terminated string keys.
+ */
+bool map_equals_str(const void* key1, const void* key2);
+
 /**
  * @brief Create a new Map
  * 
  * @param[out] m Pointer where to store the new map
  */
-void map_new(map* m);
+util_err_t map_new(map* m);
+
+/**
+ * @brief Create a new Map using the specified configuration.
+ * 
+ * @param[in] conf The configuration to use.
+ * @param[out] m Pointer where to store the new map
+ */
+util_err_t map_new_conf(const map_conf* const conf, map* m);
+
+/**
+ * @brief Deletes the map and frees all of its resources.
+ * Resources used by keys and values are not freed.
+ * 
+ * @param[in] m The map to delete.
+ */
+void map_delete(map m);
 
 /**
  * @brief Copies the map and all its items
@@ -44,33 +115,54 @@ void map_new(map* m);
  * @param[in] m The map to be copied
  * @param[out] copy A pointer to where to store the copied map
  */
-void map_copy(const map m, map* copy);
+util_err_t map_copy(const map m, map* copy);
+
+/**
+ * @brief Ensures the map can hold the specified number of entries without
+ * growing its table.
+ * 
+ * @param[in] m The map
+ * @param[in] count The number of entries to reserve room for
+ */
+util_err_t map_reserve(map m, size_t count);
 
 /**
- * @brief Add a value with the specified key to the map
+ * @brief Add a value with the specified key to the map. If the key is
+ * already present its value is replaced.
  * 
  * @param[in] m The map
  * @param[in] key Key of the value to add
  * @param[in] value Value to add
  */
-void map_add(map m, const void * key, const void * value);
+util_err_t map_add(map m, const void * key, const void * value);
 
 /**
  * @brief Gets the value with the specified key from the map
  * 
  * @param[in] m The map
  * @param[in] key The key of the value to get
- * @param[out] value The
+ * @param[out] value The value, or NULL if the key was not found
+ * @return util_err_t UTIL_OK if the key was found, or
+ * UTIL_ERR_NOT_FOUND if the key was not found.
  */
-void map_get(map m, const void* key, const void ** value);
+util_err_t map_get(const map m, const void* key, const void ** value);
 
 /**
  * @brief Removes the value with the specified key from the map
  * 
  * @param m The map
  * @param key The key of the value to remove
+ * @return util_err_t UTIL_OK if the key was removed, or
+ * UTIL_ERR_NOT_FOUND if the key was not found.
  */
-void map_remove(map m, const void* key);
+util_err_t map_remove(map m, const void* key);
+
+/**
+ * @brief Removes all entries from the map. The table keeps its capacity.
+ * 
+ * @param[in] m The map to clear.
+ */
+void map_clear(map m);
 
 /**
  * @brief Gets the number of entries in the map
@@ -81,25 +173,196 @@ void map_remove(map m, const void* key);
  */
 size_t map_count(const map m);
 
-void   map_iter_new(const map map, map_iter* iter);
-void   map_iter_delete(map_iter iter);
-void   map_iter_next(map_iter iter, void** key, void** value);
-
-#define TYPED_MAP(T)                                 \
-    typedef struct map_##T* map_##T;                 \
-    inline void map_##T##_new(map_##T* map)          \
-    {                                                \
-        map_new((map*)map);                          \
-    }                                                \
-                                                     \
-    inline void map_##T##_add(map_##T map, T* item)  \
-    {                                                \
-        map_add((map)map, (void*)item);              \
-    }                                                \
-                                                     \
-    inline size_t map_##T##_count(const map_##T map) \
-    {                                                \
-        return map_count((map)map);                  \
+/*
+ * Itterators
+ */
+
+util_err_t map_iter_new(const map map, map_iter* iter);
+void       map_iter_delete(map_iter iter);
+util_err_t map_iter_next(map_iter iter, void** key, void** value);
+
+/**
+ * @brief Initializes a caller-owned iterator. The iterator does not need to be deleted.
+ * 
+ * @param[in] map The map to iterate.
+ * @param[out] iter The iterator state to initialize.
+ */
+void           map_iter_init(const map map, map_iter_state* iter);
+map_iter_state map_iter_begin(const map map);
+
+/**
+ * @brief Iterates over all entries in the map using a stack allocated iterator.
+ * The order of the entries is unspecified.
+ * 
+ * @param key Variable of a pointer type that receives each key.
+ * @param value Variable of a pointer type that receives each value.
+ * @param m The map to iterate.
+ */
+#define MAP_FOREACH(key, value, m) \
+    MAP_FOREACH_ITER(key, value, m, UTIL_UNIQUE_NAME(map_foreach_iter_))
+
+#define MAP_FOREACH_ITER(key, value, m, iter)                                       \
+    for(map_iter_state iter = map_iter_begin((map)(m));                             \
+        map_iter_next(&iter, (void**)&(key), (void**)&(value)) != UTIL_ITER_END;)
+
+/**
+ * @brief Declares map_K_V, a map from K pointers to V pointers, with type-safe
+ * inline wrappers for all map functions (map_K_V_new, map_K_V_add, ...).
+ * The typed map can be iterated with MAP_FOREACH using K* and V* variables.
+ */
+#define TYPED_MAP(K, V)                                                                                \
+    typedef struct map_##K##_##V* map_##K##_##V;                                                       \
+    static inline util_err_t map_##K##_##V##_new(map_##K##_##V* m)                                     \
+    {                                                                                                  \
+        return map_new((map*)m);                                                                       \
+    }                                                                                                  \
+                                                                                                       \
+    static inline util_err_t map_##K##_##V##_new_conf(const map_conf* const conf, map_##K##_##V* m)    \
+    {                                                                                                  \
+        return map_new_conf(conf, (map*)m);                                                            \
+    }                                                                                                  \
+                                                                                                       \
+    static inline void map_##K##_##V##_delete(map_##K##_##V m)                                         \
+    {                                                                                                  \
+        map_delete((map)m);                                                                            \
+    }                                                                                                  \
+                                                                                                       \
+    static inline util_err_t map_##K##_##V##_copy(const map_##K##_##V m, map_##K##_##V* copy)          \
+    {                                                                                                  \
+        return map_copy((map)m, (map*)copy);                                                           \
+    }                                                                                                  \
+                                                                                                       \
+    static inline util_err_t map_##K##_##V##_reserve(map_##K##_##V m, size_t count)                    \
+    {                                                                                                  \
+        return map_reserve((map)m, count);                                                             \
+    }                                                                                                  \
+                                                                                                       \
+    static inline util_err_t map_##K##_##V##_remove(map_##K##_##V m, const K* key)                     \
+    {                                                                                                  \
+        return map_remove((map)m, (const void*)key);                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    static inline void map_##K##_##V##_clear(map_##K##_##V m)                                          \
+    {                                                                                                  \
+        map_clear((map)m);                                                                             \
+    }                                                                                                  \
+                                                                                                       \
+    static inline size_t map_##K##_##V##_count(const map_##K##_##V m)                                  \
+    {                                                                                                  \
+        return map_count((map)m);                                                                      \
+    }                                                                                                  \
+                                                                                                       \
+    static inline map_iter_state map_##K##_##V##_iter_begin(const map_##K##_##V m)                     \
+    {                                                                                                  \
+        return map_iter_begin((map)m);                                                                 \
+    }                                                                                                  \
+                                                                                                       \
+    static inline util_err_t map_##K##_##V##_add(map_##K##_##V m, const K* key, V* value)              \
+    {                                                                                                  \
+        return map_add((map)m, (const void*)key, (const void*)value);                                  \
+    }                                                                                                  \
+                                                                                                       \
+    static inline util_err_t map_##K##_##V##_get(const map_##K##_##V m, const K* key, V** value)       \
+    {                                                                                                  \
+        return map_get((map)m, (const void*)key, (const void**)value);                                 \
+    }                                                                                                  \
+                                                                                                       \
+    static inline util_err_t map_##K##_##V##_iter_next(map_iter_state* iter, const K** key, V** value) \
+    {                                                                                                  \
+        return map_iter_next(iter, (void**)key, (void**)value);                                        \
+    }
+
+/**
+ * @brief Declares map_K_V, a map from K pointers to V values that are stored
+ * directly in the table instead of pointers to them. V must fit in a pointer.
+ */
+#define TYPED_MAP_VALUE(K, V)                                                                                   \
+    _Static_assert(sizeof(V) <= sizeof(void*), "TYPED_MAP_VALUE requires a value type that fits in a pointer"); \
+    typedef struct map_##K##_##V* map_##K##_##V;                                                                \
+    static inline const void* map_##K##_##V##_pack(V value)                                                     \
+    {                                                                                                           \
+        const void* packed = NULL;                                                                              \
+        memcpy(&packed, &value, sizeof(V));                                                                     \
+        return packed;                                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    static inline V map_##K##_##V##_unpack(const void* packed)                                                  \
+    {                                                                                                           \
+        V value;                                                                                                \
+        memcpy(&value, &packed, sizeof(V));                                                                     \
+        return value;                                                                                           \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_new(map_##K##_##V* m)                                              \
+    {                                                                                                           \
+        return map_new((map*)m);                                                                                \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_new_conf(const map_conf* const conf, map_##K##_##V* m)             \
+    {                                                                                                           \
+        return map_new_conf(conf, (map*)m);                                                                     \
+    }                                                                                                           \
+                                                                                                                \
+    static inline void map_##K##_##V##_delete(map_##K##_##V m)                                                  \
+    {                                                                                                           \
+        map_delete((map)m);                                                                                     \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_copy(const map_##K##_##V m, map_##K##_##V* copy)                   \
+    {                                                                                                           \
+        return map_copy((map)m, (map*)copy);                                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_reserve(map_##K##_##V m, size_t count)                             \
+    {                                                                                                           \
+        return map_reserve((map)m, count);                                                                      \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_remove(map_##K##_##V m, const K* key)                              \
+    {                                                                                                           \
+        return map_remove((map)m, (const void*)key);                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    static inline void map_##K##_##V##_clear(map_##K##_##V m)                                                   \
+    {                                                                                                           \
+        map_clear((map)m);                                                                                      \
+    }                                                                                                           \
+                                                                                                                \
+    static inline size_t map_##K##_##V##_count(const map_##K##_##V m)                                           \
+    {                                                                                                           \
+        return map_count((map)m);                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    static inline map_iter_state map_##K##_##V##_iter_begin(const map_##K##_##V m)                              \
+    {                                                                                                           \
+        return map_iter_begin((map)m);                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_add(map_##K##_##V m, const K* key, V value)                        \
+    {                                                                                                           \
+        return map_add((map)m, (const void*)key, map_##K##_##V##_pack(value));                                  \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_get(const map_##K##_##V m, const K* key, V* value)                 \
+    {                                                                                                           \
+        const void* packed;                                                                                     \
+        util_err_t err = map_get((map)m, (const void*)key, &packed);                                            \
+        if(err == UTIL_OK)                                                                                      \
+        {                                                                                                       \
+            *value = map_##K##_##V##_unpack(packed);                                                            \
+        }                                                                                                       \
+        return err;                                                                                             \
+    }                                                                                                           \
+                                                                                                                \
+    static inline util_err_t map_##K##_##V##_iter_next(map_iter_state* iter, const K** key, V* value)           \
+    {                                                                                                           \
+        void* packed;                                                                                           \
+        util_err_t err = map_iter_next(iter, (void**)key, &packed);                                             \
+        if(err == UTIL_OK)                                                                                      \
+        {                                                                                                       \
+            *value = map_##K##_##V##_unpack(packed);                                                            \
+        }                                                                                                       \
+        return err;                                                                                             \
     }
 
 #endif // MAP_H
\ No newline at end of file
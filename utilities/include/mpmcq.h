@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef MPMCQ_H
+#define MPMCQ_H
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Bounded multi-producer/multi-consumer queue
+ * 
+ * Lock-free queue of fixed size slots in a preallocated array. Any number of
+ * tasks may produce and consume at the same time. A producer claims a slot
+ * with mpmcq_reserve, fills it in place and publishes it with mpmcq_commit.
+ * A consumer claims the oldest published slot with mpmcq_acquire and hands
+ * it back with mpmcq_release. Slots are handed out in order, so a slot that
+ * is reserved but not yet committed holds back the slots behind it.
+ */
+typedef struct mpmcq_s* mpmcq;
+
+typedef struct mpmcq_conf_s
+{
+    void* (*mem_alloc)(size_t size);
+    void (*mem_free)(void* block);
+} mpmcq_conf;
+
+/**
+ * @brief Initializes a configuration object with default values.
+ * 
+ * @param[out] conf The configuration object to initialize.
+ */
+void mpmcq_conf_init(mpmcq_conf* conf);
+
+/**
+ * @brief Create a new queue.
+ * 
+ * @param[in] slot_size The size of a single slot in bytes.
+ * @param[in] slots The number of slots, rounded up to a power of 2.
+ * @param[out] q Pointer to the created mpmcq.
+ */
+util_err_t mpmcq_new(size_t slot_size, size_t slots, mpmcq* q);
+
+/**
+ * @brief Create a new queue using the specified configuration.
+ * 
+ * @param[in] conf The configuration to use.
+ * @param[in] slot_size The size of a single slot in bytes.
+ * @param[in] slots The number of slots, rounded up to a power of 2.
+ * @param[out] q Pointer to the created mpmcq.
+ */
+util_err_t mpmcq_new_conf(const mpmcq_conf* const conf, size_t slot_size, size_t slots, mpmcq* q);
+
+/**
+ * @brief Deletes the queue and frees all of its resources.
+ * 
+ * @param[in] q The mpmcq to delete.
+ */
+void mpmcq_delete(mpmcq q);
+
+/**
+ * @brief Claims the next free slot for writing.
+ * 
+ * @param[in] q The mpmcq.
+ * @param[out] slot Pointer to the slot, which is aligned for any type.
+ * @return util_err_t UTIL_OK, or UTIL_ERR_FULL if all slots are in use.
+ */
+util_err_t mpmcq_reserve(mpmcq q, void** slot);
+
+/**
+ * @brief Publishes a slot claimed by mpmcq_reserve to the consumers.
+ * 
+ * @param[in] q The mpmcq.
+ * @param[in] slot The slot returned by mpmcq_reserve.
+ */
+void mpmcq_commit(mpmcq q, void* slot);
+
+/**
+ * @brief Claims the oldest published slot for reading.
+ * 
+ * @param[in] q The mpmcq.
+ * @param[out] slot Pointer to the slot.
+ * @return util_err_t UTIL_OK, or UTIL_ERR_EMPTY if no slot is published.
+ */
+util_err_t mpmcq_acquire(mpmcq q, void** slot);
+
+/**
+ * @brief Frees a slot claimed by mpmcq_acquire so it can be reused.
+ * 
+ * @param[in] q The mpmcq.
+ * @param[in] slot The slot returned by mpmcq_acquire.
+ */
+void mpmcq_release(mpmcq q, void* slot);
+
+/**
+ * @brief Gets the size of a single slot in bytes.
+ */
+size_t mpmcq_slot_size(const mpmcq q);
+
+/**
+ * @brief Gets the number of slots in the queue.
+ */
+size_t mpmcq_capacity(const mpmcq q);
+
+/**
+ * @brief Gets the number of slots that are reserved or published but not yet
+ * acquired. This is a snapshot that may be outdated when other tasks are
+ * using the queue.
+ */
+size_t mpmcq_count(const mpmcq q);
+
+#endif // MPMCQ_H
\ No newline at end of file
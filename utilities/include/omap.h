@@ -0,0 +1,220 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef OMAP_H
+#define OMAP_H
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Ordered Map
+ * 
+ * Map that keeps its entries sorted by key using a skip list, supporting
+ * lookups, lower/upper bound searches and in-order range iteration in
+ * O(log n). Nodes are allocated from pools, one per skip list level.
+ * 
+ * Keys are either stored as pointers (key_size 0, e.g. strings, the key
+ * must outlive the entry) or copied into the node (key_size > 0, e.g.
+ * integers or timestamps). In both cases keys are passed to the API as a
+ * pointer: the key pointer itself, or a pointer to the key bytes to copy.
+ * The comparator receives keys the same way.
+ */
+typedef struct omap_s* omap;
+
+typedef int (*omap_compare_t)(const void* key1, const void* key2);
+
+typedef struct omap_conf_s
+{
+    void* (*mem_alloc)(size_t size);
+    void (*mem_free)(void* block);
+    omap_compare_t key_compare; // Returns <0, 0 or >0 if key1 orders before, equal to or after key2
+    size_t key_size;            // Size of keys copied into the nodes, or 0 to store key pointers
+    size_t nodes_per_slab;      // Number of nodes allocated at once when a node pool grows
+} omap_conf;
+
+/**
+ * @brief Iterator state owned by the caller. Initialize it with one of the
+ * omap_iter_* functions. Entries must not be added or removed while iterating.
+ */
+typedef struct omap_iter_s
+{
+    omap                 m;
+    struct omap_node_s*  node;
+    const void*          end_key; // Iteration stops before this key, NULL for no bound
+} omap_iter_state;
+
+/**
+ * @brief Initializes a configuration object with default values.
+ * 
+ * @param[out] conf The configuration object to initialize.
+ * @param[in] key_compare The function used to order keys.
+ * @param[in] key_size The size of the keys to copy into the nodes, or 0 to
+ * store key pointers.
+ */
+void omap_conf_init(omap_conf* conf, omap_compare_t key_compare, size_t key_size);
+
+/**
+ * @brief Comparators for common key types. omap_compare_str expects key
+ * pointers (key_size 0), the integer comparators expect keys copied into
+ * the nodes (key_size set to the size of the integer).
+ */
+int omap_compare_str(const void* key1, const void* key2);
+int omap_compare_i32(const void* key1, const void* key2);
+int omap_compare_u32(const void* key1, const void* key2);
+int omap_compare_i64(const void* key1, const void* key2);
+int omap_compare_u64(const void* key1, const void* key2);
+
+/**
+ * @brief Create a new Ordered Map using the specified configuration.
+ * 
+ * @param[in] conf The configuration to use.
+ * @param[out] m Pointer where to store the new omap.
+ */
+util_err_t omap_new(const omap_conf* const conf, omap* m);
+
+/**
+ * @brief Deletes the map and frees all of its resources.
+ * Resources used by values are not freed.
+ * 
+ * @param[in] m The omap to delete.
+ */
+void omap_delete(omap m);
+
+/**
+ * @brief Adds a value with the specified key, or replaces the value if the
+ * key is already present.
+ * 
+ * @param[in] m The omap.
+ * @param[in] key The key of the value.
+ * @param[in] value The value to add.
+ */
+util_err_t omap_put(omap m, const void* key, const void* value);
+
+/**
+ * @brief Gets the value with the specified key.
+ * 
+ * @param[in] m The omap.
+ * @param[in] key The key of the value to get.
+ * @param[out] value The value, or NULL if the key was not found.
+ * @return util_err_t UTIL_OK if the key was found, or
+ * UTIL_ERR_NOT_FOUND if the key was not found.
+ */
+util_err_t omap_get(const omap m, const void* key, const void** value);
+
+/**
+ * @brief Removes the value with the specified key.
+ * 
+ * @param[in] m The omap.
+ * @param[in] key The key of the value to remove.
+ * @return util_err_t UTIL_OK if the key was removed, or
+ * UTIL_ERR_NOT_FOUND if the key was not found.
+ */
+util_err_t omap_remove(omap m, const void* key);
+
+/**
+ * @brief Gets the entry with the smallest key.
+ * 
+ * @param[in] m The omap.
+ * @param[out] key The key of the entry.
+ * @param[out] value The value of the entry.
+ * @return util_err_t UTIL_OK, or UTIL_ERR_NOT_FOUND if the map is empty.
+ */
+util_err_t omap_first(const omap m, const void** key, const void** value);
+
+/**
+ * @brief Gets the entry with the largest key in O(log n).
+ * 
+ * @param[in] m The omap.
+ * @param[out] key The key of the entry.
+ * @param[out] value The value of the entry.
+ * @return util_err_t UTIL_OK, or UTIL_ERR_NOT_FOUND if the map is empty.
+ */
+util_err_t omap_last(const omap m, const void** key, const void** value);
+
+/**
+ * @brief Removes all entries from the map.
+ * 
+ * @param[in] m The omap to clear.
+ */
+void omap_clear(omap m);
+
+/**
+ * @brief Gets the number of entries in the map.
+ * 
+ * @param[in] m The omap.
+ * 
+ * @return size_t The number of entries in the map.
+ */
+size_t omap_count(const omap m);
+
+/*
+ * Itterators
+ */
+
+/**
+ * @brief Starts iterating at the smallest key.
+ */
+void            omap_iter_first(const omap m, omap_iter_state* iter);
+omap_iter_state omap_iter_begin(const omap m);
+
+/**
+ * @brief Starts iterating at the first key that is not less than key.
+ */
+void omap_iter_lower_bound(const omap m, const void* key, omap_iter_state* iter);
+
+/**
+ * @brief Starts iterating at the first key that is greater than key.
+ */
+void omap_iter_upper_bound(const omap m, const void* key, omap_iter_state* iter);
+
+/**
+ * @brief Iterates over all keys in the half-open range [from, to).
+ * The end key is not copied and must remain valid while iterating.
+ */
+void omap_iter_range(const omap m, const void* from, const void* to, omap_iter_state* iter);
+
+/**
+ * @brief Gets the next entry in key order.
+ * 
+ * @param[in] iter The iterator.
+ * @param[out] key The key of the entry.
+ * @param[out] value The value of the entry.
+ * @return util_err_t UTIL_OK, or UTIL_ITER_END if there are no more entries.
+ */
+util_err_t omap_iter_next(omap_iter_state* iter, void** key, void** value);
+
+/**
+ * @brief Iterates over all entries in key order.
+ * 
+ * @param key Variable of a pointer type that receives each key.
+ * @param value Variable of a pointer type that receives each value.
+ * @param m The omap to iterate.
+ */
+#define OMAP_FOREACH(key, value, m) \
+    OMAP_FOREACH_ITER(key, value, m, UTIL_UNIQUE_NAME(omap_foreach_iter_))
+
+#define OMAP_FOREACH_ITER(key, value, m, iter)                                      \
+    for(omap_iter_state iter = omap_iter_begin((omap)(m));                          \
+        omap_iter_next(&iter, (void**)&(key), (void**)&(value)) != UTIL_ITER_END;)
+
+#endif // OMAP_H
\ No newline at end of file
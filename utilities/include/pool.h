@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef POOL_H
+#define POOL_H
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Fixed-size block pool
+ * 
+ * Hands out blocks of a single size from slabs that hold many blocks each.
+ * Freed blocks are kept on a free-list and reused, so a pool never returns
+ * memory to the heap until it is deleted. Blocks are aligned to the size of a
+ * pointer. A pool is not thread-safe.
+ */
+typedef struct pool_s* pool;
+
+typedef struct pool_conf_s
+{
+    void* (*mem_alloc)(size_t size);
+    void (*mem_free)(void* block);
+    size_t block_size;      // Size of a single block in bytes
+    size_t blocks_per_slab; // Number of blocks allocated at once when the pool grows
+    size_t initial_blocks;  // Number of blocks of the first slab, 0 for blocks_per_slab
+    size_t max_slabs;       // Maximum number of slabs, 0 for unlimited growth
+} pool_conf;
+
+typedef struct pool_stats_s
+{
+    size_t block_size;   // Size of a single block after alignment
+    size_t slabs;        // Number of slabs allocated from the heap
+    size_t capacity;     // Total number of blocks in all slabs
+    size_t in_use;       // Number of blocks currently handed out
+    size_t peak_in_use;  // Highest number of blocks handed out at once
+    size_t alloc_count;  // Number of successful allocations
+    size_t free_count;   // Number of frees
+    size_t failed_count; // Number of allocations that failed because the pool was exhausted
+} pool_stats;
+
+/**
+ * @brief Initializes a configuration object with default values.
+ * The pool grows without limit by default and its first slab holds blocks_per_slab blocks.
+ * 
+ * @param[out] conf The configuration object to initialize.
+ * @param[in] block_size The size of a single block.
+ * @param[in] blocks_per_slab The number of blocks per slab.
+ */
+void pool_conf_init(pool_conf* conf, size_t block_size, size_t blocks_per_slab);
+
+/**
+ * @brief Create a new pool that grows without limit. The first slab is
+ * allocated immediately.
+ * 
+ * @param[in] block_size The size of a single block.
+ * @param[in] blocks_per_slab The number of blocks per slab.
+ * @param[out] p Pointer to the created pool.
+ */
+util_err_t pool_new(size_t block_size, size_t blocks_per_slab, pool* p);
+
+/**
+ * @brief Create a new pool using the specified configuration. The first slab
+ * is allocated immediately.
+ * 
+ * @param[in] conf The configuration to use.
+ * @param[out] p Pointer to the created pool.
+ */
+util_err_t pool_new_conf(const pool_conf* const conf, pool* p);
+
+/**
+ * @brief Deletes the pool and frees all of its slabs. All blocks handed
+ * out by the pool become invalid.
+ * 
+ * @param[in] p The pool to delete.
+ */
+void pool_delete(pool p);
+
+/**
+ * @brief Ensures at least the specified number of blocks can be allocated
+ * without growing the pool, allocating a single slab for any shortage.
+ * 
+ * @param[in] p The pool.
+ * @param[in] count The number of free blocks required.
+ * @return util_err_t UTIL_OK if enough blocks are free, UTIL_ERR_ALLOC if
+ * the slab could not be allocated or the pool may not grow any further.
+ */
+util_err_t pool_reserve(pool p, size_t count);
+
+/**
+ * @brief Allocates a block from the pool.
+ * 
+ * @param[in] p The pool.
+ * @return void* The block, or NULL if the pool is exhausted and may not grow.
+ */
+void* pool_alloc(pool p);
+
+/**
+ * @brief Allocates a zero-initialized block from the pool.
+ * 
+ * @param[in] p The pool.
+ * @return void* The block, or NULL if the pool is exhausted and may not grow.
+ */
+void* pool_calloc(pool p);
+
+/**
+ * @brief Returns a block to the pool.
+ * 
+ * @param[in] p The pool the block was allocated from.
+ * @param[in] block The block to free.
+ */
+void pool_free(pool p, void* block);
+
+/**
+ * @brief Gets the size of the blocks handed out by the pool.
+ * 
+ * @param[in] p The pool.
+ * @return size_t The block size after alignment.
+ */
+size_t pool_block_size(const pool p);
+
+/**
+ * @brief Gets the statistics of the pool.
+ * 
+ * @param[in] p The pool.
+ * @param[out] stats The statistics.
+ */
+void pool_get_stats(const pool p, pool_stats* stats);
+
+#endif // POOL_H
\ No newline at end of file
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Single-producer/single-consumer ring buffer
+ * 
+ * Lock-free ring buffer of variable length records. Exactly one task (or ISR)
+ * may produce and exactly one task may consume at the same time. Records are
+ * always stored contiguously, so the producer can write a record in place
+ * (ringbuf_reserve/ringbuf_commit) and the consumer can read it in place
+ * (ringbuf_peek/ringbuf_release) without copying.
+ */
+typedef struct ringbuf_s* ringbuf;
+
+typedef struct ringbuf_conf_s
+{
+    void* (*mem_alloc)(size_t size);
+    void (*mem_free)(void* block);
+} ringbuf_conf;
+
+/**
+ * @brief Initializes a configuration object with default values.
+ * 
+ * @param[out] conf The configuration object to initialize.
+ */
+void ringbuf_conf_init(ringbuf_conf* conf);
+
+/**
+ * @brief Create a new ring buffer.
+ * 
+ * @param[in] size The size of the buffer in bytes, rounded up to a power of 2.
+ * @param[out] rb Pointer to the created ringbuf.
+ */
+util_err_t ringbuf_new(size_t size, ringbuf* rb);
+
+/**
+ * @brief Create a new ring buffer using the specified configuration.
+ * 
+ * @param[in] conf The configuration to use.
+ * @param[in] size The size of the buffer in bytes, rounded up to a power of 2.
+ * @param[out] rb Pointer to the created ringbuf.
+ */
+util_err_t ringbuf_new_conf(const ringbuf_conf* const conf, size_t size, ringbuf* rb);
+
+/**
+ * @brief Deletes the ring buffer and frees all of its resources.
+ * 
+ * @param[in] rb The ringbuf to delete.
+ */
+void ringbuf_delete(ringbuf rb);
+
+/**
+ * @brief Gets the largest record that can be stored in the ring buffer.
+ * 
+ * @param[in] rb The ringbuf.
+ * @return size_t The maximum record length in bytes.
+ */
+size_t ringbuf_max_record_size(const ringbuf rb);
+
+/**
+ * @brief Reserves room for a record at the producer side. The record becomes
+ * visible to the consumer when it is committed. Producer only.
+ * 
+ * @param[in] rb The ringbuf.
+ * @param[in] len The maximum length of the record.
+ * @param[out] data Pointer to the contiguous space for the record.
+ * @return util_err_t UTIL_OK on success, UTIL_ERR_FULL if there is currently
+ * not enough room, or UTIL_ERR_INVALID_ARG if len exceeds the maximum record size.
+ */
+util_err_t ringbuf_reserve(ringbuf rb, size_t len, void** data);
+
+/**
+ * @brief Publishes the reserved record to the consumer. Producer only.
+ * 
+ * @param[in] rb The ringbuf.
+ * @param[in] len The actual length of the record, at most the reserved length.
+ */
+void ringbuf_commit(ringbuf rb, size_t len);
+
+/**
+ * @brief Copies a record into the ring buffer. Producer only.
+ * 
+ * @param[in] rb The ringbuf.
+ * @param[in] data The record.
+ * @param[in] len The length of the record.
+ */
+util_err_t ringbuf_write(ringbuf rb, const void* data, size_t len);
+
+/**
+ * @brief Gets the oldest record without removing it. Consumer only.
+ * 
+ * @param[in] rb The ringbuf.
+ * @param[out] data Pointer to the record, valid until it is released.
+ * @param[out] len The length of the record.
+ * @return util_err_t UTIL_OK if a record is available, or UTIL_ERR_EMPTY.
+ */
+util_err_t ringbuf_peek(ringbuf rb, const void** data, size_t* len);
+
+/**
+ * @brief Removes the record returned by the last ringbuf_peek, making its
+ * space available to the producer again. Consumer only.
+ * 
+ * @param[in] rb The ringbuf.
+ */
+void ringbuf_release(ringbuf rb);
+
+/**
+ * @brief Copies the oldest record out of the ring buffer and removes it.
+ * Consumer only.
+ * 
+ * @param[in] rb The ringbuf.
+ * @param[out] data Buffer to copy the record to.
+ * @param[in] capacity The size of the buffer, longer records are truncated.
+ * @param[out] len The length of the record.
+ * @return util_err_t UTIL_OK if a record was read, or UTIL_ERR_EMPTY.
+ */
+util_err_t ringbuf_read(ringbuf rb, void* data, size_t capacity, size_t* len);
+
+/**
+ * @brief Checks whether the ring buffer holds no records.
+ * 
+ * @param[in] rb The ringbuf.
+ * @return bool True if the ring buffer is empty.
+ */
+bool ringbuf_is_empty(const ringbuf rb);
+
+#endif // RINGBUF_H
\ No newline at end of file
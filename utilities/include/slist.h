@@ -22,10 +22,12 @@
 #define SLIST_H
 
 #include "common.h"
+#include "pool.h"
 
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * @brief Singly Linked List 
@@ -34,6 +36,19 @@ typedef struct slist_s* slist;
 
 typedef struct slist_iter_s* slist_iter;
 
+/**
+ * @brief Iterator state owned by the caller, so iterating does not need to allocate.
+ * Declare it on the stack, initialize it with slist_iter_init or slist_iter_begin
+ * and pass its address wherever an slist_iter is expected.
+ */
+typedef struct slist_iter_s
+{
+    slist                list;
+    struct slist_node_s* current;
+    struct slist_node_s* next;
+    size_t               index;
+} slist_iter_state;
+
 typedef struct slist_conf_s
 {
     void* (*mem_alloc)(size_t size);
@@ -41,6 +56,11 @@ typedef struct slist_conf_s
     void (*mem_free)(void* block);
     void (*item_copy)(const void* item, void** copy);
     void (*item_delete)(void* item);
+
+    // Optional pool to allocate list nodes from instead of mem_calloc/mem_free.
+    // Its block size must be at least slist_node_size(). The pool is not owned
+    // by the list and may be shared between lists.
+    pool node_pool;
 } slist_conf;
 
 /**
@@ -50,6 +70,13 @@ typedef struct slist_conf_s
  */
 void slist_conf_init(slist_conf* conf);
 
+/**
+ * @brief Gets the size of a single list node, for sizing a node pool.
+ * 
+ * @return size_t The size of a list node in bytes.
+ */
+size_t slist_node_size(void);
+
 /**
  * @brief Create a new Singly Linked List.
  * 
@@ -62,6 +89,8 @@ util_err_t slist_new(slist* list);
  * 
  * @param[in] conf The configuration to use.
  * @param[out] list Pointer to the created slist.
+ * @return util_err_t UTIL_OK on success, UTIL_ERR_ALLOC if the list could not
+ * be allocated, or UTIL_ERR_INVALID_ARG if the node pool blocks are too small.
  */
 util_err_t slist_new_conf(const slist_conf* const conf, slist* list);
 
@@ -76,6 +105,9 @@ void slist_delete(slist list);
 /**
  * @brief Creates a shallow copy of the list, only copies the slist but not the items
  * (the items in the list still point to the same items as the original list).
+ * The copy uses the configuration of the list. All of its nodes are allocated
+ * at once, from the node pool of the configuration or otherwise in the first slab
+ * of a node pool owned by the copy, which grows by small slabs when the copy does.
  * 
  * @param[in] list The slist to be copied.
  * @param[out] copy A pointer to where to store the copied slist.
@@ -84,10 +116,11 @@ util_err_t slist_copy_shallow(const slist list, slist* copy);
 
 /**
  * Creates a deel copy of the list, copies both slist and the items
- * using a user defined copy function.
+ * using a user defined copy function. Nodes are allocated like slist_copy_shallow.
  * 
  * @param[in] list The slist to be copied.
- * @param[in] copyFn The usder-defined function to create a deep copy of an item.
+ * @param[in] copyFn The usder-defined function to create a deep copy of an item,
+ * or NULL to use the item_copy function of the list configuration.
  * @param[out] copy A pointer to where to store the copied slist .
  */
 util_err_t slist_copy_deep(const slist list, void (copyFn)(const void* item, void** copy), slist* copy);
@@ -100,6 +133,30 @@ util_err_t slist_copy_deep(const slist list, void (copyFn)(const void* item, voi
  */
 util_err_t slist_add(slist list, void* item);
 
+/**
+ * @brief Adds multiple items to the end of the list. All nodes are allocated
+ * before the list is modified, so either all or none of the items are added.
+ * 
+ * @param[in] list The slist to add the items to.
+ * @param[in] items Array of items to add.
+ * @param[in] count The number of items in the array.
+ */
+util_err_t slist_add_range(slist list, void* const* items, size_t count);
+
+/**
+ * @brief Moves all items of other to the end of list, leaving other empty.
+ * This is O(1) if both lists allocate their nodes the same way (the same
+ * node pool, or both no pool and the same mem_free), otherwise the nodes are
+ * reallocated by list.
+ * 
+ * @param[in] list The slist to add the items to.
+ * @param[in] other The slist to move the items from.
+ * @return util_err_t UTIL_OK on success, UTIL_ERR_ALLOC if the nodes could not
+ * be reallocated (both lists are left unchanged), or UTIL_ERR_INVALID_ARG if
+ * list and other are the same list.
+ */
+util_err_t slist_splice(slist list, slist other);
+
 /**
  * @brief Removes the specified item from the list.
  * 
@@ -118,9 +175,32 @@ util_err_t slist_remove(slist list, void* item);
  */
 util_err_t slist_remove_at(slist list, size_t index);
 
+/**
+ * @brief Removes all items for which the predicate returns true in a single pass.
+ * Resources used by removed items are not freed.
+ * 
+ * @param[in] list The slist to remove the items from.
+ * @param[in] predicate Function that returns true for items to remove.
+ * @param[in] context User data passed to the predicate.
+ * @return size_t The number of removed items.
+ */
+size_t slist_remove_if(slist list, bool (predicate)(void* item, void* context), void* context);
+
+/**
+ * @brief Gets the item at the specified index.
+ * 
+ * @param[in] list The slist to get the item from.
+ * @param[in] index The index of the item.
+ * @param[out] item The item, or NULL if index is out of range.
+ * @return util_err_t UTIL_OK if the item was found, or
+ * UTIL_ERR_OUT_OF_RANGE if index is out of range.
+ */
+util_err_t slist_get_at(const slist list, size_t index, void** item);
+
 /**
  * @brief Removes all items from the list and frees resources used for list storage.
- * Resources used by items are not freed.
+ * Nodes from a node pool, including the pool owned by a copy, are returned to the
+ * pool instead of freed. Resources used by items are not freed.
  * 
  * @param[in] list The slist to clear.
  */
@@ -144,21 +224,217 @@ util_err_t  slist_iter_delete(slist_iter iter);
 util_err_t  slist_iter_next(slist_iter iter, void** item);
 size_t      slist_iter_index(const slist_iter iter);
 
-#define TYPED_SLIST(T)                                         \
-    typedef struct slist_##T* slist_##T;                       \
-    inline void               slist_##T##_new(slist_##T* list) \
-    {                                                          \
-        slist_new((slist*)list);                               \
-    }                                                          \
-                                                               \
-    inline void slist_##T##_add(slist_##T list, T* item)       \
-    {                                                          \
-        slist_add((slist)list, (void*)item);                   \
-    }                                                          \
-                                                               \
-    inline size_t slist_##T##_count(const slist_##T list)      \
-    {                                                          \
-        return slist_count((slist)list);                       \
+/**
+ * @brief Initializes a caller-owned iterator. The iterator does not need to be deleted.
+ * 
+ * @param[in] list The slist to iterate.
+ * @param[out] iter The iterator state to initialize.
+ */
+void             slist_iter_init(const slist list, slist_iter_state* iter);
+slist_iter_state slist_iter_begin(const slist list);
+
+/**
+ * @brief Iterates over all items in the list using a stack allocated iterator.
+ * 
+ * SLIST_FOREACH(item, list)
+ * {
+ *     ...
+ * }
+ * 
+ * @param item Variable of a pointer type that receives each item.
+ * @param list The slist to iterate.
+ */
+#define SLIST_FOREACH(item, list) \
+    SLIST_FOREACH_ITER(item, list, UTIL_UNIQUE_NAME(slist_foreach_iter_))
+
+#define SLIST_FOREACH_ITER(item, list, iter)                      \
+    for(slist_iter_state iter = slist_iter_begin((slist)(list));  \
+        slist_iter_next(&iter, (void**)&(item)) != UTIL_ITER_END;)
+
+/**
+ * @brief Declares slist_T, a list of T pointers, with type-safe inline
+ * wrappers for all slist functions (slist_T_new, slist_T_add, ...).
+ * The typed list can be iterated with SLIST_FOREACH using a T* item.
+ */
+#define TYPED_SLIST(T)                                                                                                                  \
+    typedef struct slist_##T* slist_##T;                                                                                                \
+    static inline util_err_t slist_##T##_new(slist_##T* list)                                                                           \
+    {                                                                                                                                   \
+        return slist_new((slist*)list);                                                                                                 \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_new_conf(const slist_conf* const conf, slist_##T* list)                                        \
+    {                                                                                                                                   \
+        return slist_new_conf(conf, (slist*)list);                                                                                      \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline void slist_##T##_delete(slist_##T list)                                                                               \
+    {                                                                                                                                   \
+        slist_delete((slist)list);                                                                                                      \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_copy_shallow(const slist_##T list, slist_##T* copy)                                            \
+    {                                                                                                                                   \
+        return slist_copy_shallow((slist)list, (slist*)copy);                                                                           \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_copy_deep(const slist_##T list, void (copyFn)(const void* item, void** copy), slist_##T* copy) \
+    {                                                                                                                                   \
+        return slist_copy_deep((slist)list, copyFn, (slist*)copy);                                                                      \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_add(slist_##T list, T* item)                                                                   \
+    {                                                                                                                                   \
+        return slist_add((slist)list, (void*)item);                                                                                     \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_add_range(slist_##T list, T* const* items, size_t count)                                       \
+    {                                                                                                                                   \
+        return slist_add_range((slist)list, (void* const*)items, count);                                                                \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_splice(slist_##T list, slist_##T other)                                                        \
+    {                                                                                                                                   \
+        return slist_splice((slist)list, (slist)other);                                                                                 \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_remove(slist_##T list, T* item)                                                                \
+    {                                                                                                                                   \
+        return slist_remove((slist)list, (void*)item);                                                                                  \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_remove_at(slist_##T list, size_t index)                                                        \
+    {                                                                                                                                   \
+        return slist_remove_at((slist)list, index);                                                                                     \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline size_t slist_##T##_remove_if(slist_##T list, bool (predicate)(void* item, void* context), void* context)              \
+    {                                                                                                                                   \
+        return slist_remove_if((slist)list, predicate, context);                                                                        \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_get_at(const slist_##T list, size_t index, T** item)                                           \
+    {                                                                                                                                   \
+        return slist_get_at((slist)list, index, (void**)item);                                                                          \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline void slist_##T##_clear(slist_##T list)                                                                                \
+    {                                                                                                                                   \
+        slist_clear((slist)list);                                                                                                       \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline size_t slist_##T##_count(const slist_##T list)                                                                        \
+    {                                                                                                                                   \
+        return slist_count((slist)list);                                                                                                \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline slist_iter_state slist_##T##_iter_begin(const slist_##T list)                                                         \
+    {                                                                                                                                   \
+        return slist_iter_begin((slist)list);                                                                                           \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static inline util_err_t slist_##T##_iter_next(slist_iter_state* iter, T** item)                                                    \
+    {                                                                                                                                   \
+        return slist_iter_next(iter, (void**)item);                                                                                     \
+    }
+
+/**
+ * @brief Declares slist_T, a list that stores T values directly in its nodes
+ * instead of pointers to them, so no separate allocation per item is needed.
+ * T must fit in a pointer. Items are compared bitwise by slist_T_remove.
+ */
+#define TYPED_SLIST_VALUE(T)                                                                                \
+    _Static_assert(sizeof(T) <= sizeof(void*), "TYPED_SLIST_VALUE requires a type that fits in a pointer"); \
+    typedef struct slist_##T* slist_##T;                                                                    \
+    static inline void* slist_##T##_pack(T value)                                                           \
+    {                                                                                                       \
+        void* item = NULL;                                                                                  \
+        memcpy(&item, &value, sizeof(T));                                                                   \
+        return item;                                                                                        \
+    }                                                                                                       \
+                                                                                                            \
+    static inline T slist_##T##_unpack(void* item)                                                          \
+    {                                                                                                       \
+        T value;                                                                                            \
+        memcpy(&value, &item, sizeof(T));                                                                   \
+        return value;                                                                                       \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_new(slist_##T* list)                                               \
+    {                                                                                                       \
+        return slist_new((slist*)list);                                                                     \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_new_conf(const slist_conf* const conf, slist_##T* list)            \
+    {                                                                                                       \
+        return slist_new_conf(conf, (slist*)list);                                                          \
+    }                                                                                                       \
+                                                                                                            \
+    static inline void slist_##T##_delete(slist_##T list)                                                   \
+    {                                                                                                       \
+        slist_delete((slist)list);                                                                          \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_copy(const slist_##T list, slist_##T* copy)                        \
+    {                                                                                                       \
+        return slist_copy_shallow((slist)list, (slist*)copy);                                               \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_add(slist_##T list, T value)                                       \
+    {                                                                                                       \
+        return slist_add((slist)list, slist_##T##_pack(value));                                             \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_splice(slist_##T list, slist_##T other)                            \
+    {                                                                                                       \
+        return slist_splice((slist)list, (slist)other);                                                     \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_remove(slist_##T list, T value)                                    \
+    {                                                                                                       \
+        return slist_remove((slist)list, slist_##T##_pack(value));                                          \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_remove_at(slist_##T list, size_t index)                            \
+    {                                                                                                       \
+        return slist_remove_at((slist)list, index);                                                         \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_get_at(const slist_##T list, size_t index, T* value)               \
+    {                                                                                                       \
+        void* item;                                                                                         \
+        util_err_t err = slist_get_at((slist)list, index, &item);                                           \
+        if(err == UTIL_OK)                                                                                  \
+        {                                                                                                   \
+            *value = slist_##T##_unpack(item);                                                              \
+        }                                                                                                   \
+        return err;                                                                                         \
+    }                                                                                                       \
+                                                                                                            \
+    static inline void slist_##T##_clear(slist_##T list)                                                    \
+    {                                                                                                       \
+        slist_clear((slist)list);                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    static inline size_t slist_##T##_count(const slist_##T list)                                            \
+    {                                                                                                       \
+        return slist_count((slist)list);                                                                    \
+    }                                                                                                       \
+                                                                                                            \
+    static inline slist_iter_state slist_##T##_iter_begin(const slist_##T list)                             \
+    {                                                                                                       \
+        return slist_iter_begin((slist)list);                                                               \
+    }                                                                                                       \
+                                                                                                            \
+    static inline util_err_t slist_##T##_iter_next(slist_iter_state* iter, T* value)                        \
+    {                                                                                                       \
+        void* item;                                                                                         \
+        util_err_t err = slist_iter_next(iter, &item);                                                      \
+        if(err == UTIL_OK)                                                                                  \
+        {                                                                                                   \
+            *value = slist_##T##_unpack(item);                                                              \
+        }                                                                                                   \
+        return err;                                                                                         \
     }
 
 #endif // SLIST_H
\ No newline at end of file
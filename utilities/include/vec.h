@@ -0,0 +1,270 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef VEC_H
+#define VEC_H
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Vector
+ * 
+ * Growable array that stores its items by value in a single contiguous
+ * block of memory.
+ */
+typedef struct vec_s* vec;
+
+typedef struct vec_conf_s
+{
+    void* (*mem_alloc)(size_t size);
+    void* (*mem_realloc)(void* block, size_t size);
+    void (*mem_free)(void* block);
+} vec_conf;
+
+/**
+ * @brief Initializes a configuration object with default values.
+ * 
+ * @param[out] conf The configuration object to initialize.
+ */
+void vec_conf_init(vec_conf* conf);
+
+/**
+ * @brief Create a new Vector.
+ * 
+ * @param[in] item_size The size of a single item in bytes.
+ * @param[out] v Pointer to the created vec.
+ */
+util_err_t vec_new(size_t item_size, vec* v);
+
+/**
+ * @brief Create a new Vector using the specified configuration.
+ * 
+ * @param[in] conf The configuration to use.
+ * @param[in] item_size The size of a single item in bytes.
+ * @param[out] v Pointer to the created vec.
+ */
+util_err_t vec_new_conf(const vec_conf* const conf, size_t item_size, vec* v);
+
+/**
+ * @brief Deletes the Vector and frees all of its resources.
+ * 
+ * @param[in] v The vec to delete.
+ */
+void vec_delete(vec v);
+
+/**
+ * @brief Copies the vector and all its items.
+ * 
+ * @param[in] v The vec to be copied.
+ * @param[out] copy A pointer to where to store the copied vec.
+ */
+util_err_t vec_copy(const vec v, vec* copy);
+
+/**
+ * @brief Ensures the vector can hold the specified number of items without
+ * reallocating.
+ * 
+ * @param[in] v The vec.
+ * @param[in] capacity The number of items to reserve room for.
+ */
+util_err_t vec_reserve(vec v, size_t capacity);
+
+/**
+ * @brief Add a copy of an item to the end of the vector.
+ * 
+ * @param[in] v The vec to add the item to.
+ * @param[in] item Pointer to the item to copy into the vector.
+ */
+util_err_t vec_push(vec v, const void* item);
+
+/**
+ * @brief Removes the last item from the vector.
+ * 
+ * @param[in] v The vec to remove the item from.
+ * @param[out] item Where to copy the removed item to, or NULL.
+ * @return util_err_t UTIL_OK if an item was removed, or
+ * UTIL_ERR_OUT_OF_RANGE if the vector is empty.
+ */
+util_err_t vec_pop(vec v, void* item);
+
+/**
+ * @brief Inserts a copy of an item at the specified index, moving all
+ * following items up by one.
+ * 
+ * @param[in] v The vec to insert the item into.
+ * @param[in] index The index to insert at, at most the number of items.
+ * @param[in] item Pointer to the item to copy into the vector.
+ */
+util_err_t vec_insert(vec v, size_t index, const void* item);
+
+/**
+ * @brief Removes the item at the specified index, moving all following items
+ * down by one so the order is preserved.
+ * 
+ * @param[in] v The vec to remove the item from.
+ * @param[in] index The index of the item to remove.
+ */
+util_err_t vec_remove_at(vec v, size_t index);
+
+/**
+ * @brief Removes the item at the specified index in O(1) by moving the last
+ * item into its place. The order of the items is not preserved.
+ * 
+ * @param[in] v The vec to remove the item from.
+ * @param[in] index The index of the item to remove.
+ */
+util_err_t vec_swap_remove(vec v, size_t index);
+
+/**
+ * @brief Removes all items from the vector. The vector keeps its capacity.
+ * 
+ * @param[in] v The vec to clear.
+ */
+void vec_clear(vec v);
+
+/**
+ * @brief Gets a pointer to the item at the specified index. The pointer is
+ * invalidated by any call that adds items to the vector.
+ * 
+ * @param[in] v The vec.
+ * @param[in] index The index of the item.
+ * @return void* Pointer to the item, or NULL if index is out of range.
+ */
+void* vec_at(const vec v, size_t index);
+
+/**
+ * @brief Gets a pointer to the first item, items are stored contiguously.
+ * 
+ * @param[in] v The vec.
+ * @return void* Pointer to the items, or NULL if no memory is allocated yet.
+ */
+void* vec_data(const vec v);
+
+/**
+ * @brief Gets the number of items in the vector.
+ * 
+ * @param[in] v The vec to get the count of.
+ * 
+ * @return size_t The number of items in the vector.
+ */
+size_t vec_count(const vec v);
+
+/**
+ * @brief Gets the number of items the vector can hold without reallocating.
+ * 
+ * @param[in] v The vec to get the capacity of.
+ * 
+ * @return size_t The capacity of the vector.
+ */
+size_t vec_capacity(const vec v);
+
+/**
+ * @brief Searches a vector that is sorted according to compare.
+ * 
+ * @param[in] v The sorted vec.
+ * @param[in] key The key to search for.
+ * @param[in] compare Compares the key to an item, returning a negative value,
+ * zero or a positive value if the key orders before, equal to or after the item.
+ * @param[out] index The index of the first matching item if found, otherwise
+ * the index where the key would have to be inserted to keep the vector sorted.
+ * @return util_err_t UTIL_OK if a matching item was found, or
+ * UTIL_ERR_NOT_FOUND if not.
+ */
+util_err_t vec_bsearch(const vec v, const void* key, int (*compare)(const void* key, const void* item), size_t* index);
+
+/**
+ * @brief Iterates over pointers to all items in the vector.
+ * 
+ * @param T The item type.
+ * @param item Name of the T* variable that points to each item.
+ * @param v The vec to iterate.
+ */
+#define VEC_FOREACH(T, item, v) \
+    VEC_FOREACH_END(T, item, v, UTIL_UNIQUE_NAME(vec_foreach_end_))
+
+#define VEC_FOREACH_END(T, item, v, end)                                                 \
+    for(T *item = (T*)vec_data((vec)(v)), *end = item + vec_count((vec)(v)); item < end; item++)
+
+#define TYPED_VEC(T)                                                            \
+    typedef struct vec_##T* vec_##T;                                            \
+    static inline util_err_t vec_##T##_new(vec_##T* v)                          \
+    {                                                                           \
+        return vec_new(sizeof(T), (vec*)v);                                     \
+    }                                                                           \
+                                                                                \
+    static inline void vec_##T##_delete(vec_##T v)                              \
+    {                                                                           \
+        vec_delete((vec)v);                                                     \
+    }                                                                           \
+                                                                                \
+    static inline util_err_t vec_##T##_reserve(vec_##T v, size_t capacity)      \
+    {                                                                           \
+        return vec_reserve((vec)v, capacity);                                   \
+    }                                                                           \
+                                                                                \
+    static inline util_err_t vec_##T##_push(vec_##T v, T item)                  \
+    {                                                                           \
+        return vec_push((vec)v, &item);                                         \
+    }                                                                           \
+                                                                                \
+    static inline util_err_t vec_##T##_pop(vec_##T v, T* item)                  \
+    {                                                                           \
+        return vec_pop((vec)v, item);                                           \
+    }                                                                           \
+                                                                                \
+    static inline util_err_t vec_##T##_insert(vec_##T v, size_t index, T item)  \
+    {                                                                           \
+        return vec_insert((vec)v, index, &item);                                \
+    }                                                                           \
+                                                                                \
+    static inline util_err_t vec_##T##_remove_at(vec_##T v, size_t index)       \
+    {                                                                           \
+        return vec_remove_at((vec)v, index);                                    \
+    }                                                                           \
+                                                                                \
+    static inline util_err_t vec_##T##_swap_remove(vec_##T v, size_t index)     \
+    {                                                                           \
+        return vec_swap_remove((vec)v, index);                                  \
+    }                                                                           \
+                                                                                \
+    static inline T* vec_##T##_at(const vec_##T v, size_t index)                \
+    {                                                                           \
+        return (T*)vec_at((vec)v, index);                                       \
+    }                                                                           \
+                                                                                \
+    static inline T* vec_##T##_data(const vec_##T v)                            \
+    {                                                                           \
+        return (T*)vec_data((vec)v);                                            \
+    }                                                                           \
+                                                                                \
+    static inline size_t vec_##T##_count(const vec_##T v)                      \
+    {                                                                           \
+        return vec_count((vec)v);                                               \
+    }                                                                           \
+                                                                                \
+    static inline void vec_##T##_clear(vec_##T v)                              \
+    {                                                                           \
+        vec_clear((vec)v);                                                      \
+    }
+
+#endif // VEC_H
\ No newline at end of file
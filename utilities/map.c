@@ -20,142 +20,418 @@
  */
 #include "include/map.h"
 
-#include "include/slist.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest table that is allocated once the first entry is added
+#define MAP_MIN_CAPACITY 8
 
 typedef struct map_entry_s
 {
-    void const* key;
-    void const* value;
-} * map_entry;
+    size_t      hash; // 0 marks an empty slot
+    const void* key;
+    const void* value;
+} map_entry;
 
 struct map_s
 {
-    slist entries;
+    map_entry* entries;
+    size_t     capacity; // Always 0 or a power of 2
+    size_t     count;
+    map_conf   conf;
 };
 
-struct map_iter_s
+/*
+ * Private Methods
+ */
+static size_t hash_key(const map m, const void* key)
 {
-    map        m;
-    slist_iter iter;
-};
+    size_t hash = m->conf.key_hash(key);
+
+    // 0 is reserved for empty slots
+    return hash == 0 ? 1 : hash;
+}
 
-void map_new(map* m)
+static bool exceeds_load_factor(size_t count, size_t capacity)
 {
-    map newMap = (map)calloc(1, sizeof(*newMap));
-    
-    slist_new(&newMap->entries);
+    // Keep the table at most 3/4 full so probe sequences stay short
+    return count > capacity - capacity / 4;
+}
 
-    *m = newMap;
+static bool find_slot(const map m, const void* key, size_t hash, size_t* index)
+{
+    if(m->capacity == 0)
+    {
+        *index = 0;
+        return false;
+    }
+
+    size_t mask = m->capacity - 1;
+    size_t i = hash & mask;
+
+    // The load factor guarantees there is always an empty slot to stop at
+    while(m->entries[i].hash != 0)
+    {
+        if(m->entries[i].hash == hash && m->conf.key_equals(m->entries[i].key, key))
+        {
+            *index = i;
+            return true;
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    *index = i;
+    return false;
 }
 
-void map_copy(map m, map* copy)
+static util_err_t resize(map m, size_t capacity)
 {
-    map newMap = (map)calloc(1, sizeof(*newMap));
+    map_entry* entries = (map_entry*)m->conf.mem_calloc(capacity, sizeof(*entries));
 
-    slist_copy_shallow(m->entries, &newMap->entries);
+    if(entries == NULL)
+    {
+        return UTIL_ERR_ALLOC;
+    }
 
-    *copy = newMap;
+    // Re-insert all entries, keys are unique so no comparisons are needed
+    size_t mask = capacity - 1;
+    for(size_t i = 0; i < m->capacity; i++)
+    {
+        if(m->entries[i].hash != 0)
+        {
+            size_t j = m->entries[i].hash & mask;
+            while(entries[j].hash != 0)
+            {
+                j = (j + 1) & mask;
+            }
+
+            entries[j] = m->entries[i];
+        }
+    }
+
+    if(m->entries != NULL)
+    {
+        m->conf.mem_free(m->entries);
+    }
+
+    m->entries = entries;
+    m->capacity = capacity;
+
+    return UTIL_OK;
 }
 
-void map_add(map m, void const* key, void const* value)
+static void remove_slot(map m, size_t i)
 {
-    map_entry newEntry = (map_entry)malloc(sizeof(*newEntry));
+    size_t mask = m->capacity - 1;
+    size_t j = i;
 
-    newEntry->key = key;
-    newEntry->value = value;
+    // Backward shift deletion: move following entries of the probe sequence
+    // into the hole so no tombstones are needed
+    for(;;)
+    {
+        j = (j + 1) & mask;
+
+        if(m->entries[j].hash == 0)
+        {
+            break;
+        }
 
-    slist_add(m->entries, newEntry);
+        // Entries whose home slot lies cyclically in (i, j] must stay where they are
+        size_t home = m->entries[j].hash & mask;
+        if(i <= j ? (i < home && home <= j) : (i < home || home <= j))
+        {
+            continue;
+        }
+
+        m->entries[i] = m->entries[j];
+        i = j;
+    }
+
+    m->entries[i].hash = 0;
+    m->entries[i].key = NULL;
+    m->entries[i].value = NULL;
+    m->count--;
+}
+
+/*
+ * Public Methods
+ */
+void map_conf_init(map_conf* conf)
+{
+    conf->mem_alloc = malloc;
+    conf->mem_calloc = calloc;
+    conf->mem_free = free;
+    conf->key_hash = map_hash_ptr;
+    conf->key_equals = map_equals_ptr;
+}
+
+size_t map_hash_ptr(const void* key)
+{
+    uintptr_t x = (uintptr_t)key;
+
+    // Finalizer of MurmurHash3, mixes the aligned low bits into the whole word
+#if UINTPTR_MAX > 0xFFFFFFFFu
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+#else
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+#endif
+
+    return (size_t)x;
+}
+
+bool map_equals_ptr(const void* key1, const void* key2)
+{
+    return key1 == key2;
 }
 
-void map_get(map m, const void* key, void const** value)
+size_t map_hash_str(const void* key)
 {
-    if (slist_count(m->entries) == 0)
+    // FNV-1a
+    const unsigned char* str = (const unsigned char*)key;
+    uint32_t hash = 2166136261u;
+
+    while(*str != '\0')
     {
-        *value = NULL;
-        return;
+        hash ^= *str++;
+        hash *= 16777619u;
+    }
+
+    return (size_t)hash;
+}
+
+bool map_equals_str(const void* key1, const void* key2)
+{
+    return key1 == key2 || strcmp((const char*)key1, (const char*)key2) == 0;
+}
+
+util_err_t map_new(map* m)
+{
+    map_conf conf;
+    map_conf_init(&conf);
+    return map_new_conf(&conf, m);
+}
+
+util_err_t map_new_conf(const map_conf* const conf, map* m)
+{
+    map newMap = (map)conf->mem_calloc(1, sizeof(*newMap));
+
+    if(newMap == NULL)
+    {
+        *m = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    newMap->conf = *conf;
+
+    *m = newMap;
+    return UTIL_OK;
+}
+
+void map_delete(map m)
+{
+    if(m->entries != NULL)
+    {
+        m->conf.mem_free(m->entries);
     }
 
-    slist_iter iter;
-    slist_iter_new(m->entries, &iter);
+    m->conf.mem_free(m);
+}
+
+util_err_t map_copy(const map m, map* copy)
+{
+    map newMap;
+    util_err_t err = map_new_conf(&m->conf, &newMap);
+
+    if(err != UTIL_OK)
+    {
+        *copy = NULL;
+        return err;
+    }
 
-    map_entry entry;
-    do
+    if(m->capacity > 0)
     {
-        // Get the next entry in the list
-        slist_iter_next(iter, (void**)(&entry));
+        newMap->entries = (map_entry*)m->conf.mem_alloc(m->capacity * sizeof(*newMap->entries));
 
-        // If this entry's key matches, return the value
-        if (entry->key == key)
+        if(newMap->entries == NULL)
         {
-            *value = entry->value;
-            return;
+            map_delete(newMap);
+            *copy = NULL;
+            return UTIL_ERR_ALLOC;
         }
 
-    } while (slist_iter_index(iter) < slist_count(m->entries));
+        memcpy(newMap->entries, m->entries, m->capacity * sizeof(*newMap->entries));
+        newMap->capacity = m->capacity;
+        newMap->count = m->count;
+    }
 
-    // Key not found
-    *value = NULL;
+    *copy = newMap;
+    return UTIL_OK;
 }
 
-void map_remove(map m, const void* key)
+util_err_t map_reserve(map m, size_t count)
 {
-    if (slist_count(m->entries) == 0)
+    size_t capacity = m->capacity == 0 ? MAP_MIN_CAPACITY : m->capacity;
+
+    while(exceeds_load_factor(count, capacity))
     {
-        return;
+        if(capacity > SIZE_MAX / 2)
+        {
+            // Doubling would wrap around, no table can hold that many entries
+            return UTIL_ERR_ALLOC;
+        }
+
+        capacity *= 2;
     }
 
-    slist_iter iter;
-    slist_iter_new(m->entries, &iter);
+    if(capacity == m->capacity)
+    {
+        return UTIL_OK;
+    }
+
+    return resize(m, capacity);
+}
+
+util_err_t map_add(map m, const void* key, const void* value)
+{
+    size_t hash = hash_key(m, key);
+    size_t index;
+
+    if(find_slot(m, key, hash, &index))
+    {
+        // Key already present, replace its value
+        m->entries[index].value = value;
+        return UTIL_OK;
+    }
 
-    map_entry entry;
-    do
+    if(m->capacity == 0 || exceeds_load_factor(m->count + 1, m->capacity))
     {
-        // Get the next entry in the list
-        slist_iter_next(iter, (void**)(&entry));
+        util_err_t err = map_reserve(m, m->count + 1);
 
-        // If this entry's key matches, return the value
-        if (entry->key == key)
+        if(err != UTIL_OK)
         {
-            slist_remove_at(m->entries, slist_iter_index(iter));
-            return;
+            return err;
         }
 
-    } while (slist_iter_index(iter) < slist_count(m->entries));
+        // The table changed, find the empty slot again
+        find_slot(m, key, hash, &index);
+    }
+
+    m->entries[index].hash = hash;
+    m->entries[index].key = key;
+    m->entries[index].value = value;
+    m->count++;
+
+    return UTIL_OK;
+}
+
+util_err_t map_get(const map m, const void* key, const void** value)
+{
+    size_t index;
+
+    if(!find_slot(m, key, hash_key(m, key), &index))
+    {
+        *value = NULL;
+        return UTIL_ERR_NOT_FOUND;
+    }
+
+    *value = m->entries[index].value;
+    return UTIL_OK;
+}
+
+util_err_t map_remove(map m, const void* key)
+{
+    size_t index;
+
+    if(!find_slot(m, key, hash_key(m, key), &index))
+    {
+        return UTIL_ERR_NOT_FOUND;
+    }
+
+    remove_slot(m, index);
+
+    return UTIL_OK;
+}
+
+void map_clear(map m)
+{
+    if(m->entries != NULL)
+    {
+        memset(m->entries, 0, m->capacity * sizeof(*m->entries));
+    }
+
+    m->count = 0;
 }
 
 size_t map_count(const map m)
 {
-    return slist_count(m->entries);
+    return m->count;
 }
 
-void map_iter_new(const map map, map_iter* iter)
+util_err_t map_iter_new(const map map, map_iter* iter)
 {
-    map_iter newIter = (map_iter)malloc(sizeof(*newIter));
+    map_iter newIter = (map_iter)map->conf.mem_alloc(sizeof(*newIter));
 
-    newIter->m = map;
-    slist_iter_new(map->entries, &newIter->iter);
+    if(newIter == NULL)
+    {
+        *iter = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    map_iter_init(map, newIter);
 
     *iter = newIter;
+
+    return UTIL_OK;
+}
+
+void map_iter_init(const map map, map_iter_state* iter)
+{
+    iter->m = map;
+    iter->index = 0;
+}
+
+map_iter_state map_iter_begin(const map map)
+{
+    map_iter_state iter;
+    map_iter_init(map, &iter);
+    return iter;
 }
 
 void map_iter_delete(map_iter iter)
 {
-    free(iter);
+    iter->m->conf.mem_free(iter);
 }
 
-void map_iter_next(map_iter iter, void** key, void** value)
+util_err_t map_iter_next(map_iter iter, void** key, void** value)
 {
-    map_entry entry;
-    slist_iter_next(iter->iter, (void**)&entry);
+    map m = iter->m;
 
-    if(entry == NULL)
+    // Skip empty slots
+    while(iter->index < m->capacity && m->entries[iter->index].hash == 0)
     {
-        *key = NULL;
-        *value = NULL;
+        iter->index++;
     }
-    else
+
+    if(iter->index >= m->capacity)
     {
-        *key = entry->key;
-        *value = entry->value;
+        *key = NULL;
+        *value = NULL;
+        return UTIL_ITER_END;
     }
+
+    *key = (void*)m->entries[iter->index].key;
+    *value = (void*)m->entries[iter->index].value;
+    iter->index++;
+
+    return UTIL_OK;
 }
\ No newline at end of file
@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "include/mpmcq.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slots are aligned so they can hold any type
+#define MPMCQ_ALIGN         8
+#define MPMCQ_ALIGN_UP(x)   (((x) + MPMCQ_ALIGN - 1) & ~(size_t)(MPMCQ_ALIGN - 1))
+
+// Keeps the producer and consumer positions on separate cache lines
+#define MPMCQ_CACHE_LINE 64
+
+// Each slot has a sequence number that tells which lap of the queue it is on:
+// position when it is free to write, position + 1 when it holds data.
+typedef struct mpmcq_slot_s
+{
+    atomic_size_t sequence;
+    size_t        position;
+} mpmcq_slot;
+
+#define MPMCQ_HEADER_SIZE MPMCQ_ALIGN_UP(sizeof(mpmcq_slot))
+
+struct mpmcq_s
+{
+    // Producer side
+    atomic_size_t enqueue_pos;
+    uint8_t       producer_pad_[MPMCQ_CACHE_LINE - sizeof(atomic_size_t)];
+
+    // Consumer side
+    atomic_size_t dequeue_pos;
+    uint8_t       consumer_pad_[MPMCQ_CACHE_LINE - sizeof(atomic_size_t)];
+
+    uint8_t*   buffer;
+    size_t     stride;
+    size_t     slot_size;
+    size_t     mask;
+    mpmcq_conf conf;
+};
+
+/*
+ * Private Methods
+ */
+static inline mpmcq_slot* slot_at(const mpmcq q, size_t position)
+{
+    return (mpmcq_slot*)(q->buffer + (position & q->mask) * q->stride);
+}
+
+static inline mpmcq_slot* slot_of(void* data)
+{
+    return (mpmcq_slot*)((uint8_t*)data - MPMCQ_HEADER_SIZE);
+}
+
+static inline void* data_of(mpmcq_slot* slot)
+{
+    return (uint8_t*)slot + MPMCQ_HEADER_SIZE;
+}
+
+/*
+ * Public Methods
+ */
+void mpmcq_conf_init(mpmcq_conf* conf)
+{
+    conf->mem_alloc = malloc;
+    conf->mem_free = free;
+}
+
+util_err_t mpmcq_new(size_t slot_size, size_t slots, mpmcq* q)
+{
+    mpmcq_conf conf;
+    mpmcq_conf_init(&conf);
+    return mpmcq_new_conf(&conf, slot_size, slots, q);
+}
+
+util_err_t mpmcq_new_conf(const mpmcq_conf* const conf, size_t slot_size, size_t slots, mpmcq* q)
+{
+    size_t capacity = 2;
+    while(capacity < slots)
+    {
+        capacity *= 2;
+    }
+
+    mpmcq newQ = (mpmcq)conf->mem_alloc(sizeof(*newQ));
+
+    if(newQ == NULL)
+    {
+        *q = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    newQ->stride = MPMCQ_HEADER_SIZE + MPMCQ_ALIGN_UP(slot_size);
+    newQ->buffer = (uint8_t*)conf->mem_alloc(capacity * newQ->stride);
+
+    if(newQ->buffer == NULL)
+    {
+        conf->mem_free(newQ);
+        *q = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    atomic_init(&newQ->enqueue_pos, 0);
+    atomic_init(&newQ->dequeue_pos, 0);
+    newQ->slot_size = slot_size;
+    newQ->mask = capacity - 1;
+    newQ->conf = *conf;
+
+    for(size_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&slot_at(newQ, i)->sequence, i);
+    }
+
+    *q = newQ;
+    return UTIL_OK;
+}
+
+void mpmcq_delete(mpmcq q)
+{
+    q->conf.mem_free(q->buffer);
+    q->conf.mem_free(q);
+}
+
+util_err_t mpmcq_reserve(mpmcq q, void** slot)
+{
+    size_t position = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    mpmcq_slot* s;
+
+    for(;;)
+    {
+        s = slot_at(q, position);
+        size_t sequence = atomic_load_explicit(&s->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+
+        if(diff == 0)
+        {
+            // The slot is free on this lap, try to claim it
+            if(atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            // The slot still holds data from the previous lap
+            *slot = NULL;
+            return UTIL_ERR_FULL;
+        }
+        else
+        {
+            // Another producer claimed the slot first
+            position = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    s->position = position;
+    *slot = data_of(s);
+
+    return UTIL_OK;
+}
+
+void mpmcq_commit(mpmcq q, void* slot)
+{
+    (void)q;
+    mpmcq_slot* s = slot_of(slot);
+
+    // The release makes the slot contents visible before the new sequence
+    atomic_store_explicit(&s->sequence, s->position + 1, memory_order_release);
+}
+
+util_err_t mpmcq_acquire(mpmcq q, void** slot)
+{
+    size_t position = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    mpmcq_slot* s;
+
+    for(;;)
+    {
+        s = slot_at(q, position);
+        size_t sequence = atomic_load_explicit(&s->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(position + 1);
+
+        if(diff == 0)
+        {
+            // The slot is published, try to claim it
+            if(atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            // The slot is free or still being written
+            *slot = NULL;
+            return UTIL_ERR_EMPTY;
+        }
+        else
+        {
+            // Another consumer claimed the slot first
+            position = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    s->position = position;
+    *slot = data_of(s);
+
+    return UTIL_OK;
+}
+
+void mpmcq_release(mpmcq q, void* slot)
+{
+    mpmcq_slot* s = slot_of(slot);
+
+    // Free the slot for the producers on the next lap
+    atomic_store_explicit(&s->sequence, s->position + q->mask + 1, memory_order_release);
+}
+
+size_t mpmcq_slot_size(const mpmcq q)
+{
+    return q->slot_size;
+}
+
+size_t mpmcq_capacity(const mpmcq q)
+{
+    return q->mask + 1;
+}
+
+size_t mpmcq_count(const mpmcq q)
+{
+    size_t enqueuePos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    size_t dequeuePos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+
+    // The positions are read separately, so they can briefly be out of order
+    return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+}
\ No newline at end of file
@@ -0,0 +1,490 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "include/omap.h"
+#include "include/pool.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Enough levels for about 16 million entries with a 1/4 promotion chance
+#define OMAP_MAX_LEVEL 12
+
+#define OMAP_DEFAULT_NODES_PER_SLAB 16
+
+typedef struct omap_node_s
+{
+    const void*          value;
+    size_t               level;
+    struct omap_node_s*  next[]; // level pointers, followed by the key area
+} omap_node;
+
+struct omap_s
+{
+    omap_node* head; // Sentinel with OMAP_MAX_LEVEL pointers and no key
+    size_t     level;
+    size_t     count;
+    size_t     key_area;
+    uint32_t   seed;
+    pool       node_pools[OMAP_MAX_LEVEL]; // Created on first use, index is level - 1
+    omap_conf  conf;
+};
+
+/*
+ * Private Methods
+ */
+static size_t node_size(const omap m, size_t level)
+{
+    return sizeof(omap_node) + level * sizeof(omap_node*) + m->key_area;
+}
+
+static void* node_key_area(omap_node* node)
+{
+    return &node->next[node->level];
+}
+
+static const void* node_key(const omap m, omap_node* node)
+{
+    if(m->conf.key_size > 0)
+    {
+        return node_key_area(node);
+    }
+
+    return *(const void**)node_key_area(node);
+}
+
+static int compare_node(const omap m, omap_node* node, const void* key)
+{
+    return m->conf.key_compare(node_key(m, node), key);
+}
+
+static size_t random_level(omap m)
+{
+    // xorshift32, only needs to be cheap and evenly distributed
+    uint32_t x = m->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m->seed = x;
+
+    // Promote with a chance of 1/4 per level
+    size_t level = 1;
+    while(level < OMAP_MAX_LEVEL && (x & 3) == 0)
+    {
+        level++;
+        x >>= 2;
+    }
+
+    return level;
+}
+
+static omap_node* alloc_node(omap m, size_t level)
+{
+    pool* nodePool = &m->node_pools[level - 1];
+
+    if(*nodePool == NULL)
+    {
+        // Higher levels are rare, so give them proportionally smaller slabs
+        size_t blocksPerSlab = m->conf.nodes_per_slab >> (2 * (level - 1));
+
+        pool_conf conf;
+        pool_conf_init(&conf, node_size(m, level), blocksPerSlab > 0 ? blocksPerSlab : 1);
+        conf.mem_alloc = m->conf.mem_alloc;
+        conf.mem_free = m->conf.mem_free;
+
+        if(pool_new_conf(&conf, nodePool) != UTIL_OK)
+        {
+            *nodePool = NULL;
+            return NULL;
+        }
+    }
+
+    omap_node* node = (omap_node*)pool_alloc(*nodePool);
+
+    if(node != NULL)
+    {
+        node->level = level;
+    }
+
+    return node;
+}
+
+static void free_node(omap m, omap_node* node)
+{
+    pool_free(m->node_pools[node->level - 1], node);
+}
+
+// Finds the last node at every level whose key orders before key, or not after key if inclusive
+static omap_node* find_predecessors(const omap m, const void* key, bool inclusive, omap_node** update)
+{
+    omap_node* node = m->head;
+
+    for(size_t i = m->level; i-- > 0;)
+    {
+        while(node->next[i] != NULL)
+        {
+            int cmp = compare_node(m, node->next[i], key);
+            if(cmp > 0 || (cmp == 0 && !inclusive))
+            {
+                break;
+            }
+
+            node = node->next[i];
+        }
+
+        if(update != NULL)
+        {
+            update[i] = node;
+        }
+    }
+
+    return node;
+}
+
+static omap_node* find_node(const omap m, const void* key)
+{
+    omap_node* node = find_predecessors(m, key, false, NULL)->next[0];
+
+    if(node != NULL && compare_node(m, node, key) == 0)
+    {
+        return node;
+    }
+
+    return NULL;
+}
+
+static void iter_start(const omap m, omap_node* node, const void* end_key, omap_iter_state* iter)
+{
+    iter->m = m;
+    iter->node = node;
+    iter->end_key = end_key;
+}
+
+/*
+ * Public Methods
+ */
+void omap_conf_init(omap_conf* conf, omap_compare_t key_compare, size_t key_size)
+{
+    conf->mem_alloc = malloc;
+    conf->mem_free = free;
+    conf->key_compare = key_compare;
+    conf->key_size = key_size;
+    conf->nodes_per_slab = OMAP_DEFAULT_NODES_PER_SLAB;
+}
+
+int omap_compare_str(const void* key1, const void* key2)
+{
+    return strcmp((const char*)key1, (const char*)key2);
+}
+
+// Keys copied into the nodes are only pointer aligned, so read them with memcpy
+#define OMAP_COMPARE_INTEGER(type, key1, key2) \
+    type a, b;                                 \
+    memcpy(&a, key1, sizeof(type));            \
+    memcpy(&b, key2, sizeof(type));            \
+    return (a > b) - (a < b)
+
+int omap_compare_i32(const void* key1, const void* key2)
+{
+    OMAP_COMPARE_INTEGER(int32_t, key1, key2);
+}
+
+int omap_compare_u32(const void* key1, const void* key2)
+{
+    OMAP_COMPARE_INTEGER(uint32_t, key1, key2);
+}
+
+int omap_compare_i64(const void* key1, const void* key2)
+{
+    OMAP_COMPARE_INTEGER(int64_t, key1, key2);
+}
+
+int omap_compare_u64(const void* key1, const void* key2)
+{
+    OMAP_COMPARE_INTEGER(uint64_t, key1, key2);
+}
+
+util_err_t omap_new(const omap_conf* const conf, omap* m)
+{
+    if(conf->key_compare == NULL)
+    {
+        *m = NULL;
+        return UTIL_ERR_INVALID_ARG;
+    }
+
+    omap newMap = (omap)conf->mem_alloc(sizeof(*newMap));
+
+    if(newMap == NULL)
+    {
+        *m = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    memset(newMap, 0, sizeof(*newMap));
+    newMap->conf = *conf;
+    newMap->level = 1;
+    newMap->seed = (uint32_t)(uintptr_t)newMap | 1;
+
+    // Round the key area up so nodes stay pointer aligned
+    size_t keySize = conf->key_size > 0 ? conf->key_size : sizeof(void*);
+    newMap->key_area = (keySize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    newMap->head = (omap_node*)conf->mem_alloc(sizeof(omap_node) + OMAP_MAX_LEVEL * sizeof(omap_node*));
+
+    if(newMap->head == NULL)
+    {
+        conf->mem_free(newMap);
+        *m = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    newMap->head->value = NULL;
+    newMap->head->level = OMAP_MAX_LEVEL;
+    for(size_t i = 0; i < OMAP_MAX_LEVEL; i++)
+    {
+        newMap->head->next[i] = NULL;
+    }
+
+    *m = newMap;
+
+    return UTIL_OK;
+}
+
+void omap_delete(omap m)
+{
+    // Deleting the pools frees all nodes at once
+    for(size_t i = 0; i < OMAP_MAX_LEVEL; i++)
+    {
+        if(m->node_pools[i] != NULL)
+        {
+            pool_delete(m->node_pools[i]);
+        }
+    }
+
+    m->conf.mem_free(m->head);
+    m->conf.mem_free(m);
+}
+
+util_err_t omap_put(omap m, const void* key, const void* value)
+{
+    omap_node* update[OMAP_MAX_LEVEL];
+    omap_node* node = find_predecessors(m, key, false, update)->next[0];
+
+    if(node != NULL && compare_node(m, node, key) == 0)
+    {
+        node->value = value;
+        return UTIL_OK;
+    }
+
+    size_t level = random_level(m);
+    node = alloc_node(m, level);
+
+    if(node == NULL)
+    {
+        return UTIL_ERR_ALLOC;
+    }
+
+    node->value = value;
+    if(m->conf.key_size > 0)
+    {
+        memcpy(node_key_area(node), key, m->conf.key_size);
+    }
+    else
+    {
+        *(const void**)node_key_area(node) = key;
+    }
+
+    if(level > m->level)
+    {
+        for(size_t i = m->level; i < level; i++)
+        {
+            update[i] = m->head;
+        }
+        m->level = level;
+    }
+
+    for(size_t i = 0; i < level; i++)
+    {
+        node->next[i] = update[i]->next[i];
+        update[i]->next[i] = node;
+    }
+
+    m->count++;
+
+    return UTIL_OK;
+}
+
+util_err_t omap_get(const omap m, const void* key, const void** value)
+{
+    omap_node* node = find_node(m, key);
+
+    if(node == NULL)
+    {
+        *value = NULL;
+        return UTIL_ERR_NOT_FOUND;
+    }
+
+    *value = node->value;
+
+    return UTIL_OK;
+}
+
+util_err_t omap_remove(omap m, const void* key)
+{
+    omap_node* update[OMAP_MAX_LEVEL];
+    omap_node* node = find_predecessors(m, key, false, update)->next[0];
+
+    if(node == NULL || compare_node(m, node, key) != 0)
+    {
+        return UTIL_ERR_NOT_FOUND;
+    }
+
+    for(size_t i = 0; i < node->level; i++)
+    {
+        update[i]->next[i] = node->next[i];
+    }
+
+    while(m->level > 1 && m->head->next[m->level - 1] == NULL)
+    {
+        m->level--;
+    }
+
+    free_node(m, node);
+    m->count--;
+
+    return UTIL_OK;
+}
+
+util_err_t omap_first(const omap m, const void** key, const void** value)
+{
+    omap_node* node = m->head->next[0];
+
+    if(node == NULL)
+    {
+        *key = NULL;
+        *value = NULL;
+        return UTIL_ERR_NOT_FOUND;
+    }
+
+    *key = node_key(m, node);
+    *value = node->value;
+
+    return UTIL_OK;
+}
+
+util_err_t omap_last(const omap m, const void** key, const void** value)
+{
+    omap_node* node = m->head;
+
+    for(size_t i = m->level; i-- > 0;)
+    {
+        while(node->next[i] != NULL)
+        {
+            node = node->next[i];
+        }
+    }
+
+    if(node == m->head)
+    {
+        *key = NULL;
+        *value = NULL;
+        return UTIL_ERR_NOT_FOUND;
+    }
+
+    *key = node_key(m, node);
+    *value = node->value;
+
+    return UTIL_OK;
+}
+
+void omap_clear(omap m)
+{
+    omap_node* node = m->head->next[0];
+
+    while(node != NULL)
+    {
+        omap_node* next = node->next[0];
+        free_node(m, node);
+        node = next;
+    }
+
+    for(size_t i = 0; i < OMAP_MAX_LEVEL; i++)
+    {
+        m->head->next[i] = NULL;
+    }
+
+    m->level = 1;
+    m->count = 0;
+}
+
+size_t omap_count(const omap m)
+{
+    return m->count;
+}
+
+/*
+ * Itterators
+ */
+void omap_iter_first(const omap m, omap_iter_state* iter)
+{
+    iter_start(m, m->head->next[0], NULL, iter);
+}
+
+omap_iter_state omap_iter_begin(const omap m)
+{
+    omap_iter_state iter;
+    omap_iter_first(m, &iter);
+    return iter;
+}
+
+void omap_iter_lower_bound(const omap m, const void* key, omap_iter_state* iter)
+{
+    iter_start(m, find_predecessors(m, key, false, NULL)->next[0], NULL, iter);
+}
+
+void omap_iter_upper_bound(const omap m, const void* key, omap_iter_state* iter)
+{
+    iter_start(m, find_predecessors(m, key, true, NULL)->next[0], NULL, iter);
+}
+
+void omap_iter_range(const omap m, const void* from, const void* to, omap_iter_state* iter)
+{
+    iter_start(m, find_predecessors(m, from, false, NULL)->next[0], to, iter);
+}
+
+util_err_t omap_iter_next(omap_iter_state* iter, void** key, void** value)
+{
+    omap_node* node = iter->node;
+
+    if(node == NULL || (iter->end_key != NULL && compare_node(iter->m, node, iter->end_key) >= 0))
+    {
+        iter->node = NULL;
+        *key = NULL;
+        *value = NULL;
+        return UTIL_ITER_END;
+    }
+
+    *key = (void*)node_key(iter->m, node);
+    *value = (void*)node->value;
+    iter->node = node->next[0];
+
+    return UTIL_OK;
+}
\ No newline at end of file
@@ -0,0 +1,225 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "include/pool.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_ALIGN sizeof(void*)
+#define POOL_ALIGN_UP(x) (((x) + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1))
+
+typedef struct pool_slab_s
+{
+    struct pool_slab_s* next;
+    size_t              count;
+} pool_slab;
+
+typedef struct pool_block_s
+{
+    struct pool_block_s* next;
+} pool_block;
+
+struct pool_s
+{
+    pool_slab*  slabs;
+    pool_block* free;
+    size_t      free_count;
+    pool_conf   conf;
+    pool_stats  stats;
+};
+
+/*
+ * Private Methods
+ */
+static util_err_t add_slab(pool p, size_t count)
+{
+    if(count == 0)
+    {
+        count = 1;
+    }
+
+    if(p->conf.max_slabs != 0 && p->stats.slabs >= p->conf.max_slabs)
+    {
+        return UTIL_ERR_ALLOC;
+    }
+
+    size_t headerSize = POOL_ALIGN_UP(sizeof(pool_slab));
+    pool_slab* slab = (pool_slab*)p->conf.mem_alloc(headerSize + count * p->conf.block_size);
+
+    if(slab == NULL)
+    {
+        return UTIL_ERR_ALLOC;
+    }
+
+    slab->count = count;
+    slab->next = p->slabs;
+    p->slabs = slab;
+
+    // Thread all blocks of the slab onto the free-list, keeping them in address order
+    uint8_t* blocks = (uint8_t*)slab + headerSize;
+    for(size_t i = count; i > 0; i--)
+    {
+        pool_block* block = (pool_block*)(blocks + (i - 1) * p->conf.block_size);
+        block->next = p->free;
+        p->free = block;
+    }
+
+    p->free_count += count;
+    p->stats.slabs++;
+    p->stats.capacity += count;
+
+    return UTIL_OK;
+}
+
+/*
+ * Public Methods
+ */
+void pool_conf_init(pool_conf* conf, size_t block_size, size_t blocks_per_slab)
+{
+    conf->mem_alloc = malloc;
+    conf->mem_free = free;
+    conf->block_size = block_size;
+    conf->blocks_per_slab = blocks_per_slab;
+    conf->initial_blocks = 0;
+    conf->max_slabs = 0;
+}
+
+util_err_t pool_new(size_t block_size, size_t blocks_per_slab, pool* p)
+{
+    pool_conf conf;
+    pool_conf_init(&conf, block_size, blocks_per_slab);
+    return pool_new_conf(&conf, p);
+}
+
+util_err_t pool_new_conf(const pool_conf* const conf, pool* p)
+{
+    pool newPool = (pool)conf->mem_alloc(sizeof(*newPool));
+
+    if(newPool == NULL)
+    {
+        *p = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    memset(newPool, 0, sizeof(*newPool));
+    newPool->conf = *conf;
+
+    // Every block must be able to hold the free-list link
+    newPool->conf.block_size = POOL_ALIGN_UP(conf->block_size < sizeof(pool_block) ? sizeof(pool_block) : conf->block_size);
+    newPool->stats.block_size = newPool->conf.block_size;
+
+    util_err_t err = add_slab(newPool, conf->initial_blocks != 0 ? conf->initial_blocks : conf->blocks_per_slab);
+
+    if(err != UTIL_OK)
+    {
+        conf->mem_free(newPool);
+        *p = NULL;
+        return err;
+    }
+
+    *p = newPool;
+    return UTIL_OK;
+}
+
+void pool_delete(pool p)
+{
+    pool_slab* slab = p->slabs;
+    pool_slab* next;
+    while(slab != NULL)
+    {
+        next = slab->next;
+        p->conf.mem_free(slab);
+        slab = next;
+    }
+
+    p->conf.mem_free(p);
+}
+
+util_err_t pool_reserve(pool p, size_t count)
+{
+    if(p->free_count >= count)
+    {
+        return UTIL_OK;
+    }
+
+    return add_slab(p, count - p->free_count);
+}
+
+void* pool_alloc(pool p)
+{
+    if(p->free == NULL && add_slab(p, p->conf.blocks_per_slab) != UTIL_OK)
+    {
+        p->stats.failed_count++;
+        return NULL;
+    }
+
+    pool_block* block = p->free;
+    p->free = block->next;
+    p->free_count--;
+
+    p->stats.alloc_count++;
+    p->stats.in_use++;
+    if(p->stats.in_use > p->stats.peak_in_use)
+    {
+        p->stats.peak_in_use = p->stats.in_use;
+    }
+
+    return block;
+}
+
+void* pool_calloc(pool p)
+{
+    void* block = pool_alloc(p);
+
+    if(block != NULL)
+    {
+        memset(block, 0, p->conf.block_size);
+    }
+
+    return block;
+}
+
+void pool_free(pool p, void* block)
+{
+    if(block == NULL)
+    {
+        return;
+    }
+
+    pool_block* freed = (pool_block*)block;
+    freed->next = p->free;
+    p->free = freed;
+    p->free_count++;
+
+    p->stats.free_count++;
+    p->stats.in_use--;
+}
+
+size_t pool_block_size(const pool p)
+{
+    return p->conf.block_size;
+}
+
+void pool_get_stats(const pool p, pool_stats* stats)
+{
+    *stats = p->stats;
+}
\ No newline at end of file
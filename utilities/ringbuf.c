@@ -0,0 +1,252 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "include/ringbuf.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Records start with a header holding their length, the top bit marks padding
+// that fills the end of the buffer when a record does not fit before the wrap
+#define RINGBUF_HEADER_SIZE sizeof(uint32_t)
+#define RINGBUF_PADDING     0x80000000u
+#define RINGBUF_ALIGN_UP(x) (((x) + RINGBUF_HEADER_SIZE - 1) & ~(RINGBUF_HEADER_SIZE - 1))
+
+// Keeps the producer and consumer indices on separate cache lines
+#define RINGBUF_CACHE_LINE 64
+
+struct ringbuf_s
+{
+    // Producer side
+    atomic_size_t head;
+    size_t        reserved_pad;
+    uint8_t       producer_pad_[RINGBUF_CACHE_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+
+    // Consumer side
+    atomic_size_t tail;
+    size_t        peeked_size;
+    uint8_t       consumer_pad_[RINGBUF_CACHE_LINE - sizeof(atomic_size_t) - sizeof(size_t)];
+
+    uint8_t*     buffer;
+    size_t       size;
+    ringbuf_conf conf;
+};
+
+/*
+ * Private Methods
+ */
+static inline size_t record_size(size_t len)
+{
+    return RINGBUF_ALIGN_UP(RINGBUF_HEADER_SIZE + len);
+}
+
+static inline uint32_t* header_at(const ringbuf rb, size_t index)
+{
+    return (uint32_t*)(rb->buffer + (index & (rb->size - 1)));
+}
+
+/*
+ * Public Methods
+ */
+void ringbuf_conf_init(ringbuf_conf* conf)
+{
+    conf->mem_alloc = malloc;
+    conf->mem_free = free;
+}
+
+util_err_t ringbuf_new(size_t size, ringbuf* rb)
+{
+    ringbuf_conf conf;
+    ringbuf_conf_init(&conf);
+    return ringbuf_new_conf(&conf, size, rb);
+}
+
+util_err_t ringbuf_new_conf(const ringbuf_conf* const conf, size_t size, ringbuf* rb)
+{
+    // Room for at least two minimal records
+    size_t actualSize = 4 * RINGBUF_HEADER_SIZE;
+    while(actualSize < size)
+    {
+        actualSize *= 2;
+    }
+
+    ringbuf newRb = (ringbuf)conf->mem_alloc(sizeof(*newRb));
+
+    if(newRb == NULL)
+    {
+        *rb = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    newRb->buffer = (uint8_t*)conf->mem_alloc(actualSize);
+
+    if(newRb->buffer == NULL)
+    {
+        conf->mem_free(newRb);
+        *rb = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    atomic_init(&newRb->head, 0);
+    atomic_init(&newRb->tail, 0);
+    newRb->reserved_pad = 0;
+    newRb->peeked_size = 0;
+    newRb->size = actualSize;
+    newRb->conf = *conf;
+
+    *rb = newRb;
+    return UTIL_OK;
+}
+
+void ringbuf_delete(ringbuf rb)
+{
+    rb->conf.mem_free(rb->buffer);
+    rb->conf.mem_free(rb);
+}
+
+size_t ringbuf_max_record_size(const ringbuf rb)
+{
+    // A record of half the buffer always fits, even if it has to wrap
+    return rb->size / 2 - RINGBUF_HEADER_SIZE;
+}
+
+util_err_t ringbuf_reserve(ringbuf rb, size_t len, void** data)
+{
+    if(len > ringbuf_max_record_size(rb))
+    {
+        *data = NULL;
+        return UTIL_ERR_INVALID_ARG;
+    }
+
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+
+    size_t available = rb->size - (head - tail);
+    size_t offset = head & (rb->size - 1);
+    size_t untilEnd = rb->size - offset;
+    size_t needed = record_size(len);
+
+    // Records never wrap, skip the end of the buffer if the record does not fit there
+    size_t pad = needed > untilEnd ? untilEnd : 0;
+
+    if(available < pad + needed)
+    {
+        *data = NULL;
+        return UTIL_ERR_FULL;
+    }
+
+    rb->reserved_pad = pad;
+
+    *data = (uint8_t*)header_at(rb, head + pad) + RINGBUF_HEADER_SIZE;
+    return UTIL_OK;
+}
+
+void ringbuf_commit(ringbuf rb, size_t len)
+{
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+
+    if(rb->reserved_pad > 0)
+    {
+        *header_at(rb, head) = RINGBUF_PADDING;
+    }
+
+    *header_at(rb, head + rb->reserved_pad) = (uint32_t)len;
+
+    // Publish the record, the release makes its contents visible before the new head
+    atomic_store_explicit(&rb->head, head + rb->reserved_pad + record_size(len), memory_order_release);
+    rb->reserved_pad = 0;
+}
+
+util_err_t ringbuf_write(ringbuf rb, const void* data, size_t len)
+{
+    void* record;
+    util_err_t err = ringbuf_reserve(rb, len, &record);
+
+    if(err != UTIL_OK)
+    {
+        return err;
+    }
+
+    memcpy(record, data, len);
+    ringbuf_commit(rb, len);
+
+    return UTIL_OK;
+}
+
+util_err_t ringbuf_peek(ringbuf rb, const void** data, size_t* len)
+{
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+
+    if(tail == head)
+    {
+        *data = NULL;
+        *len = 0;
+        return UTIL_ERR_EMPTY;
+    }
+
+    size_t pad = 0;
+    uint32_t header = *header_at(rb, tail);
+
+    if(header & RINGBUF_PADDING)
+    {
+        // Padding is always committed together with the record that follows it
+        pad = rb->size - (tail & (rb->size - 1));
+        header = *header_at(rb, tail + pad);
+    }
+
+    rb->peeked_size = pad + record_size(header);
+
+    *data = (const uint8_t*)header_at(rb, tail + pad) + RINGBUF_HEADER_SIZE;
+    *len = header;
+    return UTIL_OK;
+}
+
+void ringbuf_release(ringbuf rb)
+{
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+
+    // The release makes sure the record has been read before the producer can reuse its space
+    atomic_store_explicit(&rb->tail, tail + rb->peeked_size, memory_order_release);
+    rb->peeked_size = 0;
+}
+
+util_err_t ringbuf_read(ringbuf rb, void* data, size_t capacity, size_t* len)
+{
+    const void* record;
+    util_err_t err = ringbuf_peek(rb, &record, len);
+
+    if(err != UTIL_OK)
+    {
+        return err;
+    }
+
+    memcpy(data, record, *len < capacity ? *len : capacity);
+    ringbuf_release(rb);
+
+    return UTIL_OK;
+}
+
+bool ringbuf_is_empty(const ringbuf rb)
+{
+    return atomic_load_explicit(&rb->tail, memory_order_relaxed) == atomic_load_explicit(&rb->head, memory_order_acquire);
+}
\ No newline at end of file
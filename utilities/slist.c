@@ -22,6 +22,8 @@
 
 #include <assert.h>
 
+#define SLIST_COPY_NODES_PER_SLAB 16
+
 typedef struct slist_node_s
 {
     struct slist_node_s* next;
@@ -34,22 +36,170 @@ struct slist_s
     slist_node last;
     size_t     count;
     slist_conf conf;
-};
-
-struct slist_iter_s
-{
-    slist      list;
-    slist_node current;
-    slist_node next;
-    size_t     index;
+    pool       owned_pool; // Node pool created by a copy, deleted with the list
 };
 
 /*
  * Private Methods
  */
+static slist_node alloc_node(slist list)
+{
+    if(list->conf.node_pool != NULL)
+    {
+        return (slist_node)pool_calloc(list->conf.node_pool);
+    }
+
+    return (slist_node)list->conf.mem_calloc(1, sizeof(struct slist_node_s));
+}
+
+static void free_node(slist list, slist_node node)
+{
+    if(list->conf.node_pool != NULL)
+    {
+        pool_free(list->conf.node_pool, node);
+    }
+    else
+    {
+        list->conf.mem_free(node);
+    }
+}
+
+// Allocates count linked nodes at once, so a failure leaves the list untouched
+static util_err_t alloc_chain(slist list, size_t count, slist_node* first, slist_node* last)
+{
+    if(list->conf.node_pool != NULL)
+    {
+        util_err_t err = pool_reserve(list->conf.node_pool, count);
+
+        if(err != UTIL_OK)
+        {
+            return err;
+        }
+    }
+
+    slist_node head = NULL;
+    slist_node tail = NULL;
+    for(size_t i = 0; i < count; i++)
+    {
+        slist_node node = alloc_node(list);
+
+        if(node == NULL)
+        {
+            while(head != NULL)
+            {
+                slist_node next = head->next;
+                free_node(list, head);
+                head = next;
+            }
+
+            return UTIL_ERR_ALLOC;
+        }
+
+        if(head == NULL)
+        {
+            head = node;
+        }
+        else
+        {
+            tail->next = node;
+        }
+        tail = node;
+    }
+
+    *first = head;
+    *last = tail;
+
+    return UTIL_OK;
+}
+
+static void append_chain(slist list, slist_node first, slist_node last, size_t count)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    if(list->first == NULL)
+    {
+        list->first = first;
+    }
+    else
+    {
+        list->last->next = first;
+    }
+
+    list->last = last;
+    list->count += count;
+}
+
+static bool same_node_allocator(const slist list, const slist other)
+{
+    if(list->conf.node_pool != NULL || other->conf.node_pool != NULL)
+    {
+        return list->conf.node_pool == other->conf.node_pool;
+    }
+
+    return list->conf.mem_free == other->conf.mem_free;
+}
+
+// Creates an empty list with the configuration of list that can hold count nodes
+static util_err_t new_copy(const slist list, size_t count, slist* copy)
+{
+    slist_conf conf = list->conf;
+
+    // A copy does not share the node pool the source list owns
+    if(conf.node_pool == list->owned_pool)
+    {
+        conf.node_pool = NULL;
+    }
+
+    slist newList;
+    util_err_t err = slist_new_conf(&conf, &newList);
+
+    if(err != UTIL_OK)
+    {
+        *copy = NULL;
+        return err;
+    }
+
+    if(count > 0)
+    {
+        if(newList->conf.node_pool != NULL)
+        {
+            err = pool_reserve(newList->conf.node_pool, count);
+        }
+        else
+        {
+            // Allocate all nodes of the copy in the first slab of a pool owned by the copy, which grows by
+            // small slabs once the copy gets longer than the source
+            pool_conf poolConf;
+            pool_conf_init(&poolConf, sizeof(struct slist_node_s), SLIST_COPY_NODES_PER_SLAB);
+            poolConf.initial_blocks = count;
+            poolConf.mem_alloc = conf.mem_alloc;
+            poolConf.mem_free = conf.mem_free;
+
+            err = pool_new_conf(&poolConf, &newList->owned_pool);
+            if(err == UTIL_OK)
+            {
+                newList->conf.node_pool = newList->owned_pool;
+            }
+        }
+
+        if(err != UTIL_OK)
+        {
+            slist_delete(newList);
+            *copy = NULL;
+            return err;
+        }
+    }
+
+    *copy = newList;
+    return UTIL_OK;
+}
+
 static void remove_node(slist list, slist_node node, slist_node prev)
 {
-    assert(prev->next == node);
+    assert(prev == NULL ? list->first == node : prev->next == node);
 
     if(prev == NULL)
     {
@@ -65,7 +215,7 @@ static void remove_node(slist list, slist_node node, slist_node prev)
         list->last = prev;
     }
     
-    list->conf.mem_free(node);
+    free_node(list, node);
     list->count--;
 }
 
@@ -77,6 +227,14 @@ void slist_conf_init(slist_conf* conf)
     conf->mem_alloc = malloc;
     conf->mem_calloc = calloc;
     conf->mem_free = free;
+    conf->item_copy = NULL;
+    conf->item_delete = NULL;
+    conf->node_pool = NULL;
+}
+
+size_t slist_node_size(void)
+{
+    return sizeof(struct slist_node_s);
 }
 
 util_err_t slist_new(slist* list)
@@ -88,6 +246,12 @@ util_err_t slist_new(slist* list)
 
 util_err_t slist_new_conf(const slist_conf* const conf, slist* list)
 {
+    if(conf->node_pool != NULL && pool_block_size(conf->node_pool) < sizeof(struct slist_node_s))
+    {
+        *list = NULL;
+        return UTIL_ERR_INVALID_ARG;
+    }
+
     slist newList = (slist)conf->mem_calloc(1, sizeof(*newList));
 
     if(newList == NULL)
@@ -96,9 +260,7 @@ util_err_t slist_new_conf(const slist_conf* const conf, slist* list)
         return UTIL_ERR_ALLOC;
     }
 
-    newList->conf.mem_alloc = conf->mem_alloc;
-    newList->conf.mem_calloc = conf->mem_calloc;
-    newList->conf.mem_free = conf->mem_free;
+    newList->conf = *conf;
 
     *list = newList;
     return UTIL_OK;
@@ -106,8 +268,16 @@ util_err_t slist_new_conf(const slist_conf* const conf, slist* list)
 
 void slist_delete(slist list)
 {
-    // Delete all nodes
-    slist_clear(list);
+    if(list->owned_pool != NULL)
+    {
+        // Deleting the pool frees all nodes at once
+        pool_delete(list->owned_pool);
+    }
+    else
+    {
+        // Delete all nodes
+        slist_clear(list);
+    }
 
     // Delete the list itself
     list->conf.mem_free(list);
@@ -115,26 +285,20 @@ void slist_delete(slist list)
 
 util_err_t slist_copy_shallow(const slist list, slist* copy)
 {
-    slist newList = (slist)list->conf.mem_calloc(1, sizeof(*newList));
+    slist newList;
+    util_err_t err = new_copy(list, list->count, &newList);
 
-    if(newList == NULL)
+    if(err != UTIL_OK)
     {
         *copy = NULL;
-        return UTIL_ERR_ALLOC;
+        return err;
     }
 
-    util_err_t err;
     slist_node node = list->first;
     while (node != NULL)
     {
-        err = slist_add(newList, node->item);
-
-        if(err != UTIL_OK)
-        {
-            slist_delete(newList);
-            *copy = NULL;
-            return err;
-        }
+        // Cannot fail, all nodes have been reserved
+        slist_add(newList, node->item);
 
         node = node->next;
     }
@@ -145,15 +309,26 @@ util_err_t slist_copy_shallow(const slist list, slist* copy)
 
 util_err_t slist_copy_deep(const slist list, void (copyFn)(const void* item, void** copy), slist* copy)
 {
-    slist newList = (slist)list->conf.mem_calloc(1, sizeof(*newList));
+    if(copyFn == NULL)
+    {
+        copyFn = list->conf.item_copy;
+    }
 
-    if(newList == NULL)
+    if(copyFn == NULL)
     {
         *copy = NULL;
-        return UTIL_ERR_ALLOC;
+        return UTIL_ERR_INVALID_ARG;
+    }
+
+    slist newList;
+    util_err_t err = new_copy(list, list->count, &newList);
+
+    if(err != UTIL_OK)
+    {
+        *copy = NULL;
+        return err;
     }
 
-    util_err_t err;
     slist_node node = list->first;
     while (node != NULL)
     {
@@ -164,7 +339,18 @@ util_err_t slist_copy_deep(const slist list, void (copyFn)(const void* item, voi
 
         if(err != UTIL_OK)
         {
-            // TODO: Call delete variant that also frees resources from items
+            // Free the items copied so far, including the one that could not be added
+            if(list->conf.item_delete != NULL)
+            {
+                list->conf.item_delete(newItem);
+
+                void* copiedItem;
+                SLIST_FOREACH(copiedItem, newList)
+                {
+                    list->conf.item_delete(copiedItem);
+                }
+            }
+
             slist_delete(newList);
             *copy = NULL;
             return err;
@@ -179,7 +365,7 @@ util_err_t slist_copy_deep(const slist list, void (copyFn)(const void* item, voi
 
 util_err_t slist_add(slist list, void* item)
 {
-    slist_node newNode = (slist_node)list->conf.mem_calloc(1, sizeof(*newNode));
+    slist_node newNode = alloc_node(list);
 
     if(newNode == NULL)
     {
@@ -207,6 +393,70 @@ util_err_t slist_add(slist list, void* item)
     return UTIL_OK;
 }
 
+util_err_t slist_add_range(slist list, void* const* items, size_t count)
+{
+    slist_node first;
+    slist_node last;
+    util_err_t err = alloc_chain(list, count, &first, &last);
+
+    if(err != UTIL_OK)
+    {
+        return err;
+    }
+
+    slist_node node = first;
+    for(size_t i = 0; i < count; i++)
+    {
+        node->item = items[i];
+        node = node->next;
+    }
+
+    append_chain(list, first, last, count);
+
+    return UTIL_OK;
+}
+
+util_err_t slist_splice(slist list, slist other)
+{
+    if(list == other)
+    {
+        return UTIL_ERR_INVALID_ARG;
+    }
+
+    if(same_node_allocator(list, other))
+    {
+        // The nodes can be freed by either list, so just relink them
+        append_chain(list, other->first, other->last, other->count);
+
+        other->first = NULL;
+        other->last = NULL;
+        other->count = 0;
+    }
+    else
+    {
+        slist_node first;
+        slist_node last;
+        util_err_t err = alloc_chain(list, other->count, &first, &last);
+
+        if(err != UTIL_OK)
+        {
+            return err;
+        }
+
+        slist_node node = first;
+        for(slist_node src = other->first; src != NULL; src = src->next)
+        {
+            node->item = src->item;
+            node = node->next;
+        }
+
+        append_chain(list, first, last, other->count);
+        slist_clear(other);
+    }
+
+    return UTIL_OK;
+}
+
 util_err_t slist_remove(slist list, void* item)
 {
     slist_node prev = NULL;
@@ -253,6 +503,52 @@ util_err_t slist_remove_at(slist list, size_t index)
     return UTIL_OK;
 }
 
+size_t slist_remove_if(slist list, bool (predicate)(void* item, void* context), void* context)
+{
+    size_t removed = 0;
+    slist_node prev = NULL;
+    slist_node node = list->first;
+
+    while (node != NULL)
+    {
+        slist_node next = node->next;
+
+        if(predicate(node->item, context))
+        {
+            remove_node(list, node, prev);
+            removed++;
+        }
+        else
+        {
+            prev = node;
+        }
+
+        node = next;
+    }
+
+    return removed;
+}
+
+util_err_t slist_get_at(const slist list, size_t index, void** item)
+{
+    slist_node node = list->first;
+
+    // Find the node at the specified index
+    for(size_t i = 0; node != NULL && i < index; i++)
+    {
+        node = node->next;
+    }
+
+    if(node == NULL)
+    {
+        *item = NULL;
+        return UTIL_ERR_OUT_OF_RANGE;
+    }
+
+    *item = node->item;
+    return UTIL_OK;
+}
+
 void slist_clear(slist list)
 {
     slist_node node = list->first;
@@ -260,9 +556,13 @@ void slist_clear(slist list)
     while (node != NULL)
     {
         next = node->next;
-        list->conf.mem_free(node);
+        free_node(list, node);
         node = next;
     }
+
+    list->first = NULL;
+    list->last = NULL;
+    list->count = 0;
 }
 
 size_t slist_count(const slist list)
@@ -280,16 +580,28 @@ util_err_t slist_iter_new(const slist list, slist_iter* iter)
         return UTIL_ERR_ALLOC;
     }
 
-    newIter->list = list;
-    newIter->current = NULL;
-    newIter->next = list->first;
-    newIter->index = 0;
+    slist_iter_init(list, newIter);
 
     *iter = newIter;
 
     return UTIL_OK;
 }
 
+void slist_iter_init(const slist list, slist_iter_state* iter)
+{
+    iter->list = list;
+    iter->current = NULL;
+    iter->next = list->first;
+    iter->index = 0;
+}
+
+slist_iter_state slist_iter_begin(const slist list)
+{
+    slist_iter_state iter;
+    slist_iter_init(list, &iter);
+    return iter;
+}
+
 util_err_t slist_iter_delete(slist_iter iter)
 {
     iter->list->conf.mem_free(iter);
@@ -0,0 +1,308 @@
+/**
+ * Copyright (c) 2021 Maarten Thomassen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "include/vec.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest number of items that is allocated once the first item is added
+#define VEC_MIN_CAPACITY 4
+
+struct vec_s
+{
+    uint8_t* items;
+    size_t   item_size;
+    size_t   count;
+    size_t   capacity;
+    vec_conf conf;
+};
+
+/*
+ * Private Methods
+ */
+static inline uint8_t* item_at(const vec v, size_t index)
+{
+    return v->items + index * v->item_size;
+}
+
+static util_err_t grow(vec v)
+{
+    if(v->count < v->capacity)
+    {
+        return UTIL_OK;
+    }
+
+    return vec_reserve(v, v->capacity == 0 ? VEC_MIN_CAPACITY : v->capacity * 2);
+}
+
+/*
+ * Public Methods
+ */
+void vec_conf_init(vec_conf* conf)
+{
+    conf->mem_alloc = malloc;
+    conf->mem_realloc = realloc;
+    conf->mem_free = free;
+}
+
+util_err_t vec_new(size_t item_size, vec* v)
+{
+    vec_conf conf;
+    vec_conf_init(&conf);
+    return vec_new_conf(&conf, item_size, v);
+}
+
+util_err_t vec_new_conf(const vec_conf* const conf, size_t item_size, vec* v)
+{
+    if(item_size == 0)
+    {
+        *v = NULL;
+        return UTIL_ERR_INVALID_ARG;
+    }
+
+    vec newVec = (vec)conf->mem_alloc(sizeof(*newVec));
+
+    if(newVec == NULL)
+    {
+        *v = NULL;
+        return UTIL_ERR_ALLOC;
+    }
+
+    newVec->items = NULL;
+    newVec->item_size = item_size;
+    newVec->count = 0;
+    newVec->capacity = 0;
+    newVec->conf = *conf;
+
+    *v = newVec;
+    return UTIL_OK;
+}
+
+void vec_delete(vec v)
+{
+    if(v->items != NULL)
+    {
+        v->conf.mem_free(v->items);
+    }
+
+    v->conf.mem_free(v);
+}
+
+util_err_t vec_copy(const vec v, vec* copy)
+{
+    vec newVec;
+    util_err_t err = vec_new_conf(&v->conf, v->item_size, &newVec);
+
+    if(err != UTIL_OK)
+    {
+        *copy = NULL;
+        return err;
+    }
+
+    if(v->count > 0)
+    {
+        err = vec_reserve(newVec, v->count);
+
+        if(err != UTIL_OK)
+        {
+            vec_delete(newVec);
+            *copy = NULL;
+            return err;
+        }
+
+        memcpy(newVec->items, v->items, v->count * v->item_size);
+        newVec->count = v->count;
+    }
+
+    *copy = newVec;
+    return UTIL_OK;
+}
+
+util_err_t vec_reserve(vec v, size_t capacity)
+{
+    if(capacity <= v->capacity)
+    {
+        return UTIL_OK;
+    }
+
+    if(capacity > SIZE_MAX / v->item_size)
+    {
+        return UTIL_ERR_ALLOC;
+    }
+
+    uint8_t* items = (uint8_t*)v->conf.mem_realloc(v->items, capacity * v->item_size);
+
+    if(items == NULL)
+    {
+        return UTIL_ERR_ALLOC;
+    }
+
+    v->items = items;
+    v->capacity = capacity;
+
+    return UTIL_OK;
+}
+
+util_err_t vec_push(vec v, const void* item)
+{
+    util_err_t err = grow(v);
+
+    if(err != UTIL_OK)
+    {
+        return err;
+    }
+
+    memcpy(item_at(v, v->count), item, v->item_size);
+    v->count++;
+
+    return UTIL_OK;
+}
+
+util_err_t vec_pop(vec v, void* item)
+{
+    if(v->count == 0)
+    {
+        return UTIL_ERR_OUT_OF_RANGE;
+    }
+
+    v->count--;
+
+    if(item != NULL)
+    {
+        memcpy(item, item_at(v, v->count), v->item_size);
+    }
+
+    return UTIL_OK;
+}
+
+util_err_t vec_insert(vec v, size_t index, const void* item)
+{
+    if(index > v->count)
+    {
+        return UTIL_ERR_OUT_OF_RANGE;
+    }
+
+    util_err_t err = grow(v);
+
+    if(err != UTIL_OK)
+    {
+        return err;
+    }
+
+    // Move the following items up to make room
+    memmove(item_at(v, index + 1), item_at(v, index), (v->count - index) * v->item_size);
+    memcpy(item_at(v, index), item, v->item_size);
+    v->count++;
+
+    return UTIL_OK;
+}
+
+util_err_t vec_remove_at(vec v, size_t index)
+{
+    if(index >= v->count)
+    {
+        return UTIL_ERR_OUT_OF_RANGE;
+    }
+
+    // Move the following items down to close the gap
+    memmove(item_at(v, index), item_at(v, index + 1), (v->count - index - 1) * v->item_size);
+    v->count--;
+
+    return UTIL_OK;
+}
+
+util_err_t vec_swap_remove(vec v, size_t index)
+{
+    if(index >= v->count)
+    {
+        return UTIL_ERR_OUT_OF_RANGE;
+    }
+
+    v->count--;
+
+    // Move the last item into the gap
+    if(index != v->count)
+    {
+        memcpy(item_at(v, index), item_at(v, v->count), v->item_size);
+    }
+
+    return UTIL_OK;
+}
+
+void vec_clear(vec v)
+{
+    v->count = 0;
+}
+
+void* vec_at(const vec v, size_t index)
+{
+    if(index >= v->count)
+    {
+        return NULL;
+    }
+
+    return item_at(v, index);
+}
+
+void* vec_data(const vec v)
+{
+    return v->items;
+}
+
+size_t vec_count(const vec v)
+{
+    return v->count;
+}
+
+size_t vec_capacity(const vec v)
+{
+    return v->capacity;
+}
+
+util_err_t vec_bsearch(const vec v, const void* key, int (*compare)(const void* key, const void* item), size_t* index)
+{
+    // Find the first item that does not order before the key
+    size_t low = 0;
+    size_t high = v->count;
+    while(low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if(compare(key, item_at(v, mid)) > 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    *index = low;
+
+    if(low < v->count && compare(key, item_at(v, low)) == 0)
+    {
+        return UTIL_OK;
+    }
+
+    return UTIL_ERR_NOT_FOUND;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef MONGOOSE7_LIVE_LOG_H
+#define MONGOOSE7_LIVE_LOG_H
+
+#include <mongoose.h>
+
+#include <stdbool.h>
+
+// Streams the log to websocket clients connected to WEBSERVER_LIVE_LOG_URI. A client can send
+// a level ("E", "W", "I", "D" or "V") to change which messages it receives.
+//
+// The messages are kept per client by a logger sink and sent by the webserver thread when it
+// polls the connections, so logging tasks never write to sockets. Either set the event handler
+// with mongoose7_webserver_thread_set_event_handler, or call it first from your own handler.
+// Start and stop the live log while the webserver thread is not running.
+
+bool mongoose7_live_log_start(void);
+void mongoose7_live_log_stop(void);
+
+bool mongoose7_live_log_event_handler(struct mg_connection* c, int ev, void *evData, void *fnData);
+
+#endif // MONGOOSE7_LIVE_LOG_H
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef MONGOOSE7_LOG_METRICS_H
+#define MONGOOSE7_LOG_METRICS_H
+
+#include <mongoose.h>
+
+#include <stdbool.h>
+
+// Serves the metrics of the logger service as JSON at WEBSERVER_LOG_METRICS_URI, see
+// logger_service_metrics_json. Requires CONFIG_LOGGER_SERVICE_METRICS for anything but zeros.
+//
+// Either set the event handler with mongoose7_webserver_thread_set_event_handler, or call it first
+// from your own handler.
+
+bool mongoose7_log_metrics_event_handler(struct mg_connection* c, int ev, void *evData, void *fnData);
+
+#endif // MONGOOSE7_LOG_METRICS_H
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef MONGOOSE7_LOG_RING_H
+#define MONGOOSE7_LOG_RING_H
+
+#include <mongoose.h>
+
+#include <stdbool.h>
+
+struct logger_ring_s;
+
+// Serves the persistent log ring, see logger_ring.h, at WEBSERVER_LOG_RING_URI. The log is sent
+// from the oldest to the newest message as a chunked response, a few records each time the
+// webserver thread polls the connection, so downloading a large ring does not need much memory.
+// Records that are overwritten during the download are reported in the response.
+//
+// Either set the event handler with mongoose7_webserver_thread_set_event_handler, or call it first
+// from your own handler. Set the ring while the webserver thread is not running.
+
+void mongoose7_log_ring_set(struct logger_ring_s* ring);
+
+bool mongoose7_log_ring_event_handler(struct mg_connection* c, int ev, void *evData, void *fnData);
+
+#endif // MONGOOSE7_LOG_RING_H
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include <mongoose7_live_log.h>
+
+#include <stddef.h>
+
+#include <logger_service.h>
+#include <logger_live_sink.h>
+
+#ifndef WEBSERVER_LIVE_LOG_URI
+#define WEBSERVER_LIVE_LOG_URI "/log"
+#endif
+
+#ifndef WEBSERVER_LIVE_LOG_CLIENTS
+#define WEBSERVER_LIVE_LOG_CLIENTS 2
+#endif
+
+#ifndef WEBSERVER_LIVE_LOG_BACKLOG_SIZE
+#define WEBSERVER_LIVE_LOG_BACKLOG_SIZE 4096
+#endif
+
+// Messages are only taken from the backlog while Mongoose has less than this queued for the client
+#define SEND_QUEUE_LIMIT 2048
+
+// Largest message sent, longer messages are truncated
+#define MESSAGE_SIZE 512
+
+static logger_live_sink_t gLiveSink = NULL;
+static sink_handle_t gSinkHandle = NULL;
+
+static bool parse_level(const char* text, size_t len, logger_service_loglevel_t* level)
+{
+    static const char letters[] = "NEWIDV";
+
+    if(len == 0)
+    {
+        return false;
+    }
+
+    // A letter or the number of the level
+    for(size_t i = 0; i < sizeof(letters) - 1; i++)
+    {
+        if(text[0] == letters[i] || text[0] == letters[i] + ('a' - 'A') || text[0] == (char)('0' + i))
+        {
+            *level = (logger_service_loglevel_t)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void send_backlog(struct mg_connection* c, logger_live_client_t client)
+{
+    char message[MESSAGE_SIZE];
+    size_t len;
+
+    while(c->send.len < SEND_QUEUE_LIMIT && logger_live_sink_read(gLiveSink, client, message, sizeof(message), &len))
+    {
+        mg_ws_send(c, message, len, WEBSOCKET_OP_TEXT);
+    }
+}
+
+bool mongoose7_live_log_start(void)
+{
+    if(gLiveSink != NULL)
+    {
+        return true;
+    }
+
+    logger_live_sink_conf_t conf;
+    logger_live_sink_conf_init(&conf);
+    conf.max_clients = WEBSERVER_LIVE_LOG_CLIENTS;
+    conf.backlog_size = WEBSERVER_LIVE_LOG_BACKLOG_SIZE;
+
+    gLiveSink = logger_live_sink_new(&conf);
+
+    if(gLiveSink == NULL)
+    {
+        return false;
+    }
+
+    gSinkHandle = logger_service_register_sink(logger_live_sink_write, gLiveSink);
+
+    if(gSinkHandle == NULL)
+    {
+        logger_live_sink_delete(gLiveSink);
+        gLiveSink = NULL;
+        return false;
+    }
+
+    logger_service_set_sink_name(gSinkHandle, "live log");
+
+    return true;
+}
+
+void mongoose7_live_log_stop(void)
+{
+    if(gLiveSink == NULL)
+    {
+        return;
+    }
+
+    logger_service_unregister_sink(gSinkHandle);
+    logger_live_sink_delete(gLiveSink);
+
+    gSinkHandle = NULL;
+    gLiveSink = NULL;
+}
+
+bool mongoose7_live_log_event_handler(struct mg_connection* c, int ev, void *evData, void *fnData)
+{
+    if(gLiveSink == NULL)
+    {
+        return false;
+    }
+
+    switch(ev)
+    {
+        case MG_EV_HTTP_MSG:
+        {
+            struct mg_http_message* hm = (struct mg_http_message *) evData;
+
+            if(!mg_http_match_uri(hm, WEBSERVER_LIVE_LOG_URI))
+            {
+                return false;
+            }
+
+            if(logger_live_sink_add_client(gLiveSink, c) == NULL)
+            {
+                mg_http_reply(c, 503, "", "Too many log clients\n");
+                return true;
+            }
+
+            mg_ws_upgrade(c, hm, NULL);
+            return true;
+        }
+
+        case MG_EV_WS_MSG:
+        {
+            struct mg_ws_message* wm = (struct mg_ws_message *) evData;
+            logger_live_client_t client = logger_live_sink_find_client(gLiveSink, c);
+            logger_service_loglevel_t level;
+
+            if(client == NULL)
+            {
+                return false;
+            }
+
+            if(parse_level(wm->data.ptr, wm->data.len, &level))
+            {
+                logger_live_sink_set_client_level(gLiveSink, client, level);
+            }
+
+            mg_iobuf_delete(&c->recv, c->recv.len);
+            return true;
+        }
+
+        case MG_EV_POLL:
+        {
+            logger_live_client_t client = logger_live_sink_find_client(gLiveSink, c);
+
+            if(client != NULL && c->is_websocket)
+            {
+                send_backlog(c, client);
+            }
+
+            // Other handlers may want to poll the connection too
+            return false;
+        }
+
+        case MG_EV_CLOSE:
+        {
+            logger_live_client_t client = logger_live_sink_find_client(gLiveSink, c);
+
+            if(client != NULL)
+            {
+                logger_live_sink_remove_client(gLiveSink, client);
+            }
+
+            return false;
+        }
+
+        default:
+            return false;
+    }
+}
\ No newline at end of file
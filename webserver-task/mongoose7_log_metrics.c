@@ -0,0 +1,49 @@
+#include <mongoose7_log_metrics.h>
+
+#include <stdlib.h>
+
+#include <logger_service.h>
+
+#ifndef WEBSERVER_LOG_METRICS_URI
+#define WEBSERVER_LOG_METRICS_URI "/log/metrics"
+#endif
+
+bool mongoose7_log_metrics_event_handler(struct mg_connection* c, int ev, void *evData, void *fnData)
+{
+    if(ev != MG_EV_HTTP_MSG)
+    {
+        return false;
+    }
+
+    struct mg_http_message* hm = (struct mg_http_message *) evData;
+
+    if(!mg_http_match_uri(hm, WEBSERVER_LOG_METRICS_URI))
+    {
+        return false;
+    }
+
+    // Measure first, with some room for sinks and tags that are added before the metrics are written
+    size_t size = (size_t)logger_service_metrics_json(NULL, 0) + 256;
+    char* json = (char*)malloc(size);
+
+    if(json == NULL)
+    {
+        mg_http_reply(c, 503, "", "Out of memory\n");
+        return true;
+    }
+
+    int len = logger_service_metrics_json(json, size);
+
+    if((size_t)len >= size)
+    {
+        free(json);
+        mg_http_reply(c, 503, "", "Metrics changed, try again\n");
+        return true;
+    }
+
+    mg_printf(c, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\nContent-Length: %d\r\n\r\n", len);
+    mg_send(c, json, (size_t)len);
+    free(json);
+
+    return true;
+}
\ No newline at end of file
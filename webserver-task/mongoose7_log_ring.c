@@ -0,0 +1,149 @@
+#include <mongoose7_log_ring.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <logger_ring.h>
+
+#ifndef WEBSERVER_LOG_RING_URI
+#define WEBSERVER_LOG_RING_URI "/log/saved"
+#endif
+
+#ifndef WEBSERVER_LOG_RING_DOWNLOADS
+#define WEBSERVER_LOG_RING_DOWNLOADS 1
+#endif
+
+// Records are only read while Mongoose has less than this queued for the connection
+#define SEND_QUEUE_LIMIT 4096
+
+// Largest record sent, longer records are truncated
+#define RECORD_SIZE 1024
+
+typedef struct download_s
+{
+    struct mg_connection* connection;   // NULL when the download is free
+    logger_ring_cursor_t cursor;
+    uint32_t end_seq;                   // Records appended after the request are not sent
+} download_t;
+
+static logger_ring_t gRing = NULL;
+static download_t gDownloads[WEBSERVER_LOG_RING_DOWNLOADS];
+
+static download_t* find_download(struct mg_connection* c)
+{
+    for(size_t i = 0; i < WEBSERVER_LOG_RING_DOWNLOADS; i++)
+    {
+        if(gDownloads[i].connection == c)
+        {
+            return &gDownloads[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void send_records(struct mg_connection* c, download_t* download)
+{
+    char record[RECORD_SIZE];
+    size_t len;
+
+    while(c->send.len < SEND_QUEUE_LIMIT)
+    {
+        uint32_t seq = download->cursor.seq;
+
+        if((int32_t)(seq - download->end_seq) >= 0 || !logger_ring_read(gRing, &download->cursor, record, sizeof(record), &len))
+        {
+            // Done, an empty chunk ends the response
+            mg_http_write_chunk(c, "", 0);
+            download->connection = NULL;
+            return;
+        }
+
+        // The cursor skips records that were overwritten before they were sent
+        uint32_t lost = download->cursor.seq - 1 - seq;
+        if(lost > 0)
+        {
+            char note[48];
+            int noteLen = snprintf(note, sizeof(note), "... %u records lost\n", (unsigned int)lost);
+            mg_http_write_chunk(c, note, (size_t)noteLen);
+        }
+
+        mg_http_write_chunk(c, record, len);
+    }
+}
+
+void mongoose7_log_ring_set(struct logger_ring_s* ring)
+{
+    gRing = ring;
+
+    for(size_t i = 0; i < WEBSERVER_LOG_RING_DOWNLOADS; i++)
+    {
+        gDownloads[i].connection = NULL;
+    }
+}
+
+bool mongoose7_log_ring_event_handler(struct mg_connection* c, int ev, void *evData, void *fnData)
+{
+    if(gRing == NULL)
+    {
+        return false;
+    }
+
+    switch(ev)
+    {
+        case MG_EV_HTTP_MSG:
+        {
+            struct mg_http_message* hm = (struct mg_http_message *) evData;
+
+            if(!mg_http_match_uri(hm, WEBSERVER_LOG_RING_URI))
+            {
+                return false;
+            }
+
+            download_t* download = find_download(NULL);
+
+            if(download == NULL)
+            {
+                mg_http_reply(c, 503, "", "Too many log downloads\n");
+                return true;
+            }
+
+            download->connection = c;
+            download->end_seq = logger_ring_next_seq(gRing);
+            logger_ring_cursor_init(gRing, &download->cursor);
+
+            mg_printf(c, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nTransfer-Encoding: chunked\r\n\r\n");
+            send_records(c, download);
+            return true;
+        }
+
+        case MG_EV_POLL:
+        {
+            download_t* download = find_download(c);
+
+            if(download != NULL)
+            {
+                send_records(c, download);
+            }
+
+            // Other handlers may want to poll the connection too
+            return false;
+        }
+
+        case MG_EV_CLOSE:
+        {
+            download_t* download = find_download(c);
+
+            if(download != NULL)
+            {
+                download->connection = NULL;
+            }
+
+            return false;
+        }
+
+        default:
+            return false;
+    }
+}
\ No newline at end of file